@@ -8,9 +8,14 @@
 #include <cstring>
 #include "audio_core/audio_types.h"
 #include "audio_core/codec.h"
+#include "audio_core/simd.h"
 #include "common/assert.h"
 #include "common/common_types.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace AudioCore::Codec {
 
 StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
@@ -86,13 +91,40 @@ StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
         [](u8 sample) { return static_cast<s16>(static_cast<u16>(sample) << 8); }};
 
     StereoBuffer16 ret{sample_count};
+    size_t i{};
+
+#ifdef ARCHITECTURE_x86_64
+    // Interleaving zero bytes below the samples widens them to the upper byte of 16 bit lanes
+    const __m128i zero{_mm_setzero_si128()};
+    __m128i* const output{reinterpret_cast<__m128i*>(ret.data())};
+    if (IsSimdEnabled()) {
+        if (num_channels == 1) {
+            for (; i + 16 <= sample_count; i += 16) {
+                const __m128i input{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))};
+                const __m128i low{_mm_unpacklo_epi8(zero, input)};
+                const __m128i high{_mm_unpackhi_epi8(zero, input)};
+                _mm_storeu_si128(output + i / 4 + 0, _mm_unpacklo_epi16(low, low));
+                _mm_storeu_si128(output + i / 4 + 1, _mm_unpackhi_epi16(low, low));
+                _mm_storeu_si128(output + i / 4 + 2, _mm_unpacklo_epi16(high, high));
+                _mm_storeu_si128(output + i / 4 + 3, _mm_unpackhi_epi16(high, high));
+            }
+        } else {
+            for (; i + 8 <= sample_count; i += 8) {
+                const __m128i input{
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2))};
+                _mm_storeu_si128(output + i / 4 + 0, _mm_unpacklo_epi8(zero, input));
+                _mm_storeu_si128(output + i / 4 + 1, _mm_unpackhi_epi8(zero, input));
+            }
+        }
+    }
+#endif
 
     if (num_channels == 1) {
-        for (size_t i = 0; i < sample_count; i++) {
+        for (; i < sample_count; i++) {
             ret[i].fill(decode_sample(data[i]));
         }
     } else {
-        for (size_t i = 0; i < sample_count; i++) {
+        for (; i < sample_count; i++) {
             ret[i][0] = decode_sample(data[i * 2 + 0]);
             ret[i][1] = decode_sample(data[i * 2 + 1]);
         }
@@ -107,17 +139,31 @@ StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
 
     StereoBuffer16 ret{sample_count};
 
-    if (num_channels == 1) {
-        for (size_t i = 0; i < sample_count; i++) {
-            s16 sample{};
-            std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
-            ret[i].fill(sample);
-        }
-    } else {
-        for (size_t i = 0; i < sample_count; ++i) {
-            std::memcpy(&ret[i], data + i * sizeof(s16) * 2, 2 * sizeof(s16));
+    if (num_channels == 2) {
+        // Already in the output layout
+        std::memcpy(ret.data(), data, sample_count * 2 * sizeof(s16));
+        return ret;
+    }
+
+    size_t i{};
+
+#ifdef ARCHITECTURE_x86_64
+    __m128i* const output{reinterpret_cast<__m128i*>(ret.data())};
+    if (IsSimdEnabled()) {
+        for (; i + 8 <= sample_count; i += 8) {
+            const __m128i input{
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * sizeof(s16)))};
+            _mm_storeu_si128(output + i / 4 + 0, _mm_unpacklo_epi16(input, input));
+            _mm_storeu_si128(output + i / 4 + 1, _mm_unpackhi_epi16(input, input));
         }
     }
+#endif
+
+    for (; i < sample_count; i++) {
+        s16 sample{};
+        std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
+        ret[i].fill(sample);
+    }
 
     return ret;
 }
@@ -2,11 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <atomic>
 #include <vector>
 #include <cubeb/cubeb.h>
 #include "audio_core/audio_types.h"
 #include "audio_core/cubeb_sink.h"
 #include "common/logging/log.h"
+#include "common/ring_buffer.h"
 
 namespace AudioCore {
 
@@ -17,7 +19,11 @@ struct CubebSink::Impl {
     cubeb* ctx = nullptr;
     cubeb_stream* stream = nullptr;
 
-    std::vector<s16> queue;
+    /// Stereo frames written by the emulation thread and read by the data callback
+    Common::RingBuffer<s16, SINK_QUEUE_CAPACITY, 2> queue;
+
+    std::atomic<u64> underruns{0};
+    std::atomic<u64> overrun_samples{0};
 
     static long DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
                              void* output_buffer, long num_frames);
@@ -97,34 +103,41 @@ void CubebSink::EnqueueSamples(const s16* samples, size_t sample_count) {
     if (!impl->ctx)
         return;
 
-    impl->queue.reserve(impl->queue.size() + sample_count * 2);
-    std::copy(samples, samples + sample_count * 2, std::back_inserter(impl->queue));
+    const size_t pushed = impl->queue.Push(samples, sample_count);
+    if (pushed < sample_count) {
+        impl->overrun_samples.fetch_add(sample_count - pushed, std::memory_order_relaxed);
+    }
 }
 
 size_t CubebSink::SamplesInQueue() const {
     if (!impl->ctx)
         return 0;
 
-    return impl->queue.size() / 2;
+    return impl->queue.Size();
+}
+
+SinkStatistics CubebSink::GetStatistics() const {
+    SinkStatistics statistics;
+    statistics.underruns = impl->underruns.load(std::memory_order_relaxed);
+    statistics.overrun_samples = impl->overrun_samples.load(std::memory_order_relaxed);
+    return statistics;
 }
 
 long CubebSink::Impl::DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
                                    void* output_buffer, long num_frames) {
     Impl* impl = static_cast<Impl*>(user_data);
-    u8* buffer = reinterpret_cast<u8*>(output_buffer);
+    s16* buffer = reinterpret_cast<s16*>(output_buffer);
 
     if (!impl)
         return 0;
 
-    size_t frames_to_write = std::min(impl->queue.size() / 2, static_cast<size_t>(num_frames));
-
-    memcpy(buffer, impl->queue.data(), frames_to_write * sizeof(s16) * 2);
-    impl->queue.erase(impl->queue.begin(), impl->queue.begin() + frames_to_write * 2);
+    const size_t frames_written = impl->queue.Pop(buffer, static_cast<size_t>(num_frames));
 
-    if (frames_to_write < num_frames) {
+    if (frames_written < static_cast<size_t>(num_frames)) {
         // Fill the rest of the frames with silence
-        memset(buffer + frames_to_write * sizeof(s16) * 2, 0,
-               (num_frames - frames_to_write) * sizeof(s16) * 2);
+        impl->underruns.fetch_add(1, std::memory_order_relaxed);
+        std::memset(buffer + frames_written * 2, 0,
+                    (num_frames - frames_written) * sizeof(s16) * 2);
     }
 
     return num_frames;
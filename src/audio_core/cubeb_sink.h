@@ -21,6 +21,8 @@ public:
 
     size_t SamplesInQueue() const override;
 
+    SinkStatistics GetStatistics() const override;
+
 private:
     struct Impl;
     std::unique_ptr<Impl> impl;
@@ -53,7 +53,7 @@ void DspInterface::OutputFrame(StereoFrame16& frame) {
 
     if (perform_time_stretching) {
         time_stretcher.AddSamples(&frame[0][0], frame.size());
-        std::vector<s16> stretched_samples{time_stretcher.Process(sink->SamplesInQueue())};
+        const std::vector<s16>& stretched_samples{time_stretcher.Process(sink->SamplesInQueue())};
         sink->EnqueueSamples(stretched_samples.data(), stretched_samples.size() / 2);
     } else {
         constexpr size_t maximum_sample_latency{2048}; // about 64 miliseconds
@@ -73,7 +73,7 @@ void DspInterface::FlushResidualStretcherAudio() {
 
     time_stretcher.Flush();
     while (true) {
-        std::vector<s16> residual_audio = time_stretcher.Process(sink->SamplesInQueue());
+        const std::vector<s16>& residual_audio = time_stretcher.Process(sink->SamplesInQueue());
         if (residual_audio.empty())
             break;
         sink->EnqueueSamples(residual_audio.data(), residual_audio.size() / 2);
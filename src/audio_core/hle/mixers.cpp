@@ -5,9 +5,14 @@
 #include <algorithm>
 #include <cstddef>
 #include "audio_core/hle/mixers.h"
+#include "audio_core/simd.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace AudioCore::HLE {
 
 void Mixers::Reset() {
@@ -94,9 +99,66 @@ static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
             ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
 }
 
+#ifdef ARCHITECTURE_x86_64
+/**
+ * SSE2 version of the downmix below, processing four samples at a time. The float sums are
+ * evaluated in the same order and converted the same way as in the scalar code, so the output is
+ * identical.
+ */
+template <bool mono>
+static void DownmixAndMixSSE2(float gain, const QuadFrame32& samples, StereoFrame16& frame) {
+    static_assert(samples_per_frame % 4 == 0);
+
+    const __m128 gain_vector{_mm_set1_ps(gain)};
+    for (size_t i = 0; i < samples_per_frame; i += 4) {
+        const auto load_sample = [&](size_t sample) {
+            const __m128i value{
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples[i + sample].data()))};
+            return _mm_mul_ps(_mm_cvtepi32_ps(value), gain_vector);
+        };
+        __m128 channel0{load_sample(0)};
+        __m128 channel1{load_sample(1)};
+        __m128 channel2{load_sample(2)};
+        __m128 channel3{load_sample(3)};
+        _MM_TRANSPOSE4_PS(channel0, channel1, channel2, channel3);
+
+        __m128i downmixed;
+        if constexpr (mono) {
+            const __m128 sum{
+                _mm_add_ps(_mm_add_ps(_mm_add_ps(channel0, channel1), channel2), channel3)};
+            const __m128i mono_samples{_mm_cvttps_epi32(_mm_div_ps(sum, _mm_set1_ps(2.0f)))};
+            const __m128i clamped{_mm_packs_epi32(mono_samples, mono_samples)};
+            downmixed = _mm_unpacklo_epi16(clamped, clamped);
+        } else {
+            const __m128i left{_mm_cvttps_epi32(_mm_add_ps(channel0, channel2))};
+            const __m128i right{_mm_cvttps_epi32(_mm_add_ps(channel1, channel3))};
+            downmixed = _mm_unpacklo_epi16(_mm_packs_epi32(left, left),
+                                           _mm_packs_epi32(right, right));
+        }
+
+        __m128i* const accumulator{reinterpret_cast<__m128i*>(frame[i].data())};
+        _mm_storeu_si128(accumulator, _mm_adds_epi16(_mm_loadu_si128(accumulator), downmixed));
+    }
+}
+#endif
+
 void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& samples) {
     // TODO(merry): Limiter. (Currently we're performing final mixing assuming a disabled limiter.)
 
+#ifdef ARCHITECTURE_x86_64
+    if (IsSimdEnabled()) {
+        switch (state.output_format) {
+        case OutputFormat::Mono:
+            DownmixAndMixSSE2<true>(gain, samples, current_frame);
+            return;
+        case OutputFormat::Surround:
+        case OutputFormat::Stereo:
+            DownmixAndMixSSE2<false>(gain, samples, current_frame);
+            return;
+        }
+    }
+#endif
+
     switch (state.output_format) {
     case OutputFormat::Mono:
         std::transform(
@@ -8,10 +8,16 @@
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
+#include "audio_core/simd.h"
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace AudioCore::HLE {
 
 SourceStatus::Status Source::Tick(SourceConfiguration::Configuration& config,
@@ -30,7 +36,29 @@ void Source::MixInto(QuadFrame32& dest, size_t intermediate_mix_id) const {
         return;
 
     const std::array<float, 4>& gains{state.gain.at(intermediate_mix_id)};
-    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+    size_t samplei{};
+
+#ifdef ARCHITECTURE_x86_64
+    if (IsSimdEnabled()) {
+        // Two stereo samples at a time, with each one spread to the four channels of dest
+        const __m128 gain_vector{_mm_loadu_ps(gains.data())};
+        for (; samplei + 2 <= samples_per_frame; samplei += 2) {
+            const __m128i stereo{
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(current_frame[samplei].data()))};
+            const __m128i widened{_mm_srai_epi32(_mm_unpacklo_epi16(stereo, stereo), 16)};
+            for (size_t i = 0; i < 2; i++) {
+                const __m128i quad{i == 0 ? _mm_shuffle_epi32(widened, _MM_SHUFFLE(1, 0, 1, 0))
+                                          : _mm_shuffle_epi32(widened, _MM_SHUFFLE(3, 2, 3, 2))};
+                const __m128i scaled{
+                    _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(quad), gain_vector))};
+                __m128i* const output{reinterpret_cast<__m128i*>(dest[samplei + i].data())};
+                _mm_storeu_si128(output, _mm_add_epi32(_mm_loadu_si128(output), scaled));
+            }
+        }
+    }
+#endif
+
+    for (; samplei < samples_per_frame; samplei++) {
         // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
         dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
         dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
@@ -228,7 +256,7 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
 void Source::GenerateFrame() {
     current_frame.fill({});
 
-    if (state.current_buffer.empty() && !DequeueBuffer()) {
+    if (IsCurrentBufferConsumed() && !DequeueBuffer()) {
         state.enabled = false;
         state.buffer_update = true;
         state.current_buffer_id = 0;
@@ -239,24 +267,29 @@ void Source::GenerateFrame() {
 
     state.current_sample_number = state.next_sample_number;
     while (frame_position < current_frame.size()) {
-        if (state.current_buffer.empty() && !DequeueBuffer()) {
-            break;
+        if (IsCurrentBufferConsumed()) {
+            if (!DequeueBuffer()) {
+                break;
+            }
+            // The buffer may have been empty or at an invalid address
+            continue;
         }
 
+        const AudioInterp::StereoBuffer16& input{*state.current_buffer};
+        size_t& inputi{state.current_buffer_position};
+
         switch (state.interpolation_mode) {
         case InterpolationMode::None:
-            AudioInterp::None(state.interp_state, state.current_buffer, state.rate_multiplier,
+            AudioInterp::None(state.interp_state, input, inputi, state.rate_multiplier,
                               current_frame, frame_position);
             break;
         case InterpolationMode::Linear:
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
+            AudioInterp::Linear(state.interp_state, input, inputi, state.rate_multiplier,
                                 current_frame, frame_position);
             break;
         case InterpolationMode::Polyphase:
-            // TODO(merry): Implement polyphase interpolation
-            LOG_DEBUG(Audio_DSP, "Polyphase interpolation unimplemented; falling back to linear");
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
-                                current_frame, frame_position);
+            AudioInterp::Polyphase(state.interp_state, input, inputi, state.rate_multiplier,
+                                   current_frame, frame_position);
             break;
         default:
             UNIMPLEMENTED();
@@ -269,7 +302,7 @@ void Source::GenerateFrame() {
 }
 
 bool Source::DequeueBuffer() {
-    ASSERT_MSG(state.current_buffer.empty(),
+    ASSERT_MSG(IsCurrentBufferConsumed(),
                "Shouldn't dequeue; we still have data in current_buffer");
 
     if (state.input_queue.empty())
@@ -283,31 +316,16 @@ bool Source::DequeueBuffer() {
         state.adpcm_state.yn2 = buf.adpcm_yn[1];
     }
 
+    state.current_buffer_position = 0;
+
     const u8* const memory{Memory::GetPhysicalPointer(buf.physical_address)};
     if (memory) {
-        const unsigned num_channels{
-            static_cast<unsigned>(buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1)};
-        switch (buf.format) {
-        case Format::PCM8:
-            state.current_buffer = Codec::DecodePCM8(num_channels, memory, buf.length);
-            break;
-        case Format::PCM16:
-            state.current_buffer = Codec::DecodePCM16(num_channels, memory, buf.length);
-            break;
-        case Format::ADPCM:
-            DEBUG_ASSERT(num_channels == 1);
-            state.current_buffer =
-                Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state);
-            break;
-        default:
-            UNIMPLEMENTED();
-            break;
-        }
+        state.current_buffer = DecodeBuffer(buf, memory);
     } else {
         LOG_WARNING(Audio_DSP,
                     "source_id={} buffer_id={} length={}: Invalid physical address {:#010x}",
                     source_id, buf.buffer_id, buf.length, buf.physical_address);
-        state.current_buffer.clear();
+        state.current_buffer.reset();
         return true;
     }
 
@@ -323,10 +341,93 @@ bool Source::DequeueBuffer() {
     }
 
     LOG_TRACE(Audio_DSP, "source_id={} buffer_id={} from_queue={} current_buffer.size()={}",
-              source_id, buf.buffer_id, buf.from_queue, state.current_buffer.size());
+              source_id, buf.buffer_id, buf.from_queue, state.current_buffer->size());
     return true;
 }
 
+std::shared_ptr<const AudioInterp::StereoBuffer16> Source::DecodeBuffer(const Buffer& buf,
+                                                                        const u8* memory) {
+    const unsigned num_channels{
+        static_cast<unsigned>(buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1)};
+
+    size_t data_size{};
+    switch (buf.format) {
+    case Format::PCM8:
+        data_size = buf.length * num_channels;
+        break;
+    case Format::PCM16:
+        data_size = buf.length * num_channels * sizeof(s16);
+        break;
+    case Format::ADPCM:
+        // Frames of 14 samples are encoded in 8 bytes each
+        data_size = (buf.length + 13) / 14 * 8;
+        break;
+    default:
+        UNIMPLEMENTED();
+        return std::make_shared<const AudioInterp::StereoBuffer16>();
+    }
+
+    const u64 data_hash{Common::ComputeHash64(memory, data_size)};
+    const auto is_same_adpcm_state = [](const Codec::ADPCMState& a, const Codec::ADPCMState& b) {
+        return a.yn1 == b.yn1 && a.yn2 == b.yn2;
+    };
+
+    const auto cached = std::find_if(
+        decoded_buffer_cache.begin(), decoded_buffer_cache.end(), [&](const DecodedBuffer& entry) {
+            return entry.samples && entry.physical_address == buf.physical_address &&
+                   entry.length == buf.length && entry.format == buf.format &&
+                   entry.mono_or_stereo == buf.mono_or_stereo && entry.data_hash == data_hash &&
+                   (buf.format != Format::ADPCM ||
+                    (entry.adpcm_coeffs == state.adpcm_coeffs &&
+                     is_same_adpcm_state(entry.adpcm_state_before, state.adpcm_state)));
+        });
+    if (cached != decoded_buffer_cache.end()) {
+        std::rotate(decoded_buffer_cache.begin(), cached, cached + 1);
+        if (buf.format == Format::ADPCM) {
+            state.adpcm_state = decoded_buffer_cache.front().adpcm_state_after;
+        }
+        return decoded_buffer_cache.front().samples;
+    }
+
+    DecodedBuffer decoded{};
+    decoded.physical_address = buf.physical_address;
+    decoded.length = buf.length;
+    decoded.format = buf.format;
+    decoded.mono_or_stereo = buf.mono_or_stereo;
+    decoded.data_hash = data_hash;
+    decoded.adpcm_coeffs = state.adpcm_coeffs;
+    decoded.adpcm_state_before = state.adpcm_state;
+    switch (buf.format) {
+    case Format::PCM8:
+        decoded.samples = std::make_shared<const AudioInterp::StereoBuffer16>(
+            Codec::DecodePCM8(num_channels, memory, buf.length));
+        break;
+    case Format::PCM16:
+        decoded.samples = std::make_shared<const AudioInterp::StereoBuffer16>(
+            Codec::DecodePCM16(num_channels, memory, buf.length));
+        break;
+    case Format::ADPCM:
+        DEBUG_ASSERT(num_channels == 1);
+        decoded.samples = std::make_shared<const AudioInterp::StereoBuffer16>(
+            Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state));
+        break;
+    default:
+        UNREACHABLE();
+    }
+    decoded.adpcm_state_after = state.adpcm_state;
+
+    // Evict the least recently used entry
+    std::rotate(decoded_buffer_cache.begin(), decoded_buffer_cache.end() - 1,
+                decoded_buffer_cache.end());
+    decoded_buffer_cache.front() = std::move(decoded);
+    return decoded_buffer_cache.front().samples;
+}
+
+bool Source::IsCurrentBufferConsumed() const {
+    return !state.current_buffer ||
+           state.current_buffer_position >= state.current_buffer->size();
+}
+
 SourceStatus::Status Source::GetCurrentStatus() {
     SourceStatus::Status ret{};
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <vector>
 #include <queue>
 #include "audio_core/audio_types.h"
@@ -108,7 +109,8 @@ private:
 
         u32 current_sample_number = 0;
         u32 next_sample_number = 0;
-        AudioInterp::StereoBuffer16 current_buffer;
+        std::shared_ptr<const AudioInterp::StereoBuffer16> current_buffer;
+        size_t current_buffer_position = 0; ///< Index of the next sample to interpolate
 
         // buffer_id state
 
@@ -132,6 +134,24 @@ private:
 
     } state;
 
+    /// A buffer as decoded by DequeueBuffer, along with everything its decoding depended on
+    struct DecodedBuffer {
+        PAddr physical_address;
+        u32 length;
+        Format format;
+        MonoOrStereo mono_or_stereo;
+        u64 data_hash; ///< Hash of the encoded data in guest memory
+        std::array<s16, 16> adpcm_coeffs;
+        Codec::ADPCMState adpcm_state_before;
+        Codec::ADPCMState adpcm_state_after;
+        std::shared_ptr<const AudioInterp::StereoBuffer16> samples;
+    };
+
+    /// Recently decoded buffers, most recently used first. Looping and re-queued buffers are
+    /// decoded only once as long as their data in guest memory doesn't change. This is kept out
+    /// of `state` so that it survives resets.
+    std::array<DecodedBuffer, 4> decoded_buffer_cache{};
+
     // Internal functions
 
     /// INTERNAL: Update our internal state based on the current config.
@@ -141,6 +161,11 @@ private:
     /// INTERNAL: Dequeues a buffer and does preprocessing on it (decoding, resampling). Puts it
     /// into current_buffer.
     bool DequeueBuffer();
+    /// INTERNAL: Decodes a buffer from guest memory, reusing a previous decode of it if possible.
+    std::shared_ptr<const AudioInterp::StereoBuffer16> DecodeBuffer(const Buffer& buf,
+                                                                    const u8* memory);
+    /// INTERNAL: Returns true when all samples of current_buffer have been interpolated.
+    bool IsCurrentBufferConsumed() const;
     /// INTERNAL: Generates a SourceStatus::Status based on our internal state.
     SourceStatus::Status GetCurrentStatus();
 };
@@ -3,9 +3,14 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace AudioCore::AudioInterp {
 
 // Calculations are done in fixed point with 24 fractional bits.
@@ -14,53 +19,76 @@ constexpr u64 scale_factor{1 << 24};
 constexpr u64 scale_mask{scale_factor - 1};
 
 /// Here we step over the input in steps of rate, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
+/// Four adjacent samples are passed to fn each step, with the output lying between the second and
+/// the third one.
 template <typename Function>
-static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-                            size_t& outputi, Function fn) {
+static void StepOverSamples(State& state, const StereoBuffer16& input, size_t& inputi, float rate,
+                            StereoFrame16& output, size_t& outputi, Function fn) {
     ASSERT(rate > 0);
 
-    if (input.empty())
+    if (inputi >= input.size())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    // The input is read as if the three history samples were prepended to its unconsumed part,
+    // which saves having to modify the (possibly shared) input buffer.
+    const std::array<s16, 2>* const samples{input.data() + inputi};
+    const size_t num_samples{input.size() - inputi};
+    const auto sample_at = [&state, samples](size_t i) -> const std::array<s16, 2>& {
+        switch (i) {
+        case 0:
+            return state.xn3;
+        case 1:
+            return state.xn2;
+        case 2:
+            return state.xn1;
+        default:
+            return samples[i - 3];
+        }
+    };
 
     const u64 step_size{static_cast<u64>(rate * scale_factor)};
     u64 fposition{state.fposition};
-    size_t inputi{};
+    size_t position{};
 
     while (outputi < output.size()) {
-        inputi = static_cast<size_t>(fposition / scale_factor);
+        position = static_cast<size_t>(fposition / scale_factor);
 
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
+        if (position >= num_samples) {
+            position = num_samples;
             break;
         }
 
         u64 fraction{fposition & scale_mask};
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+        output[outputi++] = fn(fraction, sample_at(position), sample_at(position + 1),
+                               sample_at(position + 2), sample_at(position + 3));
 
         fposition += step_size;
     }
 
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
-    state.fposition = fposition - inputi * scale_factor;
+    const std::array<s16, 2> xn3{sample_at(position)};
+    const std::array<s16, 2> xn2{sample_at(position + 1)};
+    const std::array<s16, 2> xn1{sample_at(position + 2)};
+    state.xn3 = xn3;
+    state.xn2 = xn2;
+    state.xn1 = xn1;
+    state.fposition = fposition - position * scale_factor;
 
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+    inputi += position;
 }
 
-void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output, size_t& outputi) {
-    StepOverSamples(
-        state, input, rate, output, outputi,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+void None(State& state, const StereoBuffer16& input, size_t& inputi, float rate,
+          StereoFrame16& output, size_t& outputi) {
+    StepOverSamples(state, input, inputi, rate, output, outputi,
+                    [](u64 fraction, const auto& xm1, const auto& x0, const auto& x1,
+                       const auto& x2) { return x0; });
 }
 
-void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-            size_t& outputi) {
+void Linear(State& state, const StereoBuffer16& input, size_t& inputi, float rate,
+            StereoFrame16& output, size_t& outputi) {
     // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
-    StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
+    StepOverSamples(state, input, inputi, rate, output, outputi,
+                    [](u64 fraction, const auto& xm1, const auto& x0, const auto& x1,
+                       const auto& x2) {
                         // This is a saturated subtraction. (Verified by black-box fuzzing.)
                         s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
                         s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
@@ -72,4 +100,83 @@ void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& outp
                     });
 }
 
+// The polyphase filter bank. The top bits of the fractional position select one of the phases,
+// each of which holds the four tap weights for that position in fixed point.
+// The kernel used by the actual firmware is unknown, so this uses a Catmull-Rom spline. It passes
+// through the input samples and has unity gain at DC.
+constexpr size_t polyphase_phase_bits{7};
+constexpr size_t polyphase_num_phases{1 << polyphase_phase_bits};
+constexpr int polyphase_coeff_bits{14};
+constexpr s32 polyphase_rounding{1 << (polyphase_coeff_bits - 1)};
+
+/**
+ * Tap weights of each phase, in the order the SSE2 kernel consumes them: the weights for x[n-1]
+ * and x[n] twice, followed by the weights for x[n+1] and x[n+2] twice (once per channel).
+ */
+using PolyphasePhase = std::array<s16, 8>;
+
+static constexpr s16 RoundToCoeff(double value) {
+    const double scaled{value * (1 << polyphase_coeff_bits)};
+    return static_cast<s16>(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+alignas(16) static constexpr std::array<PolyphasePhase, polyphase_num_phases> polyphase_bank{[] {
+    std::array<PolyphasePhase, polyphase_num_phases> bank{};
+    for (size_t phase = 0; phase < polyphase_num_phases; phase++) {
+        const double t{static_cast<double>(phase) / polyphase_num_phases};
+        const double t2{t * t};
+        const double t3{t2 * t};
+        const s16 cm1{RoundToCoeff((-t3 + 2 * t2 - t) / 2)};
+        const s16 c1{RoundToCoeff((-3 * t3 + 4 * t2 + t) / 2)};
+        const s16 c2{RoundToCoeff((t3 - t2) / 2)};
+        // Derive the largest weight from the others so that each phase sums to exactly 1.0
+        const s16 c0{static_cast<s16>((1 << polyphase_coeff_bits) - cm1 - c1 - c2)};
+        bank[phase] = {cm1, c0, cm1, c0, c1, c2, c1, c2};
+    }
+    return bank;
+}()};
+
+void Polyphase(State& state, const StereoBuffer16& input, size_t& inputi, float rate,
+               StereoFrame16& output, size_t& outputi) {
+    StepOverSamples(
+        state, input, inputi, rate, output, outputi,
+        [](u64 fraction, const auto& xm1, const auto& x0, const auto& x1, const auto& x2) {
+            const PolyphasePhase& weights{
+                polyphase_bank[fraction >> (24 - polyphase_phase_bits)]};
+
+#ifdef ARCHITECTURE_x86_64
+            // Gather the taps as [L-1, L0, R-1, R0, L1, L2, R1, R2] so that a single multiply-add
+            // leaves the two partial sums for each channel in adjacent lanes.
+            const auto to_u32 = [](const std::array<s16, 2>& sample) {
+                u32 value;
+                std::memcpy(&value, sample.data(), sizeof(value));
+                return static_cast<int>(value);
+            };
+            const __m128i interleaved{
+                _mm_setr_epi32(to_u32(xm1), to_u32(x0), to_u32(x1), to_u32(x2))};
+            const __m128i low_taps{_mm_shufflelo_epi16(interleaved, _MM_SHUFFLE(3, 1, 2, 0))};
+            const __m128i taps{_mm_shufflehi_epi16(low_taps, _MM_SHUFFLE(3, 1, 2, 0))};
+            const __m128i products{_mm_madd_epi16(
+                taps, _mm_load_si128(reinterpret_cast<const __m128i*>(weights.data())))};
+            const __m128i sums{_mm_add_epi32(products, _mm_srli_si128(products, 8))};
+            const __m128i rounded{_mm_add_epi32(sums, _mm_set1_epi32(polyphase_rounding))};
+            const __m128i result{_mm_srai_epi32(rounded, polyphase_coeff_bits)};
+
+            std::array<s16, 2> out;
+            const int packed{_mm_cvtsi128_si32(_mm_packs_epi32(result, result))};
+            std::memcpy(out.data(), &packed, sizeof(out));
+            return out;
+#else
+            const auto filter = [&weights](s32 sm1, s32 s0, s32 s1, s32 s2) {
+                const s32 sum{sm1 * weights[0] + s0 * weights[1] + s1 * weights[4] +
+                              s2 * weights[5]};
+                return static_cast<s16>(
+                    std::clamp((sum + polyphase_rounding) >> polyphase_coeff_bits, -32768, 32767));
+            };
+            return std::array<s16, 2>{filter(xm1[0], x0[0], x1[0], x2[0]),
+                                      filter(xm1[1], x0[1], x1[1], x2[1])};
+#endif
+        });
+}
+
 } // namespace AudioCore::AudioInterp
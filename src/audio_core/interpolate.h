@@ -5,19 +5,20 @@
 #pragma once
 
 #include <array>
-#include <deque>
+#include <vector>
 #include "audio_core/audio_types.h"
 #include "common/common_types.h"
 
 namespace AudioCore::AudioInterp {
 
 /// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::deque<std::array<s16, 2>>;
+using StereoBuffer16 = std::vector<std::array<s16, 2>>;
 
 struct State {
-    /// Two historical samples.
+    /// Three historical samples. Only Polyphase looks at x[n-3].
     std::array<s16, 2> xn1 = {}; ///< x[n-1]
     std::array<s16, 2> xn2 = {}; ///< x[n-2]
+    std::array<s16, 2> xn3 = {}; ///< x[n-3]
     /// Current fractional position.
     u64 fposition = 0;
 };
@@ -26,23 +27,40 @@ struct State {
  * No interpolation. This is equivalent to a zero-order hold. There is a two-sample predelay.
  * @param state Interpolation state.
  * @param input Input buffer.
+ * @param inputi The index of input to start reading from. This is advanced past consumed samples.
  * @param rate Stretch factor. Must be a positive non-zero value.
  *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
  * @param output The resampled audio buffer.
  * @param outputi The index of output to start writing to.
  */
-void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output, size_t& outputi);
+void None(State& state, const StereoBuffer16& input, size_t& inputi, float rate,
+          StereoFrame16& output, size_t& outputi);
 
 /**
  * Linear interpolation. This is equivalent to a first-order hold. There is a two-sample predelay.
  * @param state Interpolation state.
  * @param input Input buffer.
+ * @param inputi The index of input to start reading from. This is advanced past consumed samples.
  * @param rate Stretch factor. Must be a positive non-zero value.
  *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
  * @param output The resampled audio buffer.
  * @param outputi The index of output to start writing to.
  */
-void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-            size_t& outputi);
+void Linear(State& state, const StereoBuffer16& input, size_t& inputi, float rate,
+            StereoFrame16& output, size_t& outputi);
+
+/**
+ * Polyphase interpolation with four taps per phase, using a Catmull-Rom cubic kernel. This has the
+ * same two-sample predelay as Linear, and additionally looks at the sample before x[n].
+ * @param state Interpolation state.
+ * @param input Input buffer.
+ * @param inputi The index of input to start reading from. This is advanced past consumed samples.
+ * @param rate Stretch factor. Must be a positive non-zero value.
+ *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
+ * @param output The resampled audio buffer.
+ * @param outputi The index of output to start writing to.
+ */
+void Polyphase(State& state, const StereoBuffer16& input, size_t& inputi, float rate,
+               StereoFrame16& output, size_t& outputi);
 
 } // namespace AudioCore::AudioInterp
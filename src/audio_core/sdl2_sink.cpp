@@ -2,13 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <list>
-#include <numeric>
+#include <atomic>
+#include <cstring>
 #include <SDL.h>
 #include "audio_core/audio_types.h"
 #include "audio_core/sdl2_sink.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/ring_buffer.h"
 
 namespace AudioCore {
 
@@ -17,7 +18,11 @@ struct SDL2Sink::Impl {
 
     SDL_AudioDeviceID audio_device_id = 0;
 
-    std::list<std::vector<s16>> queue;
+    /// Stereo frames written by the emulation thread and read by the audio callback
+    Common::RingBuffer<s16, SINK_QUEUE_CAPACITY, 2> queue;
+
+    std::atomic<u64> underruns{0};
+    std::atomic<u64> overrun_samples{0};
 
     static void Callback(void* impl_, u8* buffer, int buffer_size_in_bytes);
 };
@@ -78,52 +83,37 @@ void SDL2Sink::EnqueueSamples(const s16* samples, size_t sample_count) {
     if (impl->audio_device_id <= 0)
         return;
 
-    SDL_LockAudioDevice(impl->audio_device_id);
-    impl->queue.emplace_back(samples, samples + sample_count * 2);
-    SDL_UnlockAudioDevice(impl->audio_device_id);
+    const size_t pushed = impl->queue.Push(samples, sample_count);
+    if (pushed < sample_count) {
+        impl->overrun_samples.fetch_add(sample_count - pushed, std::memory_order_relaxed);
+    }
 }
 
 size_t SDL2Sink::SamplesInQueue() const {
     if (impl->audio_device_id <= 0)
         return 0;
 
-    SDL_LockAudioDevice(impl->audio_device_id);
-
-    size_t total_size = std::accumulate(impl->queue.begin(), impl->queue.end(),
-                                        static_cast<size_t>(0), [](size_t sum, const auto& buffer) {
-                                            // Division by two because each stereo sample is made of
-                                            // two s16.
-                                            return sum + buffer.size() / 2;
-                                        });
-
-    SDL_UnlockAudioDevice(impl->audio_device_id);
+    return impl->queue.Size();
+}
 
-    return total_size;
+SinkStatistics SDL2Sink::GetStatistics() const {
+    SinkStatistics statistics;
+    statistics.underruns = impl->underruns.load(std::memory_order_relaxed);
+    statistics.overrun_samples = impl->overrun_samples.load(std::memory_order_relaxed);
+    return statistics;
 }
 
 void SDL2Sink::Impl::Callback(void* impl_, u8* buffer, int buffer_size_in_bytes) {
     Impl* impl = reinterpret_cast<Impl*>(impl_);
 
-    size_t remaining_size = static_cast<size_t>(buffer_size_in_bytes) /
-                            sizeof(s16); // Keep track of size in 16-bit increments.
-
-    while (remaining_size > 0 && !impl->queue.empty()) {
-        if (impl->queue.front().size() <= remaining_size) {
-            memcpy(buffer, impl->queue.front().data(), impl->queue.front().size() * sizeof(s16));
-            buffer += impl->queue.front().size() * sizeof(s16);
-            remaining_size -= impl->queue.front().size();
-            impl->queue.pop_front();
-        } else {
-            memcpy(buffer, impl->queue.front().data(), remaining_size * sizeof(s16));
-            buffer += remaining_size * sizeof(s16);
-            impl->queue.front().erase(impl->queue.front().begin(),
-                                      impl->queue.front().begin() + remaining_size);
-            remaining_size = 0;
-        }
-    }
+    // Each stereo frame is made of two s16
+    const size_t frames_requested = static_cast<size_t>(buffer_size_in_bytes) / (sizeof(s16) * 2);
+    const size_t frames_written = impl->queue.Pop(reinterpret_cast<s16*>(buffer), frames_requested);
 
-    if (remaining_size > 0) {
-        memset(buffer, 0, remaining_size * sizeof(s16));
+    if (frames_written < frames_requested) {
+        impl->underruns.fetch_add(1, std::memory_order_relaxed);
+        std::memset(buffer + frames_written * sizeof(s16) * 2, 0,
+                    (frames_requested - frames_written) * sizeof(s16) * 2);
     }
 }
 
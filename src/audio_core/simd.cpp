@@ -0,0 +1,20 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include "audio_core/simd.h"
+
+namespace AudioCore {
+
+static std::atomic<bool> simd_enabled{true};
+
+bool IsSimdEnabled() {
+    return simd_enabled.load(std::memory_order_relaxed);
+}
+
+void SetSimdEnabled(bool enabled) {
+    simd_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+} // namespace AudioCore
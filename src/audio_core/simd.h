@@ -0,0 +1,18 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+namespace AudioCore {
+
+/**
+ * Returns whether the DSP HLE uses its SSE2 code paths on x86_64. They produce exactly the same
+ * output as the scalar code, so they are only turned off to compare the two.
+ */
+bool IsSimdEnabled();
+
+/// Selects between the SSE2 and the scalar code paths of the DSP HLE. Enabled by default.
+void SetSimdEnabled(bool enabled);
+
+} // namespace AudioCore
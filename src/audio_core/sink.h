@@ -11,6 +11,17 @@ namespace AudioCore {
 
 constexpr char auto_device_name[] = "auto";
 
+/// Number of stereo frames the queue of a sink can hold (about one second)
+constexpr std::size_t SINK_QUEUE_CAPACITY = 0x8000;
+
+/// Counters about the sample queue of a sink, for monitoring
+struct SinkStatistics {
+    /// Number of times the output device asked for more samples than were queued
+    u64 underruns = 0;
+    /// Number of samples dropped because the queue was full
+    u64 overrun_samples = 0;
+};
+
 /**
  * This class is an interface for an audio sink. An audio sink accepts samples in stereo signed
  * PCM16 format to be output. Sinks *do not* handle resampling and expect the correct sample rate.
@@ -33,6 +44,11 @@ public:
 
     /// Samples enqueued that have not been played yet.
     virtual std::size_t SamplesInQueue() const = 0;
+
+    /// Returns the underrun and overrun counters of the sink.
+    virtual SinkStatistics GetStatistics() const {
+        return {};
+    }
 };
 
 } // namespace AudioCore
@@ -38,9 +38,12 @@ struct TimeStretcher::Impl {
     double smoothed_ratio{1.0};
 
     double sample_rate{static_cast<double>(native_sample_rate)};
+
+    /// Output of the last Process call, kept to reuse its allocation
+    std::vector<s16> output;
 };
 
-std::vector<s16> TimeStretcher::Process(size_t samples_in_queue) {
+const std::vector<s16>& TimeStretcher::Process(size_t samples_in_queue) {
     // This is a very simple algorithm without any fancy control theory. It works and is stable.
 
     double ratio{CalculateCurrentRatio()};
@@ -52,12 +55,12 @@ std::vector<s16> TimeStretcher::Process(size_t samples_in_queue) {
     // SoundTouch's tempo definition the inverse of our ratio definition.
     impl->soundtouch.setTempo(1.0 / impl->smoothed_ratio);
 
-    std::vector<s16> samples{GetSamples()};
+    GetSamples();
     if (samples_in_queue >= DROP_FRAMES_SAMPLE_DELAY) {
-        samples.clear();
+        impl->output.clear();
         LOG_DEBUG(Audio, "Dropping frames!");
     }
-    return samples;
+    return impl->output;
 }
 
 TimeStretcher::TimeStretcher() : impl(std::make_unique<Impl>()) {
@@ -130,14 +133,13 @@ double TimeStretcher::CorrectForUnderAndOverflow(double ratio, size_t sample_del
     return ClampRatio(ratio);
 }
 
-std::vector<s16> TimeStretcher::GetSamples() {
+void TimeStretcher::GetSamples() {
     uint available{impl->soundtouch.numSamples()};
 
-    std::vector<s16> output(static_cast<size_t>(available) * 2);
-
-    impl->soundtouch.receiveSamples(output.data(), available);
+    // Resizing keeps the capacity, so this only allocates while the output is still growing
+    impl->output.resize(static_cast<size_t>(available) * 2);
 
-    return output;
+    impl->soundtouch.receiveSamples(impl->output.data(), available);
 }
 
 } // namespace AudioCore
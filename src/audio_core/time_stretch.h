@@ -40,9 +40,10 @@ public:
      * Timer calculations use sample_delay to determine how much of a margin we have.
      * @param sample_delay How many samples are buffered downstream of this module and haven't been
      * played yet.
-     * @return Samples to play in interleaved stereo PCM16 format.
+     * @return Samples to play in interleaved stereo PCM16 format. The buffer is reused by the next
+     * call, which avoids allocating one every frame.
      */
-    std::vector<s16> Process(size_t sample_delay);
+    const std::vector<s16>& Process(size_t sample_delay);
 
 private:
     struct Impl;
@@ -53,8 +54,8 @@ private:
     /// INTERNAL: If we have too many or too few samples downstream, nudge ratio in the appropriate
     /// direction.
     double CorrectForUnderAndOverflow(double ratio, size_t sample_delay) const;
-    /// INTERNAL: Gets the time-stretched samples from SoundTouch.
-    std::vector<s16> GetSamples();
+    /// INTERNAL: Gets the time-stretched samples from SoundTouch into the output buffer.
+    void GetSamples();
 };
 
 } // namespace AudioCore
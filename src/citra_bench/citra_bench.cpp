@@ -0,0 +1,377 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "citra_bench/emu_window_headless.h"
+#include "citra_bench/microbenchmarks.h"
+#include "citra_bench/results.h"
+#include "common/common_types.h"
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
+#include "core/movie.h"
+#include "core/settings.h"
+
+namespace {
+
+struct Options {
+    std::string rom_path;
+    std::string movie_path;
+    std::string output_path;
+    u64 num_frames = 3600;
+    u64 num_warmup_frames = 0;
+    u64 num_threads = 1;
+    bool use_cpu_jit = true;
+    std::string microbenchmark;
+    std::string log_filter = "*:Warning";
+};
+
+void PrintHelp(const char* argv0) {
+    std::printf("Usage: %s [options] <filename>\n"
+                "       %s --microbenchmark NAME [options]\n"
+                "Runs a title headlessly without frame limiting and reports performance "
+                "statistics as JSON.\n\n"
+                "  -m, --movie FILE          Replay the input recorded in a movie file\n"
+                "  -n, --frames N            Number of emulated frames or microbenchmark\n"
+                "                            iterations to measure (default: 3600)\n"
+                "  -w, --warmup N            Number of frames or iterations to run before\n"
+                "                            measuring (default: 0)\n"
+                "  -o, --output FILE         Write the statistics to FILE instead of stdout\n"
+                "  -i, --interpreter         Use the CPU interpreter instead of the JIT\n"
+                "  -t, --threads N           Threads used by the software rasterizer, vertex\n"
+                "                            shading, surface tiling and display transfers, 0 for\n"
+                "                            one per host core (default: 1)\n"
+                "  -l, --log-filter STR      Log filter (default: *:Warning)\n"
+                "  -b, --microbenchmark NAME Instead of running a title, run a microbenchmark\n"
+                "  -d, --display-transfer    Same as --microbenchmark display-transfer\n"
+                "  -h, --help                Display this help and exit\n\n"
+                "Microbenchmarks:\n",
+                argv0, argv0);
+    for (const auto& microbenchmark : Bench::GetMicrobenchmarks()) {
+        std::printf("  %-24s  %s\n", microbenchmark.name, microbenchmark.description);
+    }
+}
+
+/// Parses the command line. Returns false if the program should exit.
+bool ParseOptions(int argc, char* argv[], Options& options, int& exit_code) {
+    exit_code = EXIT_FAILURE;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto next_value = [&](std::string& value) {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+                return false;
+            }
+            value = argv[++i];
+            return true;
+        };
+        const auto next_number = [&](u64& value) {
+            std::string text;
+            if (!next_value(text))
+                return false;
+            char* end;
+            value = std::strtoull(text.c_str(), &end, 10);
+            if (text.empty() || *end != '\0') {
+                std::fprintf(stderr, "Invalid number for %s: %s\n", arg.c_str(), text.c_str());
+                return false;
+            }
+            return true;
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            PrintHelp(argv[0]);
+            exit_code = EXIT_SUCCESS;
+            return false;
+        } else if (arg == "-m" || arg == "--movie") {
+            if (!next_value(options.movie_path))
+                return false;
+        } else if (arg == "-n" || arg == "--frames") {
+            if (!next_number(options.num_frames))
+                return false;
+        } else if (arg == "-w" || arg == "--warmup") {
+            if (!next_number(options.num_warmup_frames))
+                return false;
+        } else if (arg == "-o" || arg == "--output") {
+            if (!next_value(options.output_path))
+                return false;
+        } else if (arg == "-i" || arg == "--interpreter") {
+            options.use_cpu_jit = false;
+        } else if (arg == "-t" || arg == "--threads") {
+            if (!next_number(options.num_threads))
+                return false;
+        } else if (arg == "-l" || arg == "--log-filter") {
+            if (!next_value(options.log_filter))
+                return false;
+        } else if (arg == "-b" || arg == "--microbenchmark") {
+            if (!next_value(options.microbenchmark))
+                return false;
+        } else if (arg == "-d" || arg == "--display-transfer") {
+            options.microbenchmark = "display-transfer";
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            PrintHelp(argv[0]);
+            return false;
+        } else if (options.rom_path.empty()) {
+            options.rom_path = arg;
+        } else {
+            std::fprintf(stderr, "Only one file can be run at a time\n");
+            return false;
+        }
+    }
+
+    if (options.rom_path.empty() == options.microbenchmark.empty()) {
+        PrintHelp(argv[0]);
+        return false;
+    }
+    if (!options.microbenchmark.empty() && !Bench::FindMicrobenchmark(options.microbenchmark)) {
+        std::fprintf(stderr, "Unknown microbenchmark %s\n", options.microbenchmark.c_str());
+        return false;
+    }
+    if (options.num_frames == 0) {
+        std::fprintf(stderr, "The number of frames must be at least 1\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Sets up the settings for a reproducible run: the same defaults as the Qt frontend, except that
+ * nothing is displayed or played back, the clock is fixed and the emulation is not limited to the
+ * speed of the real console.
+ */
+void ApplyBenchmarkSettings(const Options& options) {
+    Settings::values.sp_enable_3d = false;
+    Settings::values.p_adapter_connected = true;
+    Settings::values.p_battery_charging = true;
+    Settings::values.p_battery_level = 5;
+    Settings::values.n_wifi_status = 0;
+    Settings::values.n_wifi_link_level = 0;
+    Settings::values.n_state = 0;
+
+    Settings::values.use_cpu_jit = options.use_cpu_jit;
+    Settings::values.keyboard_mode = Settings::KeyboardMode::StdIn;
+
+    Settings::values.renderer_backend = Settings::RendererBackend::Software;
+    Settings::values.use_hw_renderer = false;
+    Settings::values.use_hw_shader = false;
+    Settings::values.shaders_accurate_gs = true;
+    Settings::values.shaders_accurate_mul = false;
+    Settings::values.use_shader_jit = true;
+    Settings::values.use_disk_shader_cache = false;
+    Settings::values.use_asynchronous_shader_compilation = false;
+    Settings::values.use_asynchronous_gpu_emulation = false;
+    Settings::values.use_texture_deduplication = false;
+    Settings::values.swrasterizer_num_threads = static_cast<u16>(options.num_threads);
+    Settings::values.vertex_shading_num_threads = static_cast<u16>(options.num_threads);
+    Settings::values.surface_tiling_num_threads = static_cast<u16>(options.num_threads);
+    Settings::values.display_transfer_num_threads = static_cast<u16>(options.num_threads);
+    Settings::values.resolution_factor = 1;
+    Settings::values.use_vsync = false;
+    Settings::values.use_frame_limit = false;
+    Settings::values.frame_limit = 100;
+
+    Settings::values.toggle_3d = false;
+    Settings::values.factor_3d = 0;
+    Settings::values.layout_option = Settings::LayoutOption::Default;
+    Settings::values.swap_screen = false;
+    Settings::values.custom_layout = false;
+
+    Settings::values.sink_id = "null";
+    Settings::values.enable_audio_stretching = false;
+    Settings::values.audio_device_id = "auto";
+    Settings::values.volume = 1.0f;
+    Settings::values.headphones_connected = false;
+
+    for (auto& camera_name : Settings::values.camera_name) {
+        camera_name = "blank";
+    }
+
+    Settings::values.use_virtual_sd = true;
+    Settings::values.region_value = Settings::REGION_VALUE_AUTO_SELECT;
+    Settings::values.init_clock = Settings::InitClock::FixedTime;
+    Settings::values.init_time = 946681277ULL;
+    Settings::values.enable_new_mode = false;
+
+    Settings::values.log_filter = options.log_filter;
+
+    Settings::values.priority_boost = false;
+    Settings::values.ticks_mode = Settings::TicksMode::Auto;
+    Settings::values.ticks = 0;
+    Settings::values.use_bos = false;
+
+    Settings::Apply();
+}
+
+std::string FormatResults(const Options& options, std::vector<double> frame_times,
+                          const Core::PerfStats::Results& stats, s64 movie_end_frame) {
+    std::sort(frame_times.begin(), frame_times.end());
+    const double cpu_time = std::max(0.0, stats.frametime - stats.gpu_time - stats.audio_time);
+
+    Bench::JsonObject time_per_frame;
+    time_per_frame.AddReal("cpu", cpu_time, 9);
+    time_per_frame.AddReal("gpu", stats.gpu_time, 9);
+    time_per_frame.AddReal("audio", stats.audio_time, 9);
+
+    Bench::JsonObject results;
+    results.AddString("build", Common::g_scm_desc);
+    results.AddString("file", options.rom_path);
+    results.AddString("movie", options.movie_path);
+    results.AddNumber("movie_end_frame", movie_end_frame);
+    results.AddBool("cpu_jit", options.use_cpu_jit);
+    results.AddNumber("threads", options.num_threads);
+    results.AddNumber("warmup_frames", options.num_warmup_frames);
+    results.AddNumber("frames", frame_times.size());
+    results.AddReal("emulation_speed", stats.emulation_speed);
+    results.AddReal("system_fps", stats.system_fps);
+    results.AddReal("game_fps", stats.game_fps);
+    results.AddObject("frame_time_seconds", Bench::SummarizeTimes(frame_times));
+    results.AddObject("time_per_frame_seconds", time_per_frame);
+    return results.Format();
+}
+
+/// Runs a microbenchmark and formats its results. Returns false if the benchmark failed.
+bool RunMicrobenchmark(const Options& options, std::string& output) {
+    const Bench::Microbenchmark* microbenchmark = Bench::FindMicrobenchmark(options.microbenchmark);
+    const Bench::Parameters parameters{options.num_frames, options.num_warmup_frames};
+
+    Bench::JsonObject results;
+    results.AddString("build", Common::g_scm_desc);
+    const bool passed = microbenchmark->run(parameters, results);
+    output = results.Format();
+    if (!passed) {
+        LOG_CRITICAL(Frontend, "Microbenchmark {} failed", microbenchmark->name);
+    }
+    return passed;
+}
+
+/// Writes the results to the output file, or to stdout if there is none
+bool WriteResults(const Options& options, const std::string& output) {
+    if (options.output_path.empty()) {
+        std::fputs(output.c_str(), stdout);
+        return true;
+    }
+
+    std::FILE* file = std::fopen(options.output_path.c_str(), "w");
+    if (file == nullptr) {
+        LOG_CRITICAL(Frontend, "Failed to open {} for writing", options.output_path);
+        return false;
+    }
+    std::fputs(output.c_str(), file);
+    std::fclose(file);
+    return true;
+}
+
+} // Anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    int exit_code;
+    if (!ParseOptions(argc, argv, options, exit_code)) {
+        return exit_code;
+    }
+
+    ApplyBenchmarkSettings(options);
+
+    Log::Filter log_filter;
+    log_filter.ParseFilterString(Settings::values.log_filter);
+    Log::SetGlobalFilter(log_filter);
+    Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
+
+    if (!options.microbenchmark.empty()) {
+        std::string output;
+        const bool passed = RunMicrobenchmark(options, output);
+        return WriteResults(options, output) && passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    EmuWindow_Headless emu_window{400, 480};
+
+    Core::System& system{Core::System::GetInstance()};
+    const Core::System::ResultStatus load_result{system.Load(emu_window, options.rom_path)};
+    if (load_result != Core::System::ResultStatus::Success) {
+        LOG_CRITICAL(Frontend, "Failed to load {} (error {})", options.rom_path,
+                     static_cast<u32>(load_result));
+        return EXIT_FAILURE;
+    }
+
+    std::vector<double> frame_times;
+    s64 movie_end_frame = -1;
+    if (!options.movie_path.empty()) {
+        u64 program_id{};
+        system.GetAppLoader().ReadProgramId(program_id);
+        switch (Core::Movie::GetInstance().ValidateMovie(options.movie_path, program_id)) {
+        case Core::Movie::ValidationResult::OK:
+            break;
+        case Core::Movie::ValidationResult::RevisionDismatch:
+            LOG_WARNING(Frontend, "The movie was recorded with a different revision of Citra");
+            break;
+        case Core::Movie::ValidationResult::GameDismatch:
+            LOG_WARNING(Frontend, "The movie was recorded with a different game");
+            break;
+        case Core::Movie::ValidationResult::Invalid:
+            LOG_CRITICAL(Frontend, "{} is not a valid movie file", options.movie_path);
+            system.Shutdown();
+            return EXIT_FAILURE;
+        }
+        Core::Movie::GetInstance().StartPlayback(options.movie_path, [&] {
+            movie_end_frame = static_cast<s64>(frame_times.size());
+        });
+    }
+
+    const u64 total_frames = options.num_warmup_frames + options.num_frames;
+    Core::PerfStats::Results stats{};
+    bool measuring = false;
+
+    system.perf_stats.SetFrameTimeRecording(true);
+    if (options.num_warmup_frames == 0) {
+        system.GetAndResetPerfStats();
+        measuring = true;
+    }
+
+    while (frame_times.size() < total_frames) {
+        const Core::System::ResultStatus result{system.RunLoop()};
+        if (result != Core::System::ResultStatus::Success) {
+            LOG_ERROR(Frontend, "Emulation stopped after {} frames (status {})",
+                      frame_times.size(), static_cast<u32>(result));
+            break;
+        }
+
+        const std::vector<double> new_frame_times{system.perf_stats.TakeRecordedFrameTimes()};
+        frame_times.insert(frame_times.end(), new_frame_times.begin(), new_frame_times.end());
+
+        if (!measuring && frame_times.size() >= options.num_warmup_frames) {
+            system.GetAndResetPerfStats();
+            measuring = true;
+        }
+    }
+    if (measuring) {
+        stats = system.GetAndResetPerfStats();
+    }
+
+    system.perf_stats.SetFrameTimeRecording(false);
+    Core::Movie::GetInstance().Shutdown();
+    system.Shutdown();
+
+    if (!measuring || frame_times.size() <= options.num_warmup_frames) {
+        LOG_CRITICAL(Frontend, "No frames were measured");
+        return EXIT_FAILURE;
+    }
+
+    frame_times.erase(frame_times.begin(),
+                      frame_times.begin() + static_cast<std::ptrdiff_t>(options.num_warmup_frames));
+    if (frame_times.size() > options.num_frames) {
+        frame_times.resize(options.num_frames);
+    }
+    const std::string output{FormatResults(options, std::move(frame_times), stats,
+                                           movie_end_frame)};
+
+    return WriteResults(options, output) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,19 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "citra_bench/emu_window_headless.h"
+
+EmuWindow_Headless::EmuWindow_Headless(unsigned width, unsigned height) {
+    UpdateCurrentFramebufferLayout(width, height);
+}
+
+EmuWindow_Headless::~EmuWindow_Headless() = default;
+
+void EmuWindow_Headless::SwapBuffers() {}
+
+void EmuWindow_Headless::PollEvents() {}
+
+void EmuWindow_Headless::MakeCurrent() {}
+
+void EmuWindow_Headless::DoneCurrent() {}
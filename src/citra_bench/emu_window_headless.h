@@ -0,0 +1,26 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "core/frontend/emu_window.h"
+
+/// Window without any display or graphics context, for use with the software renderer backend
+class EmuWindow_Headless : public EmuWindow {
+public:
+    EmuWindow_Headless(unsigned width, unsigned height);
+    ~EmuWindow_Headless() override;
+
+    /// Does nothing, as there is nothing to present to
+    void SwapBuffers() override;
+
+    /// Does nothing, as there are no window events
+    void PollEvents() override;
+
+    /// Does nothing, as there is no graphics context
+    void MakeCurrent() override;
+
+    /// Does nothing, as there is no graphics context
+    void DoneCurrent() override;
+};
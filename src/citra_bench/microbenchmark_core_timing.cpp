@@ -0,0 +1,90 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+#include "citra_bench/microbenchmarks.h"
+#include "core/core_timing.h"
+
+namespace Bench {
+
+namespace {
+
+constexpr size_t NUM_EVENT_TYPES = 64;
+constexpr size_t NUM_PENDING_EVENTS = 5000;
+/// Events cancelled and scheduled again per slice, like thread wakeups that get rescheduled
+constexpr size_t NUM_RESCHEDULES_PER_SLICE = 1000;
+/// Events are scheduled up to this far into the future, so that most stay pending for many slices
+const s64 MAX_EVENT_DELAY = msToCycles(50);
+
+u32 random_seed;
+
+u32 NextRandom() {
+    random_seed = random_seed * 1103515245 + 12345;
+    return random_seed >> 8;
+}
+
+s64 RandomDelay() {
+    return 1 + static_cast<s64>(NextRandom()) % MAX_EVENT_DELAY;
+}
+
+std::vector<CoreTiming::EventType*> event_types;
+u64 num_dispatched_events;
+
+/// Each pending event is identified by its type and userdata, and reschedules itself when it fires
+void EventCallback(u64 userdata, s64 cycles_late) {
+    ++num_dispatched_events;
+    CoreTiming::ScheduleEvent(RandomDelay(), event_types[userdata % NUM_EVENT_TYPES], userdata);
+}
+
+/// Runs one timing slice: cancels and reschedules pending events, then dispatches the due ones
+void RunSlice() {
+    CoreTiming::Advance();
+    for (size_t i = 0; i < NUM_RESCHEDULES_PER_SLICE; ++i) {
+        const u64 userdata = NextRandom() % NUM_PENDING_EVENTS;
+        CoreTiming::EventType* const event_type = event_types[userdata % NUM_EVENT_TYPES];
+        CoreTiming::UnscheduleEvent(event_type, userdata);
+        CoreTiming::ScheduleEvent(RandomDelay(), event_type, userdata);
+    }
+    CoreTiming::AddTicks(static_cast<u64>(CoreTiming::GetDowncount()));
+}
+
+} // Anonymous namespace
+
+/**
+ * Times CoreTiming with thousands of pending events, each timing slice cancelling and rescheduling
+ * a thousand of them and dispatching the ones that are due.
+ */
+bool RunCoreTimingBenchmark(const Parameters& parameters, JsonObject& results) {
+    random_seed = 1;
+    num_dispatched_events = 0;
+
+    CoreTiming::Init();
+    for (size_t i = 0; i < NUM_EVENT_TYPES; ++i) {
+        event_types.push_back(
+            CoreTiming::RegisterEvent("BenchmarkEvent" + std::to_string(i), EventCallback));
+    }
+    for (u64 userdata = 0; userdata < NUM_PENDING_EVENTS; ++userdata) {
+        CoreTiming::ScheduleEvent(RandomDelay(), event_types[userdata % NUM_EVENT_TYPES], userdata);
+    }
+
+    const std::vector<double> times = MeasureTimes(parameters, RunSlice);
+    const u64 total_slices = parameters.num_warmup_iterations + parameters.num_iterations;
+
+    CoreTiming::Shutdown();
+    event_types.clear();
+
+    results.AddString("benchmark", "core_timing_reschedule");
+    results.AddNumber("pending_events", NUM_PENDING_EVENTS);
+    results.AddNumber("reschedules_per_slice", NUM_RESCHEDULES_PER_SLICE);
+    results.AddReal("dispatched_events_per_slice",
+                    static_cast<double>(num_dispatched_events) / total_slices);
+    results.AddNumber("warmup_iterations", parameters.num_warmup_iterations);
+    results.AddNumber("iterations", parameters.num_iterations);
+    results.AddReal("reschedules_per_second", NUM_RESCHEDULES_PER_SLICE / Mean(times));
+    results.AddObject("slice_time_seconds", SummarizeTimes(times));
+    return true;
+}
+
+} // namespace Bench
@@ -0,0 +1,43 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include "citra_bench/microbenchmarks.h"
+#include "core/hw/gpu.h"
+#include "core/settings.h"
+
+namespace Bench {
+
+/**
+ * Times GPU::ConvertDisplayTransfer on the transfer every title does to present the top screen:
+ * a 240x400 tiled RGBA8 framebuffer copied to a linear RGB8 one.
+ */
+bool RunDisplayTransferBenchmark(const Parameters& parameters, JsonObject& results) {
+    GPU::Regs::DisplayTransferConfig config{};
+    config.input_width.Assign(240);
+    config.input_height.Assign(400);
+    config.output_width.Assign(240);
+    config.output_height.Assign(400);
+    config.input_format.Assign(GPU::Regs::PixelFormat::RGBA8);
+    config.output_format.Assign(GPU::Regs::PixelFormat::RGB8);
+
+    std::vector<u8> src(240 * 400 * 4);
+    std::vector<u8> dst(240 * 400 * 3);
+    for (size_t i = 0; i < src.size(); ++i) {
+        src[i] = static_cast<u8>(i * 7 + i / 4096);
+    }
+
+    const std::vector<double> times = MeasureTimes(
+        parameters, [&] { GPU::ConvertDisplayTransfer(config, src.data(), dst.data()); });
+
+    results.AddString("benchmark", "display_transfer_rgba8_tiled_to_rgb8_linear");
+    results.AddNumber("threads", Settings::values.display_transfer_num_threads);
+    results.AddNumber("warmup_iterations", parameters.num_warmup_iterations);
+    results.AddNumber("iterations", times.size());
+    results.AddReal("megapixels_per_second", 240 * 400 / Mean(times) / 1e6);
+    results.AddObject("time_seconds", SummarizeTimes(times));
+    return true;
+}
+
+} // namespace Bench
@@ -0,0 +1,239 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+#include "audio_core/audio_types.h"
+#include "audio_core/codec.h"
+#include "audio_core/hle/common.h"
+#include "audio_core/hle/mixers.h"
+#include "audio_core/hle/shared_memory.h"
+#include "audio_core/hle/source.h"
+#include "audio_core/simd.h"
+#include "citra_bench/microbenchmarks.h"
+#include "common/logging/log.h"
+#include "core/memory.h"
+
+namespace Bench {
+
+namespace {
+
+using AudioCore::QuadFrame32;
+using AudioCore::StereoBuffer16;
+using AudioCore::StereoFrame16;
+using SourceConfig = AudioCore::HLE::SourceConfiguration::Configuration;
+using OutputFormat = AudioCore::HLE::DspConfiguration::OutputFormat;
+
+/// Odd, so that the decoders also run the scalar code for the samples left over by the SSE2 loops
+constexpr size_t DECODE_SAMPLE_COUNT = 4095;
+/// Length of the looping buffer played by each source
+constexpr u32 SOURCE_BUFFER_LENGTH = 1000;
+
+/// Deterministic pseudorandom numbers, so that both code paths get the same input
+class Random {
+public:
+    u32 Next() {
+        seed = seed * 1103515245 + 12345;
+        return seed >> 8;
+    }
+
+    /// Uniformly distributed in [min, max)
+    float NextFloat(float min, float max) {
+        return min + (max - min) * static_cast<float>(Next() % 65536) / 65536.0f;
+    }
+
+private:
+    u32 seed = 1;
+};
+
+/// Runs function once with the scalar code paths and once with the SSE2 ones
+template <typename Function>
+void WithEachCodePath(Function&& function) {
+    AudioCore::SetSimdEnabled(false);
+    function(false);
+    AudioCore::SetSimdEnabled(true);
+    function(true);
+}
+
+/**
+ * Times the PCM8 and PCM16 decoders on mono and stereo data. Returns false if the two code paths
+ * decode any sample differently.
+ */
+bool RunDecodeBenchmarks(const Parameters& parameters, JsonObject& results) {
+    Random random;
+    std::vector<u8> data(DECODE_SAMPLE_COUNT * 2 * sizeof(s16));
+    for (u8& byte : data) {
+        byte = static_cast<u8>(random.Next());
+    }
+
+    bool all_identical = true;
+    for (const bool pcm16 : {false, true}) {
+        for (const unsigned num_channels : {1u, 2u}) {
+            const auto decode = [&] {
+                return pcm16 ? AudioCore::Codec::DecodePCM16(num_channels, data.data(),
+                                                             DECODE_SAMPLE_COUNT)
+                             : AudioCore::Codec::DecodePCM8(num_channels, data.data(),
+                                                            DECODE_SAMPLE_COUNT);
+            };
+
+            std::array<StereoBuffer16, 2> decoded;
+            std::array<std::vector<double>, 2> times;
+            WithEachCodePath([&](bool simd) {
+                decoded[simd] = decode();
+                times[simd] = MeasureTimes(parameters, decode);
+            });
+
+            const bool identical = decoded[0] == decoded[1];
+            const std::string name = fmt::format("pcm{}_{}", pcm16 ? 16 : 8,
+                                                 num_channels == 1 ? "mono" : "stereo");
+            if (!identical) {
+                LOG_CRITICAL(Frontend, "The SSE2 path of {} differs from the scalar one", name);
+                all_identical = false;
+            }
+
+            JsonObject result;
+            result.AddReal("scalar_megasamples_per_second",
+                           DECODE_SAMPLE_COUNT / Mean(times[0]) / 1e6);
+            result.AddReal("sse2_megasamples_per_second",
+                           DECODE_SAMPLE_COUNT / Mean(times[1]) / 1e6);
+            result.AddReal("speedup", Mean(times[0]) / Mean(times[1]));
+            result.AddBool("identical_output", identical);
+            results.AddObject(name, result);
+        }
+    }
+    return all_identical;
+}
+
+/**
+ * Generates audio frames the way DspHle does: every source plays a looping buffer of random
+ * samples and mixes it into the intermediate mixes, which are then downmixed into the final
+ * frame by a mono and a stereo Mixers.
+ */
+class MixPipeline {
+public:
+    MixPipeline() {
+        Random random;
+        u8* const memory = Memory::GetPhysicalPointer(Memory::N3DS_EXTRA_RAM_PADDR);
+        const size_t buffer_size = SOURCE_BUFFER_LENGTH * 2 * sizeof(s16);
+
+        sources.reserve(AudioCore::HLE::num_sources);
+        for (size_t i = 0; i < AudioCore::HLE::num_sources; ++i) {
+            for (size_t byte = 0; byte < buffer_size; ++byte) {
+                memory[i * buffer_size + byte] = static_cast<u8>(random.Next());
+            }
+
+            SourceConfig config{};
+            config.enable_dirty.Assign(1);
+            config.enable = 1;
+            config.rate_multiplier_dirty.Assign(1);
+            config.rate_multiplier = 1.0f;
+            config.interpolation_dirty.Assign(1);
+            config.interpolation_mode = SourceConfig::InterpolationMode::None;
+            config.format.Assign(i % 2 == 0 ? SourceConfig::Format::PCM16
+                                            : SourceConfig::Format::PCM8);
+            config.mono_or_stereo.Assign(i % 4 < 2 ? SourceConfig::MonoOrStereo::Stereo
+                                                   : SourceConfig::MonoOrStereo::Mono);
+            config.embedded_buffer_dirty.Assign(1);
+            config.physical_address =
+                static_cast<u32>(Memory::N3DS_EXTRA_RAM_PADDR + i * buffer_size);
+            config.length = SOURCE_BUFFER_LENGTH;
+            config.is_looping.Assign(1);
+            config.gain_0_dirty.Assign(1);
+            config.gain_1_dirty.Assign(1);
+            config.gain_2_dirty.Assign(1);
+            for (auto& mix_gains : config.gain) {
+                for (auto& gain : mix_gains) {
+                    gain = random.NextFloat(0.0f, 1.0f);
+                }
+            }
+            source_configs.push_back(config);
+            sources.emplace_back(i);
+        }
+
+        for (size_t i = 0; i < mixers.size(); ++i) {
+            auto& config = dsp_configs[i];
+            config.output_format_dirty.Assign(1);
+            config.output_format = i == 0 ? OutputFormat::Mono : OutputFormat::Stereo;
+            config.volume_0_dirty.Assign(1);
+            config.volume_1_dirty.Assign(1);
+            config.volume_2_dirty.Assign(1);
+            for (auto& volume : config.volume) {
+                volume = random.NextFloat(0.25f, 1.5f);
+            }
+        }
+    }
+
+    /// Generates the next frame and appends the output of the mixers to outputs
+    void Tick() {
+        std::array<QuadFrame32, 3> intermediate_mixes = {};
+        for (size_t i = 0; i < sources.size(); ++i) {
+            sources[i].Tick(source_configs[i], adpcm_coeffs);
+            for (size_t mix = 0; mix < intermediate_mixes.size(); ++mix) {
+                sources[i].MixInto(intermediate_mixes[mix], mix);
+            }
+        }
+
+        for (size_t i = 0; i < mixers.size(); ++i) {
+            mixers[i].Tick(dsp_configs[i], read_samples, write_samples, intermediate_mixes);
+            outputs.push_back(mixers[i].GetOutput());
+        }
+    }
+
+    std::vector<StereoFrame16> outputs;
+
+private:
+    std::vector<AudioCore::HLE::Source> sources;
+    std::vector<SourceConfig> source_configs;
+    s16_le adpcm_coeffs[16] = {};
+
+    std::array<AudioCore::HLE::Mixers, 2> mixers;
+    std::array<AudioCore::HLE::DspConfiguration, 2> dsp_configs{};
+    AudioCore::HLE::IntermediateMixSamples read_samples{};
+    AudioCore::HLE::IntermediateMixSamples write_samples{};
+};
+
+} // Anonymous namespace
+
+/**
+ * Compares the SSE2 paths of the DSP HLE against the scalar ones: the PCM decoders on their own,
+ * and Source::MixInto and the Mixers downmix by generating audio frames from random sources.
+ * Fails if the two code paths produce any different sample.
+ */
+bool RunDspBenchmark(const Parameters& parameters, JsonObject& results) {
+    JsonObject decode;
+    bool identical = RunDecodeBenchmarks(parameters, decode);
+
+    std::array<std::vector<StereoFrame16>, 2> outputs;
+    std::array<std::vector<double>, 2> times;
+    WithEachCodePath([&](bool simd) {
+        MixPipeline pipeline;
+        times[simd] = MeasureTimes(parameters, [&] { pipeline.Tick(); });
+        outputs[simd] = std::move(pipeline.outputs);
+    });
+
+    const bool mix_identical = outputs[0] == outputs[1];
+    if (!mix_identical) {
+        LOG_CRITICAL(Frontend, "The SSE2 paths of the DSP mixers differ from the scalar ones");
+        identical = false;
+    }
+
+    JsonObject mix;
+    mix.AddNumber("sources", AudioCore::HLE::num_sources);
+    mix.AddReal("scalar_frames_per_second", 1.0 / Mean(times[0]));
+    mix.AddReal("sse2_frames_per_second", 1.0 / Mean(times[1]));
+    mix.AddReal("speedup", Mean(times[0]) / Mean(times[1]));
+    mix.AddBool("identical_output", mix_identical);
+
+    results.AddString("benchmark", "dsp_scalar_against_sse2");
+    results.AddNumber("warmup_iterations", parameters.num_warmup_iterations);
+    results.AddNumber("iterations", parameters.num_iterations);
+    results.AddObject("decode", decode);
+    results.AddObject("mix", mix);
+    results.AddBool("identical_output", identical);
+    return identical;
+}
+
+} // namespace Bench
@@ -0,0 +1,127 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <unordered_map>
+#include <vector>
+#include "citra_bench/microbenchmarks.h"
+#include "common/logging/log.h"
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
+
+namespace Bench {
+
+namespace {
+
+constexpr size_t NUM_BLOCKS = 5000;
+constexpr size_t NUM_LOOKUPS = 100000;
+constexpr u32 CODE_START = 0x00100000;
+constexpr u32 CODE_SIZE = 4 * 1024 * 1024;
+/// Blocks are spaced this far apart in the translation buffer
+constexpr size_t BLOCK_SIZE = 256;
+
+/// Receives the lookup results, so that the compiler cannot drop the lookups
+volatile size_t lookup_sink;
+
+/// Looks up every address
+template <typename Find>
+void LookupAll(const std::vector<u32>& addresses, Find&& find) {
+    size_t sum = 0;
+    for (const u32 address : addresses) {
+        sum += find(address);
+    }
+    lookup_sink = sum;
+}
+
+} // Anonymous namespace
+
+/**
+ * Times looking up translated blocks in DynComBlockCache against the std::unordered_map the dyncom
+ * interpreter used before, with thousands of blocks translated in a title's code region. Fails if
+ * the two find different blocks, or if InvalidateRange drops the wrong blocks.
+ */
+bool RunDynComBlockCacheBenchmark(const Parameters& parameters, JsonObject& results) {
+    u32 seed = 1;
+    const auto random = [&seed] {
+        seed = seed * 1103515245 + 12345;
+        return seed >> 8;
+    };
+    const auto random_address = [&] { return CODE_START + ((random() % CODE_SIZE) & ~3u); };
+
+    DynComBlockCache cache;
+    std::unordered_map<u32, size_t> map;
+    std::vector<u32> block_addresses;
+    for (size_t i = 0; i < NUM_BLOCKS; ++i) {
+        const u32 address = random_address();
+        cache.Insert(address, i * BLOCK_SIZE);
+        map[address] = i * BLOCK_SIZE;
+        block_addresses.push_back(address);
+    }
+
+    // Most lookups find a block, like the dispatcher does once the hot code has been translated
+    std::vector<u32> lookups;
+    lookups.reserve(NUM_LOOKUPS);
+    for (size_t i = 0; i < NUM_LOOKUPS; ++i) {
+        lookups.push_back(random() % 8 != 0 ? block_addresses[random() % NUM_BLOCKS]
+                                            : random_address());
+    }
+
+    const auto find_in_cache = [&cache](u32 address) { return cache.Find(address); };
+    const auto find_in_map = [&map](u32 address) {
+        const auto iter = map.find(address);
+        return iter != map.end() ? iter->second : DynComBlockCache::NOT_FOUND;
+    };
+
+    bool identical = true;
+    for (const u32 address : lookups) {
+        identical &= find_in_cache(address) == find_in_map(address);
+    }
+    if (!identical) {
+        LOG_CRITICAL(Frontend, "DynComBlockCache found different blocks than the map");
+    }
+
+    // Invalidating a page also drops the page before it, for blocks extending into the range
+    const u32 invalidated_start = CODE_START + CODE_SIZE / 2;
+    const u32 invalidated_size = 0x1000;
+    bool invalidated_correctly = true;
+    DynComBlockCache invalidated_cache;
+    for (const auto& block : map) {
+        invalidated_cache.Insert(block.first, block.second);
+    }
+    invalidated_cache.InvalidateRange(invalidated_start, invalidated_size);
+    for (const auto& block : map) {
+        const bool dropped = block.first >= invalidated_start - 0x1000 &&
+                             block.first < invalidated_start + invalidated_size;
+        const size_t expected = dropped ? DynComBlockCache::NOT_FOUND : block.second;
+        invalidated_correctly &= invalidated_cache.Find(block.first) == expected;
+    }
+    if (!invalidated_correctly) {
+        LOG_CRITICAL(Frontend, "DynComBlockCache::InvalidateRange dropped the wrong blocks");
+    }
+
+    const std::vector<double> cache_times =
+        MeasureTimes(parameters, [&] { LookupAll(lookups, find_in_cache); });
+    const std::vector<double> map_times =
+        MeasureTimes(parameters, [&] { LookupAll(lookups, find_in_map); });
+
+    JsonObject block_cache;
+    block_cache.AddReal("lookups_per_second", NUM_LOOKUPS / Mean(cache_times));
+    block_cache.AddObject("time_seconds", SummarizeTimes(cache_times));
+
+    JsonObject unordered_map;
+    unordered_map.AddReal("lookups_per_second", NUM_LOOKUPS / Mean(map_times));
+    unordered_map.AddObject("time_seconds", SummarizeTimes(map_times));
+
+    results.AddString("benchmark", "dyncom_block_cache_lookup");
+    results.AddNumber("blocks", NUM_BLOCKS);
+    results.AddNumber("lookups", NUM_LOOKUPS);
+    results.AddNumber("warmup_iterations", parameters.num_warmup_iterations);
+    results.AddNumber("iterations", parameters.num_iterations);
+    results.AddObject("block_cache", block_cache);
+    results.AddObject("unordered_map", unordered_map);
+    results.AddReal("speedup", Mean(map_times) / Mean(cache_times));
+    results.AddBool("identical_output", identical);
+    results.AddBool("invalidated_correctly", invalidated_correctly);
+    return identical && invalidated_correctly;
+}
+
+} // namespace Bench
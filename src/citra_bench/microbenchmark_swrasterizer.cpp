@@ -0,0 +1,160 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "citra_bench/microbenchmarks.h"
+#include "common/logging/log.h"
+#include "core/memory.h"
+#include "core/settings.h"
+#include "video_core/pica_state.h"
+#include "video_core/pica_types.h"
+#include "video_core/regs_framebuffer.h"
+#include "video_core/swrasterizer/rasterizer.h"
+
+namespace Bench {
+
+namespace {
+
+using Pica::float24;
+
+constexpr u32 FRAMEBUFFER_WIDTH = 400;
+constexpr u32 FRAMEBUFFER_HEIGHT = 240;
+constexpr u32 FRAMEBUFFER_SIZE = FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT * 4;
+constexpr size_t NUM_TRIANGLES = 2000;
+
+/// Draws into an RGBA8 framebuffer at the start of VRAM, alpha blending every triangle so that the
+/// result depends on the order the triangles are drawn in
+void SetupRegisters() {
+    Pica::g_state.Reset();
+    auto& regs = Pica::g_state.regs;
+
+    auto& framebuffer = regs.framebuffer.framebuffer;
+    framebuffer.color_buffer_address.Assign(Memory::VRAM_PADDR / 8);
+    framebuffer.width.Assign(FRAMEBUFFER_WIDTH);
+    framebuffer.height.Assign(FRAMEBUFFER_HEIGHT - 1);
+    framebuffer.color_format.Assign(Pica::FramebufferRegs::ColorFormat::RGBA8);
+    framebuffer.allow_color_write.Assign(0xF);
+
+    auto& output_merger = regs.framebuffer.output_merger;
+    output_merger.alphablend_enable.Assign(1);
+    output_merger.alpha_blending.blend_equation_rgb.Assign(
+        Pica::FramebufferRegs::BlendEquation::Add);
+    output_merger.alpha_blending.blend_equation_a.Assign(Pica::FramebufferRegs::BlendEquation::Add);
+    output_merger.alpha_blending.factor_source_rgb.Assign(
+        Pica::FramebufferRegs::BlendFactor::SourceAlpha);
+    output_merger.alpha_blending.factor_dest_rgb.Assign(
+        Pica::FramebufferRegs::BlendFactor::OneMinusSourceAlpha);
+    output_merger.alpha_blending.factor_source_a.Assign(Pica::FramebufferRegs::BlendFactor::One);
+    output_merger.alpha_blending.factor_dest_a.Assign(Pica::FramebufferRegs::BlendFactor::Zero);
+
+    regs.lighting.disable.Assign(1);
+}
+
+/// Generates overlapping triangles of random sizes and colors, the same ones on every call
+std::vector<Pica::Rasterizer::Vertex> GenerateTriangles() {
+    u32 seed = 1;
+    const auto random = [&seed](u32 range) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % range;
+    };
+
+    std::vector<Pica::Rasterizer::Vertex> vertices;
+    vertices.reserve(NUM_TRIANGLES * 3);
+    for (size_t triangle = 0; triangle < NUM_TRIANGLES; ++triangle) {
+        const u32 size = 8 + random(88);
+        const u32 center_x = size / 2 + random(FRAMEBUFFER_WIDTH - size);
+        const u32 center_y = size / 2 + random(FRAMEBUFFER_HEIGHT - size);
+        const u32 corners[3][2] = {
+            {center_x - size / 2, center_y - size / 2},
+            {center_x + size / 2, center_y - random(size / 2)},
+            {center_x - random(size / 2), center_y + size / 2},
+        };
+
+        for (const auto& corner : corners) {
+            Pica::Shader::OutputVertex output{};
+            output.pos.w = float24::FromFloat32(1.0f);
+            output.color = Math::MakeVec(float24::FromFloat32(random(256) / 255.0f),
+                                         float24::FromFloat32(random(256) / 255.0f),
+                                         float24::FromFloat32(random(256) / 255.0f),
+                                         float24::FromFloat32((64 + random(192)) / 255.0f));
+
+            Pica::Rasterizer::Vertex vertex(output);
+            vertex.screenpos = Math::MakeVec(float24::FromFloat32(static_cast<float>(corner[0])),
+                                             float24::FromFloat32(static_cast<float>(corner[1])),
+                                             float24::FromFloat32(0.5f));
+            vertices.push_back(vertex);
+        }
+    }
+    return vertices;
+}
+
+/// Draws the triangles into a cleared framebuffer
+void DrawTriangles(const std::vector<Pica::Rasterizer::Vertex>& vertices, u8* framebuffer) {
+    std::memset(framebuffer, 0, FRAMEBUFFER_SIZE);
+    for (size_t i = 0; i < vertices.size(); i += 3) {
+        Pica::Rasterizer::ProcessTriangle(vertices[i], vertices[i + 1], vertices[i + 2]);
+    }
+    Pica::Rasterizer::FlushTriangles();
+}
+
+} // Anonymous namespace
+
+/**
+ * Times the software rasterizer drawing a frame of blended triangles, once rasterizing every
+ * triangle immediately and once binning them into tiles shaded by a thread pool. Fails if the
+ * two paths draw different images.
+ */
+bool RunSwRasterizerBenchmark(const Parameters& parameters, JsonObject& results) {
+    const size_t num_threads =
+        Settings::values.swrasterizer_num_threads > 1
+            ? Settings::values.swrasterizer_num_threads
+            : std::max<size_t>(std::thread::hardware_concurrency(), 2);
+
+    SetupRegisters();
+    const auto vertices = GenerateTriangles();
+    u8* framebuffer = Memory::GetPhysicalPointer(Memory::VRAM_PADDR);
+
+    const auto measure = [&](size_t threads, std::vector<u8>& image) {
+        Pica::Rasterizer::Init(threads);
+        const std::vector<double> times =
+            MeasureTimes(parameters, [&] { DrawTriangles(vertices, framebuffer); });
+        Pica::Rasterizer::Shutdown();
+        image.assign(framebuffer, framebuffer + FRAMEBUFFER_SIZE);
+        return times;
+    };
+
+    std::vector<u8> immediate_image;
+    std::vector<u8> binned_image;
+    const std::vector<double> immediate_times = measure(1, immediate_image);
+    const std::vector<double> binned_times = measure(num_threads, binned_image);
+    const bool identical = immediate_image == binned_image;
+    if (!identical) {
+        LOG_CRITICAL(Frontend, "The binned rasterizer drew a different image");
+    }
+
+    JsonObject immediate;
+    immediate.AddNumber("threads", 1);
+    immediate.AddReal("triangles_per_second", NUM_TRIANGLES / Mean(immediate_times));
+    immediate.AddObject("time_seconds", SummarizeTimes(immediate_times));
+
+    JsonObject binned;
+    binned.AddNumber("threads", num_threads);
+    binned.AddReal("triangles_per_second", NUM_TRIANGLES / Mean(binned_times));
+    binned.AddObject("time_seconds", SummarizeTimes(binned_times));
+
+    results.AddString("benchmark", "swrasterizer_blended_triangles");
+    results.AddNumber("triangles", NUM_TRIANGLES);
+    results.AddNumber("warmup_iterations", parameters.num_warmup_iterations);
+    results.AddNumber("iterations", parameters.num_iterations);
+    results.AddObject("immediate", immediate);
+    results.AddObject("binned", binned);
+    results.AddReal("speedup", Mean(immediate_times) / Mean(binned_times));
+    results.AddBool("identical_output", identical);
+    return identical;
+}
+
+} // namespace Bench
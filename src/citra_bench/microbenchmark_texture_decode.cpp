@@ -0,0 +1,106 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <vector>
+#include "citra_bench/microbenchmarks.h"
+#include "common/logging/log.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace Bench {
+
+namespace {
+
+using Pica::TexturingRegs;
+
+constexpr unsigned int TEXTURE_SIZE = 256;
+
+constexpr struct {
+    TexturingRegs::TextureFormat format;
+    const char* name;
+} TEXTURE_FORMATS[] = {
+    {TexturingRegs::TextureFormat::RGBA8, "rgba8"},
+    {TexturingRegs::TextureFormat::RGB8, "rgb8"},
+    {TexturingRegs::TextureFormat::RGB5A1, "rgb5a1"},
+    {TexturingRegs::TextureFormat::RGB565, "rgb565"},
+    {TexturingRegs::TextureFormat::RGBA4, "rgba4"},
+    {TexturingRegs::TextureFormat::IA8, "ia8"},
+    {TexturingRegs::TextureFormat::RG8, "rg8"},
+    {TexturingRegs::TextureFormat::I8, "i8"},
+    {TexturingRegs::TextureFormat::A8, "a8"},
+    {TexturingRegs::TextureFormat::IA4, "ia4"},
+    {TexturingRegs::TextureFormat::I4, "i4"},
+    {TexturingRegs::TextureFormat::A4, "a4"},
+    {TexturingRegs::TextureFormat::ETC1, "etc1"},
+    {TexturingRegs::TextureFormat::ETC1A4, "etc1a4"},
+};
+
+/// Decodes the texture one texel at a time, the way it was done before DecodeTexture existed
+void LookupEveryTexel(const u8* source, const Pica::Texture::TextureInfo& info, u8* dest) {
+    for (unsigned int y = 0; y < info.height; ++y) {
+        for (unsigned int x = 0; x < info.width; ++x) {
+            Math::Vec4<u8> texel = Pica::Texture::LookupTexture(source, x, y, info);
+            std::memcpy(dest + (y * info.width + x) * 4, texel.AsArray(), 4);
+        }
+    }
+}
+
+} // Anonymous namespace
+
+/**
+ * Times decoding a texture of random data in every format, once texel by texel with LookupTexture
+ * and once a tile at a time with DecodeTexture. Fails if the two decode any texel differently.
+ */
+bool RunTextureDecodeBenchmark(const Parameters& parameters, JsonObject& results) {
+    constexpr double megatexels = TEXTURE_SIZE * TEXTURE_SIZE / 1e6;
+    bool all_identical = true;
+
+    JsonObject formats;
+    for (const auto& texture_format : TEXTURE_FORMATS) {
+        Pica::Texture::TextureInfo info{};
+        info.width = TEXTURE_SIZE;
+        info.height = TEXTURE_SIZE;
+        info.format = texture_format.format;
+        info.SetDefaultStride();
+
+        std::vector<u8> source(info.stride * (TEXTURE_SIZE / 8));
+        u32 seed = static_cast<u32>(texture_format.format) + 1;
+        for (u8& byte : source) {
+            seed = seed * 1103515245 + 12345;
+            byte = static_cast<u8>(seed >> 16);
+        }
+
+        std::vector<u8> lookup_texels(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+        std::vector<u8> decoded_texels(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+        const std::vector<double> lookup_times = MeasureTimes(
+            parameters, [&] { LookupEveryTexel(source.data(), info, lookup_texels.data()); });
+        const std::vector<double> decode_times = MeasureTimes(parameters, [&] {
+            Pica::Texture::DecodeTexture(source.data(), info, 0, 0, TEXTURE_SIZE, TEXTURE_SIZE,
+                                         decoded_texels.data(), TEXTURE_SIZE * 4);
+        });
+
+        const bool identical = lookup_texels == decoded_texels;
+        if (!identical) {
+            LOG_CRITICAL(Frontend, "DecodeTexture decoded {} differently than LookupTexture",
+                         texture_format.name);
+            all_identical = false;
+        }
+
+        JsonObject format;
+        format.AddReal("lookup_megatexels_per_second", megatexels / Mean(lookup_times));
+        format.AddReal("decode_megatexels_per_second", megatexels / Mean(decode_times));
+        format.AddReal("speedup", Mean(lookup_times) / Mean(decode_times));
+        format.AddBool("identical_output", identical);
+        formats.AddObject(texture_format.name, format);
+    }
+
+    results.AddString("benchmark", "texture_decode_256x256");
+    results.AddNumber("warmup_iterations", parameters.num_warmup_iterations);
+    results.AddNumber("iterations", parameters.num_iterations);
+    results.AddObject("formats", formats);
+    results.AddBool("identical_output", all_identical);
+    return all_identical;
+}
+
+} // namespace Bench
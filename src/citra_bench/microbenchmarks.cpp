@@ -0,0 +1,38 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "citra_bench/microbenchmarks.h"
+
+namespace Bench {
+
+const std::vector<Microbenchmark>& GetMicrobenchmarks() {
+    static const std::vector<Microbenchmark> microbenchmarks = {
+        {"core-timing", "CoreTiming cancelling and rescheduling events with thousands pending",
+         RunCoreTimingBenchmark},
+        {"display-transfer",
+         "Software display transfer of a tiled RGBA8 top screen to linear RGB8",
+         RunDisplayTransferBenchmark},
+        {"dsp", "DSP HLE decoding and mixing with the scalar code against the SSE2 code",
+         RunDspBenchmark},
+        {"dyncom-block-cache",
+         "Dyncom block cache lookups against the std::unordered_map it replaced",
+         RunDynComBlockCacheBenchmark},
+        {"swrasterizer",
+         "Software rasterizer drawing blended triangles on one thread and on a thread pool",
+         RunSwRasterizerBenchmark},
+        {"texture-decode",
+         "Texture decoding of every format, texel by texel against a tile at a time",
+         RunTextureDecodeBenchmark},
+    };
+    return microbenchmarks;
+}
+
+const Microbenchmark* FindMicrobenchmark(const std::string& name) {
+    const auto& microbenchmarks = GetMicrobenchmarks();
+    const auto iter = std::find_if(microbenchmarks.begin(), microbenchmarks.end(),
+                                   [&](const Microbenchmark& bench) { return bench.name == name; });
+    return iter != microbenchmarks.end() ? &*iter : nullptr;
+}
+
+} // namespace Bench
@@ -0,0 +1,66 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "citra_bench/results.h"
+#include "common/common_types.h"
+
+namespace Bench {
+
+/// How often a microbenchmark runs the code it measures, from the --frames and --warmup options
+struct Parameters {
+    u64 num_iterations;
+    u64 num_warmup_iterations;
+};
+
+/**
+ * A benchmark of a single component, run without loading a title.
+ * The function adds its results to an object, and returns false if the benchmark failed, for
+ * example because an optimized path produced different output than the reference one.
+ */
+struct Microbenchmark {
+    const char* name;
+    const char* description;
+    bool (*run)(const Parameters& parameters, JsonObject& results);
+};
+
+/// Returns all microbenchmarks, in the order they are listed in the help text
+const std::vector<Microbenchmark>& GetMicrobenchmarks();
+
+/// Returns the microbenchmark with the given name, or nullptr if there is none
+const Microbenchmark* FindMicrobenchmark(const std::string& name);
+
+/// Runs function the number of warmup iterations, then times it for the number of measured
+/// iterations. Returns the sorted durations in seconds.
+template <typename Function>
+std::vector<double> MeasureTimes(const Parameters& parameters, Function&& function) {
+    for (u64 i = 0; i < parameters.num_warmup_iterations; ++i) {
+        function();
+    }
+
+    std::vector<double> times;
+    times.reserve(parameters.num_iterations);
+    for (u64 i = 0; i < parameters.num_iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double>(end - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times;
+}
+
+bool RunCoreTimingBenchmark(const Parameters& parameters, JsonObject& results);
+bool RunDisplayTransferBenchmark(const Parameters& parameters, JsonObject& results);
+bool RunDspBenchmark(const Parameters& parameters, JsonObject& results);
+bool RunDynComBlockCacheBenchmark(const Parameters& parameters, JsonObject& results);
+bool RunSwRasterizerBenchmark(const Parameters& parameters, JsonObject& results);
+bool RunTextureDecodeBenchmark(const Parameters& parameters, JsonObject& results);
+
+} // namespace Bench
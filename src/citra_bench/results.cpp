@@ -0,0 +1,99 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <numeric>
+#include "citra_bench/results.h"
+
+namespace Bench {
+
+std::string EscapeJson(const std::string& text) {
+    std::string escaped;
+    for (const char c : text) {
+        switch (c) {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                escaped += fmt::format("\\u{:04x}", static_cast<int>(c));
+            } else {
+                escaped += c;
+            }
+        }
+    }
+    return escaped;
+}
+
+double Mean(const std::vector<double>& values) {
+    return std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+}
+
+double Percentile(const std::vector<double>& sorted_values, double percentile) {
+    const size_t rank = static_cast<size_t>(percentile / 100.0 * sorted_values.size() + 0.5);
+    return sorted_values[std::clamp<size_t>(rank, 1, sorted_values.size()) - 1];
+}
+
+void JsonObject::AddString(const std::string& key, const std::string& value) {
+    AddField(key, fmt::format("\"{}\"", EscapeJson(value)));
+}
+
+void JsonObject::AddBool(const std::string& key, bool value) {
+    AddField(key, value ? "true" : "false");
+}
+
+void JsonObject::AddReal(const std::string& key, double value, int precision) {
+    AddField(key, fmt::format("{:.{}f}", value, precision));
+}
+
+void JsonObject::AddObject(const std::string& key, const JsonObject& object) {
+    Field field;
+    field.key = key;
+    field.fields = object.fields;
+    field.is_object = true;
+    fields.push_back(std::move(field));
+}
+
+void JsonObject::AddField(const std::string& key, std::string value) {
+    Field field;
+    field.key = key;
+    field.value = std::move(value);
+    fields.push_back(std::move(field));
+}
+
+std::string JsonObject::Format() const {
+    return FormatFields(fields, 0) + "\n";
+}
+
+std::string JsonObject::FormatFields(const std::vector<Field>& fields, unsigned indent) {
+    const std::string field_indent((indent + 1) * 2, ' ');
+    std::string out = "{\n";
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const Field& field = fields[i];
+        out += fmt::format("{}\"{}\": ", field_indent, EscapeJson(field.key));
+        out += field.is_object ? FormatFields(field.fields, indent + 1) : field.value;
+        out += i + 1 < fields.size() ? ",\n" : "\n";
+    }
+    out += std::string(indent * 2, ' ') + "}";
+    return out;
+}
+
+JsonObject SummarizeTimes(const std::vector<double>& sorted_times) {
+    JsonObject summary;
+    summary.AddReal("mean", Mean(sorted_times), 9);
+    summary.AddReal("min", sorted_times.front(), 9);
+    summary.AddReal("p50", Percentile(sorted_times, 50), 9);
+    summary.AddReal("p90", Percentile(sorted_times, 90), 9);
+    summary.AddReal("p99", Percentile(sorted_times, 99), 9);
+    summary.AddReal("max", sorted_times.back(), 9);
+    return summary;
+}
+
+} // namespace Bench
@@ -0,0 +1,57 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fmt/format.h>
+
+namespace Bench {
+
+/// Escapes a string for use inside of a JSON string literal
+std::string EscapeJson(const std::string& text);
+
+/// Arithmetic mean of values
+double Mean(const std::vector<double>& values);
+
+/// Nearest-rank percentile of sorted values
+double Percentile(const std::vector<double>& sorted_values, double percentile);
+
+/// Builds a JSON object, with one field per line
+class JsonObject {
+public:
+    void AddString(const std::string& key, const std::string& value);
+    void AddBool(const std::string& key, bool value);
+    void AddReal(const std::string& key, double value, int precision = 6);
+    void AddObject(const std::string& key, const JsonObject& object);
+
+    template <typename T>
+    void AddNumber(const std::string& key, T value) {
+        static_assert(std::is_integral<T>::value, "Use AddReal for floating point values");
+        AddField(key, fmt::format("{}", value));
+    }
+
+    /// Formats the object as a JSON document
+    std::string Format() const;
+
+private:
+    struct Field {
+        std::string key;
+        std::string value;         ///< Formatted value, unless the field is an object
+        std::vector<Field> fields; ///< Fields of the nested object
+        bool is_object = false;
+    };
+
+    void AddField(const std::string& key, std::string value);
+    static std::string FormatFields(const std::vector<Field>& fields, unsigned indent);
+
+    std::vector<Field> fields;
+};
+
+/// Summarizes sorted durations in seconds by their mean, minimum, percentiles and maximum
+JsonObject SummarizeTimes(const std::vector<double>& sorted_times);
+
+} // namespace Bench
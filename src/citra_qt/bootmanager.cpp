@@ -1,6 +1,8 @@
 #include <QApplication>
 #include <QHBoxLayout>
 #include <QKeyEvent>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
 #include <QScreen>
 #include <QWindow>
 #include "citra_qt/bootmanager.h"
@@ -123,6 +125,46 @@ void GRenderWindow::DoneCurrent() {
 
 void GRenderWindow::PollEvents() {}
 
+/**
+ * Context sharing objects with the render window's context. The surface has to be created on the
+ * GUI thread, while the context itself is created on first use so that it belongs to the thread
+ * it is made current on.
+ */
+class GGLSharedContext : public GraphicsContext {
+public:
+    explicit GGLSharedContext(QOpenGLContext* shared_context) : shared_context(shared_context) {
+        surface.setFormat(shared_context->format());
+        surface.create();
+    }
+
+    void MakeCurrent() override {
+        if (!context) {
+            context = std::make_unique<QOpenGLContext>();
+            context->setFormat(shared_context->format());
+            context->setShareContext(shared_context);
+            context->create();
+        }
+        context->makeCurrent(&surface);
+    }
+
+    void DoneCurrent() override {
+        context->doneCurrent();
+    }
+
+private:
+    QOpenGLContext* shared_context;
+    QOffscreenSurface surface;
+    std::unique_ptr<QOpenGLContext> context;
+};
+
+std::unique_ptr<GraphicsContext> GRenderWindow::CreateSharedContext() const {
+    // Offscreen surfaces can only be created on the GUI thread on some platforms
+    if (child == nullptr || QThread::currentThread() != thread()) {
+        return nullptr;
+    }
+    return std::make_unique<GGLSharedContext>(child->context()->contextHandle());
+}
+
 // On Qt 5.0+, this correctly gets the size of the framebuffer (pixels).
 //
 // Older versions get the window size (density independent pixels),
@@ -124,6 +124,22 @@ void Config::ReadValues() {
     Settings::values.shaders_accurate_mul =
         qt_config->value("shaders_accurate_mul", false).toBool();
     Settings::values.use_shader_jit = qt_config->value("use_shader_jit", true).toBool();
+    Settings::values.use_disk_shader_cache =
+        qt_config->value("use_disk_shader_cache", true).toBool();
+    Settings::values.use_asynchronous_shader_compilation =
+        qt_config->value("use_asynchronous_shader_compilation", false).toBool();
+    Settings::values.use_asynchronous_gpu_emulation =
+        qt_config->value("use_asynchronous_gpu_emulation", false).toBool();
+    Settings::values.use_texture_deduplication =
+        qt_config->value("use_texture_deduplication", false).toBool();
+    Settings::values.swrasterizer_num_threads =
+        static_cast<u16>(qt_config->value("swrasterizer_num_threads", 1).toInt());
+    Settings::values.vertex_shading_num_threads =
+        static_cast<u16>(qt_config->value("vertex_shading_num_threads", 1).toInt());
+    Settings::values.surface_tiling_num_threads =
+        static_cast<u16>(qt_config->value("surface_tiling_num_threads", 1).toInt());
+    Settings::values.display_transfer_num_threads =
+        static_cast<u16>(qt_config->value("display_transfer_num_threads", 1).toInt());
     Settings::values.resolution_factor =
         static_cast<u16>(qt_config->value("resolution_factor", 1).toInt());
     Settings::values.use_vsync = qt_config->value("use_vsync", false).toBool();
@@ -338,6 +354,17 @@ void Config::SaveValues() {
     qt_config->setValue("shaders_accurate_gs", Settings::values.shaders_accurate_gs);
     qt_config->setValue("shaders_accurate_mul", Settings::values.shaders_accurate_mul);
     qt_config->setValue("use_shader_jit", Settings::values.use_shader_jit);
+    qt_config->setValue("use_disk_shader_cache", Settings::values.use_disk_shader_cache);
+    qt_config->setValue("use_asynchronous_shader_compilation",
+                        Settings::values.use_asynchronous_shader_compilation);
+    qt_config->setValue("use_asynchronous_gpu_emulation",
+                        Settings::values.use_asynchronous_gpu_emulation);
+    qt_config->setValue("use_texture_deduplication", Settings::values.use_texture_deduplication);
+    qt_config->setValue("swrasterizer_num_threads", Settings::values.swrasterizer_num_threads);
+    qt_config->setValue("vertex_shading_num_threads", Settings::values.vertex_shading_num_threads);
+    qt_config->setValue("surface_tiling_num_threads", Settings::values.surface_tiling_num_threads);
+    qt_config->setValue("display_transfer_num_threads",
+                        Settings::values.display_transfer_num_threads);
     qt_config->setValue("resolution_factor", Settings::values.resolution_factor);
     qt_config->setValue("use_vsync", Settings::values.use_vsync);
     qt_config->setValue("use_frame_limit", Settings::values.use_frame_limit);
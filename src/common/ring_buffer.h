@@ -0,0 +1,97 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace Common {
+
+/**
+ * Lock-free ring buffer of fixed capacity for a single producer and a single consumer thread.
+ * Elements are pushed and popped in slots of `granularity` elements each, e.g. 2 for interleaved
+ * stereo samples, so that a slot is never split.
+ * @tparam T Element type
+ * @tparam capacity Number of slots, must be a power of two
+ * @tparam granularity Number of elements per slot
+ */
+template <typename T, std::size_t capacity, std::size_t granularity = 1>
+class RingBuffer {
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0,
+                  "capacity must be a power of two");
+    static_assert(granularity > 0, "granularity must be at least 1");
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+public:
+    /**
+     * Pushes slots into the ring buffer. Only call this from the producer thread.
+     * @param new_slots Pointer to slot_count * granularity elements
+     * @param slot_count Number of slots to push
+     * @returns The number of slots actually pushed, less than slot_count if the buffer is full
+     */
+    std::size_t Push(const T* new_slots, std::size_t slot_count) {
+        const std::size_t write = write_index.load(std::memory_order_relaxed);
+        const std::size_t read = read_index.load(std::memory_order_acquire);
+        const std::size_t free_slots = capacity - (write - read);
+        const std::size_t push_count = std::min(slot_count, free_slots);
+
+        const std::size_t position = write % capacity;
+        const std::size_t first_copy = std::min(capacity - position, push_count);
+        std::memcpy(&data[position * granularity], new_slots, first_copy * slot_size);
+        std::memcpy(&data[0], new_slots + first_copy * granularity,
+                    (push_count - first_copy) * slot_size);
+
+        write_index.store(write + push_count, std::memory_order_release);
+        return push_count;
+    }
+
+    /**
+     * Pops slots from the ring buffer. Only call this from the consumer thread.
+     * @param output Pointer receiving up to max_slots * granularity elements
+     * @param max_slots Maximum number of slots to pop
+     * @returns The number of slots actually popped
+     */
+    std::size_t Pop(T* output, std::size_t max_slots = std::numeric_limits<std::size_t>::max()) {
+        const std::size_t read = read_index.load(std::memory_order_relaxed);
+        const std::size_t available = write_index.load(std::memory_order_acquire) - read;
+        const std::size_t pop_count = std::min(max_slots, available);
+
+        const std::size_t position = read % capacity;
+        const std::size_t first_copy = std::min(capacity - position, pop_count);
+        std::memcpy(output, &data[position * granularity], first_copy * slot_size);
+        std::memcpy(output + first_copy * granularity, &data[0],
+                    (pop_count - first_copy) * slot_size);
+
+        read_index.store(read + pop_count, std::memory_order_release);
+        return pop_count;
+    }
+
+    /// Returns the number of slots currently in the buffer. Safe to call from either thread.
+    std::size_t Size() const {
+        return write_index.load(std::memory_order_acquire) -
+               read_index.load(std::memory_order_acquire);
+    }
+
+    /// Returns the maximum number of slots the buffer can hold
+    static constexpr std::size_t Capacity() {
+        return capacity;
+    }
+
+private:
+    static constexpr std::size_t slot_size = granularity * sizeof(T);
+
+    // The indices only ever increase and are wrapped on access. They are kept on separate cache
+    // lines so that the producer and the consumer don't keep stealing each other's line.
+    alignas(64) std::atomic<std::size_t> read_index{0};
+    alignas(64) std::atomic<std::size_t> write_index{0};
+    alignas(64) std::array<T, granularity * capacity> data;
+};
+
+} // namespace Common
@@ -0,0 +1,96 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(size_t num_threads, const std::string& name) : name(name) {
+    if (num_threads == 0) {
+        num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    workers.reserve(num_threads - 1);
+    for (size_t i = 0; i < num_threads - 1; ++i) {
+        workers.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        stop_requested = true;
+    }
+    job_available.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& func) {
+    if (count == 0) {
+        return;
+    }
+
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit_lock(submit_mutex);
+
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        job_func = &func;
+        job_count = count;
+        job_next_index = 0;
+        workers_busy = workers.size();
+        ++job_generation;
+    }
+    job_available.notify_all();
+
+    RunJob();
+
+    std::unique_lock<std::mutex> lock(job_mutex);
+    job_finished.wait(lock, [this] { return workers_busy == 0; });
+    job_func = nullptr;
+}
+
+void ThreadPool::RunJob() {
+    for (size_t i = job_next_index++; i < job_count; i = job_next_index++) {
+        (*job_func)(i);
+    }
+}
+
+void ThreadPool::WorkerLoop(size_t worker_index) {
+    SetCurrentThreadName((name + " " + std::to_string(worker_index)).c_str());
+
+    u64 last_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(job_mutex);
+            job_available.wait(lock, [&] {
+                return stop_requested || job_generation != last_generation;
+            });
+            if (stop_requested) {
+                return;
+            }
+            last_generation = job_generation;
+        }
+
+        RunJob();
+
+        std::lock_guard<std::mutex> lock(job_mutex);
+        if (--workers_busy == 0) {
+            job_finished.notify_one();
+        }
+    }
+}
+
+} // namespace Common
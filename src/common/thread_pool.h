@@ -0,0 +1,67 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * A fixed-size pool of worker threads used to split data-parallel work (e.g. tiles, rows or
+ * vertex batches) across host cores. The calling thread participates in the work, so a pool
+ * created with one thread runs everything inline without any synchronization overhead.
+ */
+class ThreadPool : NonCopyable {
+public:
+    /**
+     * @param num_threads Total number of threads working on a job, including the caller. Zero
+     *                    selects the number of host hardware threads.
+     * @param name Name given to the worker threads
+     */
+    ThreadPool(size_t num_threads, const std::string& name);
+    ~ThreadPool();
+
+    /// Returns the number of threads working on a job, including the caller
+    size_t NumThreads() const {
+        return workers.size() + 1;
+    }
+
+    /**
+     * Invokes func(i) for every i in [0, count) and blocks until all invocations have returned.
+     * Invocations may run in any order and concurrently with each other. Jobs submitted from
+     * several threads at once are serialized.
+     */
+    void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+private:
+    void WorkerLoop(size_t worker_index);
+    void RunJob();
+
+    std::vector<std::thread> workers;
+    std::string name;
+
+    std::mutex submit_mutex;
+
+    std::mutex job_mutex;
+    std::condition_variable job_available;
+    std::condition_variable job_finished;
+    u64 job_generation = 0;
+    size_t workers_busy = 0;
+    bool stop_requested = false;
+
+    const std::function<void(size_t)>* job_func = nullptr;
+    size_t job_count = 0;
+    std::atomic<size_t> job_next_index{0};
+};
+
+} // namespace Common
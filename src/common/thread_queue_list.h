@@ -5,157 +5,172 @@
 #pragma once
 
 #include <array>
-#include <deque>
-#include <boost/range/algorithm_ext/erase.hpp>
+#include <type_traits>
+#include "common/bit_set.h"
+#include "common/common_types.h"
 
 namespace Common {
 
-template <class T, unsigned int N>
-struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
+/// Links embedded in every element that can be put in a ThreadQueueList
+template <class T>
+struct ThreadQueueListNode {
+    T prev{};
+    T next{};
+};
 
+/**
+ * Queue of ready threads with one FIFO per priority level, where lower levels are picked first.
+ * The FIFOs are intrusive lists linked through a ThreadQueueListNode in each element, and a bitmap
+ * records which levels are non-empty, so that all operations but contains() take constant time.
+ * An element can only be in one ThreadQueueList at a time.
+ * @tparam T Pointer to the element type
+ * @tparam N Number of priority levels, at most 64
+ * @tparam node Member of the element type that holds its links
+ */
+template <class T, unsigned int N, ThreadQueueListNode<T> std::remove_pointer_t<T>::*node>
+struct ThreadQueueList {
     typedef unsigned int Priority;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static const Priority NUM_QUEUES = N;
-
-    ThreadQueueList() {
-        first = nullptr;
-    }
+    static_assert(N <= 64, "The occupancy bitmap only has room for 64 priority levels");
 
     // Only for debugging, returns priority level.
-    Priority contains(const T& uid) {
+    Priority contains(const T& uid) const {
         for (Priority i = 0; i < NUM_QUEUES; ++i) {
-            Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
-                return i;
+            for (T cur = queues[i].front; cur != T(); cur = (cur->*node).next) {
+                if (cur == uid) {
+                    return i;
+                }
             }
         }
 
         return -1;
     }
 
-    T get_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
+    T get_first() const {
+        if (occupied == 0) {
+            return T();
         }
-
-        return T();
+        return queues[first_occupied()].front;
     }
 
     T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        if (occupied == 0) {
+            return T();
         }
-
-        return T();
+        const Priority priority = first_occupied();
+        T first = queues[priority].front;
+        unlink(priority, first);
+        return first;
     }
 
     T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        if (occupied == 0 || first_occupied() >= priority) {
+            return T();
         }
-
-        return T();
+        return pop_first();
     }
 
     void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+        Queue& cur = queues[priority];
+        (thread_id->*node).prev = T();
+        (thread_id->*node).next = cur.front;
+        if (cur.front != T()) {
+            (cur.front->*node).prev = thread_id;
+        } else {
+            cur.back = thread_id;
+        }
+        cur.front = thread_id;
+        occupied |= u64(1) << priority;
     }
 
     void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+        Queue& cur = queues[priority];
+        (thread_id->*node).prev = cur.back;
+        (thread_id->*node).next = T();
+        if (cur.back != T()) {
+            (cur.back->*node).next = thread_id;
+        } else {
+            cur.front = thread_id;
+        }
+        cur.back = thread_id;
+        occupied |= u64(1) << priority;
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
         remove(old_priority, thread_id);
-        prepare(new_priority);
         push_back(new_priority, thread_id);
     }
 
+    /// Removes an element from the given level. Does nothing if it isn't queued there.
     void remove(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        boost::remove_erase(cur->data, thread_id);
+        if ((thread_id->*node).prev == T() && queues[priority].front != thread_id) {
+            return;
+        }
+        unlink(priority, thread_id);
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
+        Queue& cur = queues[priority];
 
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        if (cur.front != cur.back) {
+            T first = cur.front;
+            unlink(priority, first);
+            push_back(priority, first);
         }
     }
 
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        for (Queue& cur : queues) {
+            while (cur.front != T()) {
+                T first = cur.front;
+                cur.front = (first->*node).next;
+                (first->*node) = {};
+            }
+            cur.back = T();
+        }
+        occupied = 0;
     }
 
     bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
-    }
-
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        return (occupied & (u64(1) << priority)) == 0;
     }
 
 private:
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        T front{};
+        T back{};
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
+    Priority first_occupied() const {
+        return static_cast<Priority>(LeastSignificantSetBit(occupied));
     }
 
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
+    void unlink(Priority priority, const T& thread_id) {
+        Queue& cur = queues[priority];
+        ThreadQueueListNode<T>& links = thread_id->*node;
+        if (links.prev != T()) {
+            (links.prev->*node).next = links.next;
+        } else {
+            cur.front = links.next;
         }
+        if (links.next != T()) {
+            (links.next->*node).prev = links.prev;
+        } else {
+            cur.back = links.prev;
+        }
+        links = {};
 
-        cur->next_nonempty = first;
-        first = cur;
+        if (cur.front == T()) {
+            occupied &= ~(u64(1) << priority);
+        }
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
+    // Bit i is set when level i has queued elements
+    u64 occupied = 0;
     // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
+    std::array<Queue, NUM_QUEUES> queues{};
 };
 
 } // namespace Common
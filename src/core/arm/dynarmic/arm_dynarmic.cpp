@@ -333,6 +333,9 @@ void ARM_Dynarmic::SyncSettings() {
 std::unique_ptr<Dynarmic::A32::Jit> ARM_Dynarmic::MakeJit() {
     Dynarmic::A32::UserConfig config;
     config.callbacks = cb.get();
+    // The JIT inlines loads and stores through the page table, so the memory callbacks are only
+    // reached for pages without a host pointer (MMIO and rasterizer cached memory), which need to
+    // be trapped anyway.
     config.page_table = &current_page_table->pointers;
     config.coprocessors[15] = std::make_shared<DynarmicCP15>(interpreter_state);
     return std::make_unique<Dynarmic::A32::Jit>(config);
@@ -79,12 +79,12 @@ void ARM_DynCom::Run() {
 }
 
 void ARM_DynCom::ClearInstructionCache() {
-    state->instruction_cache.clear();
-    trans_cache_buf_top = 0;
+    state->instruction_cache.Clear();
+    ResetTranslationBuffer();
 }
 
-void ARM_DynCom::InvalidateCacheRange(u32, size_t) {
-    ClearInstructionCache();
+void ARM_DynCom::InvalidateCacheRange(u32 start_address, size_t length) {
+    state->instruction_cache.InvalidateRange(start_address, length);
 }
 
 void ARM_DynCom::PageTableChanged() {
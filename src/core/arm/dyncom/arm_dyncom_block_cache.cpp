@@ -0,0 +1,46 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
+
+DynComBlockCache::DynComBlockCache() = default;
+DynComBlockCache::~DynComBlockCache() = default;
+
+void DynComBlockCache::Insert(u32 address, std::size_t offset) {
+    std::unique_ptr<PageTable>& table = directory[address >> DIRECTORY_SHIFT];
+    if (!table) {
+        table = std::make_unique<PageTable>();
+    }
+    std::unique_ptr<Page>& page = table->pages[(address >> PAGE_BITS) & TABLE_MASK];
+    if (!page) {
+        page = std::make_unique<Page>();
+    }
+    page->entries[(address & PAGE_MASK) >> 1] = {static_cast<u32>(offset),
+                                                  GetTransCacheGeneration(offset)};
+}
+
+void DynComBlockCache::InvalidateRange(u32 start_address, std::size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    // Blocks end at a page boundary, except when a Thumb instruction straddles it, in which case
+    // the block runs on to the end of the next page. So the page before the range has to go too.
+    const u64 first_page = std::max<u64>(start_address >> PAGE_BITS, 1) - 1;
+    const u64 last_page = std::min<u64>((start_address + static_cast<u64>(length) - 1) >> PAGE_BITS,
+                                        (1ULL << (32 - PAGE_BITS)) - 1);
+    for (u64 page_index = first_page; page_index <= last_page; ++page_index) {
+        const std::unique_ptr<PageTable>& table = directory[page_index >> TABLE_BITS];
+        if (table) {
+            table->pages[page_index & TABLE_MASK].reset();
+        }
+    }
+}
+
+void DynComBlockCache::Clear() {
+    for (std::unique_ptr<PageTable>& table : directory) {
+        table.reset();
+    }
+}
@@ -0,0 +1,71 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include "common/common_types.h"
+#include "core/arm/dyncom/arm_dyncom_trans.h"
+
+/**
+ * Maps guest addresses to the blocks translated for them in trans_cache_buf. Lookups go through a
+ * two-level page table, a directory of page tables indexed by the upper address bits, down to an
+ * array of entries for every halfword of a page. Entries remember the generation of the buffer
+ * segment they point into, so blocks in a recycled segment are simply not found anymore.
+ */
+class DynComBlockCache {
+public:
+    static constexpr std::size_t NOT_FOUND = ~std::size_t(0);
+
+    DynComBlockCache();
+    ~DynComBlockCache();
+
+    /// Returns the offset of the block translated for the address, or NOT_FOUND
+    std::size_t Find(u32 address) const {
+        const std::unique_ptr<PageTable>& table = directory[address >> DIRECTORY_SHIFT];
+        if (!table) {
+            return NOT_FOUND;
+        }
+        const std::unique_ptr<Page>& page = table->pages[(address >> PAGE_BITS) & TABLE_MASK];
+        if (!page) {
+            return NOT_FOUND;
+        }
+        const Entry& entry = page->entries[(address & PAGE_MASK) >> 1];
+        if (entry.generation != GetTransCacheGeneration(entry.offset)) {
+            return NOT_FOUND;
+        }
+        return entry.offset;
+    }
+
+    /// Records the block translated for the address at the given offset of trans_cache_buf
+    void Insert(u32 address, std::size_t offset);
+
+    /// Forgets the blocks of all pages overlapping the range
+    void InvalidateRange(u32 start_address, std::size_t length);
+
+    /// Forgets all blocks
+    void Clear();
+
+private:
+    static constexpr u32 PAGE_BITS = 12;
+    static constexpr u32 PAGE_MASK = (1 << PAGE_BITS) - 1;
+    static constexpr u32 TABLE_BITS = 10;
+    static constexpr u32 TABLE_MASK = (1 << TABLE_BITS) - 1;
+    static constexpr u32 DIRECTORY_SHIFT = PAGE_BITS + TABLE_BITS;
+
+    struct Entry {
+        u32 offset;
+        u32 generation; ///< Zero, which is never a valid generation, for unused entries
+    };
+    struct Page {
+        std::array<Entry, (1 << PAGE_BITS) / 2> entries{};
+    };
+    struct PageTable {
+        std::array<std::unique_ptr<Page>, 1 << TABLE_BITS> pages;
+    };
+
+    std::array<std::unique_ptr<PageTable>, 1 << (32 - DIRECTORY_SHIFT)> directory;
+};
@@ -8,6 +8,35 @@
 
 char trans_cache_buf[TRANS_CACHE_SIZE];
 size_t trans_cache_buf_top = 0;
+// Generations start at 1 so that zero-initialized block cache entries are never valid
+u32 trans_cache_generations[TRANS_CACHE_NUM_SEGMENTS] = {1, 1, 1, 1, 1, 1, 1, 1};
+
+// Upper bound of the translated size of a block. A block ends as soon as it leaves its first page
+// (see IsEndOfTranslationBlock), so it covers at most two pages of 16-bit instructions.
+static constexpr size_t MAX_TRANSLATED_BLOCK_SIZE = 1024 * 1024;
+static_assert(TRANS_CACHE_SIZE % TRANS_CACHE_NUM_SEGMENTS == 0);
+static_assert(TRANS_CACHE_SEGMENT_SIZE > MAX_TRANSLATED_BLOCK_SIZE);
+
+size_t BeginTranslationBlock() {
+    const size_t segment_end =
+        (trans_cache_buf_top / TRANS_CACHE_SEGMENT_SIZE + 1) * TRANS_CACHE_SEGMENT_SIZE;
+    if (segment_end - trans_cache_buf_top < MAX_TRANSLATED_BLOCK_SIZE) {
+        trans_cache_buf_top = segment_end % TRANS_CACHE_SIZE;
+        ++trans_cache_generations[trans_cache_buf_top / TRANS_CACHE_SEGMENT_SIZE];
+    }
+    return trans_cache_buf_top;
+}
+
+bool IsEndOfTranslationBlock(u32 block_start, u32 next_address) {
+    return (next_address >> 12) != (block_start >> 12);
+}
+
+void ResetTranslationBuffer() {
+    trans_cache_buf_top = 0;
+    for (u32& generation : trans_cache_generations) {
+        ++generation;
+    }
+}
 
 static void* AllocBuffer(size_t size) {
     size_t start = trans_cache_buf_top;
@@ -496,3 +496,29 @@ extern const size_t arm_instruction_trans_len;
 #define TRANS_CACHE_SIZE (64 * 1024 * 2000)
 extern char trans_cache_buf[TRANS_CACHE_SIZE];
 extern size_t trans_cache_buf_top;
+
+// The translation buffer is split into segments that are filled in turn. Once the last one is
+// full, the oldest segment is recycled and the blocks translated into it are dropped, by bumping
+// the segment's generation that cached blocks are checked against.
+#define TRANS_CACHE_NUM_SEGMENTS 8
+#define TRANS_CACHE_SEGMENT_SIZE (TRANS_CACHE_SIZE / TRANS_CACHE_NUM_SEGMENTS)
+extern u32 trans_cache_generations[TRANS_CACHE_NUM_SEGMENTS];
+
+/// Returns the current generation of the segment containing the given translation buffer offset
+inline u32 GetTransCacheGeneration(size_t offset) {
+    return trans_cache_generations[offset / TRANS_CACHE_SEGMENT_SIZE];
+}
+
+/// Makes room for translating a block without it crossing into the next segment, and returns the
+/// offset the block will start at
+size_t BeginTranslationBlock();
+
+/**
+ * Returns whether the block starting at block_start has to end before the instruction at
+ * next_address. Blocks end once they leave their first page, so that one covers at most two pages
+ * even when a Thumb instruction straddles the page boundary.
+ */
+bool IsEndOfTranslationBlock(u32 block_start, u32 next_address);
+
+/// Drops all translated blocks and starts filling the translation buffer from the beginning
+void ResetTranslationBuffer();
@@ -22,6 +22,7 @@
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/service.h"
 #include "core/hle/service/sm/sm.h"
+#include "core/hw/gpu_thread.h"
 #include "core/hw/hw.h"
 #include "core/loader/loader.h"
 #include "core/memory_setup.h"
@@ -29,6 +30,7 @@
 #include "core/rpc/rpc_server.h"
 #include "core/settings.h"
 #include "network/network.h"
+#include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
 namespace Core {
@@ -111,6 +113,16 @@ System::ResultStatus System::Load(EmuWindow& emu_window, const std::string& file
         }
     }
     Memory::SetCurrentPageTable(&Kernel::g_current_process->vm_manager.page_table);
+
+    u64 title_id{0};
+    if (app_loader->ReadProgramId(title_id) != Loader::ResultStatus::Success) {
+        LOG_WARNING(Core, "Failed to read title ID, disk resources will not be loaded");
+    }
+    VideoCore::g_renderer->Rasterizer()->LoadDiskResources(
+        title_id, [](std::size_t current, std::size_t total) {
+            LOG_DEBUG(Core, "Loaded disk resource {} of {}", current, total);
+        });
+
     status = ResultStatus::Success;
     m_emu_window = &emu_window;
     m_filepath = filepath;
@@ -170,6 +182,7 @@ System::ResultStatus System::Init(EmuWindow& emu_window, u32 system_mode) {
     if (result != ResultStatus::Success) {
         return result;
     }
+    GPUThread::Init();
 
     LOG_DEBUG(Core, "Initialized OK");
 
@@ -191,6 +204,7 @@ const Service::SM::ServiceManager& System::ServiceManager() const {
 void System::Shutdown() {
     // Shutdown emulation session
     CheatCore::Shutdown();
+    GPUThread::Shutdown();
     VideoCore::Shutdown();
     Service::Shutdown();
     Kernel::Shutdown();
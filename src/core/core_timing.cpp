@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <limits>
 #include <mutex>
 #include <string>
 #include <tuple>
@@ -22,9 +23,15 @@ static s64 global_timer;
 static s64 slice_length;
 static s64 downcount;
 
+/// Marks the end of a list of event slots
+static constexpr u32 INVALID_SLOT{std::numeric_limits<u32>::max()};
+
 struct EventType {
     TimedCallback callback;
     const std::string* name;
+    /// First pending event of this type, heading a list linked through EventSlot. This is
+    /// bookkeeping of the queue rather than part of the type, hence mutable.
+    mutable u32 first_pending = INVALID_SLOT;
 };
 
 struct Event {
@@ -34,12 +41,30 @@ struct Event {
     const EventType* type;
 };
 
-// Sort by time, unless the times are the same, in which case sort by the order added to the queue
-static bool operator>(const Event& left, const Event& right) {
-    return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
-}
+/**
+ * A queued event. Slots stay in place while their event is pending, so that the event can be
+ * reached from its type to be unscheduled, and from the heap to be dispatched.
+ */
+struct EventSlot {
+    u64 userdata;
+    const EventType* type;
+    /// Position of the event in event_heap
+    size_t heap_index;
+    /// Neighbours in the list of pending events of the same type. Free slots are chained through
+    /// next_of_type instead.
+    u32 prev_of_type;
+    u32 next_of_type;
+};
+
+/// The ordering keys of an event, kept in the heap itself so that sifting stays cache friendly
+struct HeapEntry {
+    s64 time;
+    u64 fifo_order;
+    u32 slot;
+};
 
-static bool operator<(const Event& left, const Event& right) {
+// Sort by time, unless the times are the same, in which case sort by the order added to the queue
+static bool operator<(const HeapEntry& left, const HeapEntry& right) {
     return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
 }
 
@@ -47,14 +72,17 @@ static bool operator<(const Event& left, const Event& right) {
 // remain stable regardless of rehashes/resizing.
 static std::unordered_map<std::string, EventType> event_types;
 
-// The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-// We don't use std::priority_queue because we need to be able to serialize, unserialize and
-// erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
-// by the standard adaptor class.
-static std::vector<Event> event_queue;
+// The queue is an indexed 4-ary min-heap. Each entry refers to the slot holding the rest of the
+// event, and each slot knows where its entry is in the heap, so that any event can be removed in
+// O(log n) once found. Events are found through the per-type lists, so unscheduling only looks
+// at the pending events of the given type instead of the whole queue.
+static constexpr size_t HEAP_ARITY{4};
+static std::vector<HeapEntry> event_heap;
+static std::vector<EventSlot> event_slots;
+static u32 first_free_slot{INVALID_SLOT};
 static u64 event_fifo_id;
 // the queue for storing the events from other threads threadsafe until they will be added
-// to the event_queue by the emu thread
+// to the event heap by the emu thread
 static Common::MPSCQueue<Event, false> ts_queue;
 
 static constexpr int MAX_SLICE_LENGTH{20000};
@@ -70,6 +98,112 @@ static EventType* ev_lost{nullptr};
 
 static void EmptyTimedCallback(u64 userdata, s64 cyclesLate) {}
 
+static void PlaceHeapEntry(size_t index, const HeapEntry& entry) {
+    event_heap[index] = entry;
+    event_slots[entry.slot].heap_index = index;
+}
+
+static void SiftUp(size_t index) {
+    const HeapEntry entry{event_heap[index]};
+    while (index > 0) {
+        const size_t parent{(index - 1) / HEAP_ARITY};
+        if (!(entry < event_heap[parent])) {
+            break;
+        }
+        PlaceHeapEntry(index, event_heap[parent]);
+        index = parent;
+    }
+    PlaceHeapEntry(index, entry);
+}
+
+static void SiftDown(size_t index) {
+    const HeapEntry entry{event_heap[index]};
+    while (true) {
+        const size_t first_child{index * HEAP_ARITY + 1};
+        if (first_child >= event_heap.size()) {
+            break;
+        }
+        const size_t last_child{std::min(first_child + HEAP_ARITY, event_heap.size())};
+        size_t smallest{first_child};
+        for (size_t child = first_child + 1; child < last_child; ++child) {
+            if (event_heap[child] < event_heap[smallest]) {
+                smallest = child;
+            }
+        }
+        if (!(event_heap[smallest] < entry)) {
+            break;
+        }
+        PlaceHeapEntry(index, event_heap[smallest]);
+        index = smallest;
+    }
+    PlaceHeapEntry(index, entry);
+}
+
+static void PushEvent(const Event& event) {
+    u32 slot{first_free_slot};
+    if (slot != INVALID_SLOT) {
+        first_free_slot = event_slots[slot].next_of_type;
+    } else {
+        slot = static_cast<u32>(event_slots.size());
+        event_slots.emplace_back();
+    }
+
+    const u32 next{event.type->first_pending};
+    event_slots[slot] = {event.userdata, event.type, event_heap.size(), INVALID_SLOT, next};
+    if (next != INVALID_SLOT) {
+        event_slots[next].prev_of_type = slot;
+    }
+    event.type->first_pending = slot;
+
+    event_heap.push_back({event.time, event.fifo_order, slot});
+    SiftUp(event_heap.size() - 1);
+}
+
+/// Removes the event in the given slot from the queue and returns it
+static Event RemoveEventInSlot(u32 slot) {
+    EventSlot& removed{event_slots[slot]};
+    const size_t index{removed.heap_index};
+    const Event event{event_heap[index].time, event_heap[index].fifo_order, removed.userdata,
+                      removed.type};
+
+    // Fill the hole with the last entry, which may need to move either way from there
+    const HeapEntry last{event_heap.back()};
+    event_heap.pop_back();
+    if (index < event_heap.size()) {
+        PlaceHeapEntry(index, last);
+        if (index > 0 && last < event_heap[(index - 1) / HEAP_ARITY]) {
+            SiftUp(index);
+        } else {
+            SiftDown(index);
+        }
+    }
+
+    if (removed.prev_of_type != INVALID_SLOT) {
+        event_slots[removed.prev_of_type].next_of_type = removed.next_of_type;
+    } else {
+        removed.type->first_pending = removed.next_of_type;
+    }
+    if (removed.next_of_type != INVALID_SLOT) {
+        event_slots[removed.next_of_type].prev_of_type = removed.prev_of_type;
+    }
+
+    removed.next_of_type = first_free_slot;
+    first_free_slot = slot;
+    return event;
+}
+
+/// Removes all pending events of the given type for which pred(userdata) holds
+template <typename Predicate>
+static void RemoveEventsOfType(const EventType* event_type, Predicate pred) {
+    for (u32 slot = event_type->first_pending; slot != INVALID_SLOT;) {
+        const u32 next{event_slots[slot].next_of_type};
+        if (pred(event_slots[slot].userdata)) {
+            RemoveEventInSlot(slot);
+        }
+        slot = next;
+    }
+}
+
 EventType* RegisterEvent(const std::string& name, TimedCallback callback) {
     // check for existing type with same name.
     // we want event type names to remain unique so that we can use them for serialization.
@@ -85,7 +219,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback) {
 }
 
 void UnregisterAllEvents() {
-    ASSERT_MSG(event_queue.empty(), "Cannot unregister events with events pending");
+    ASSERT_MSG(event_heap.empty(), "Cannot unregister events with events pending");
     event_types.clear();
 }
 
@@ -130,7 +264,12 @@ u64 GetIdleTicks() {
 }
 
 void ClearPendingEvents() {
-    event_queue.clear();
+    event_heap.clear();
+    event_slots.clear();
+    first_free_slot = INVALID_SLOT;
+    for (auto& [name, event_type] : event_types) {
+        event_type.first_pending = INVALID_SLOT;
+    }
 }
 
 void ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 userdata) {
@@ -141,8 +280,7 @@ void ScheduleEvent(s64 cycles_into_future, const EventType* event_type, u64 user
     if (!is_global_timer_sane)
         ForceExceptionCheck(cycles_into_future);
 
-    event_queue.emplace_back(Event{timeout, event_fifo_id++, userdata, event_type});
-    std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    PushEvent(Event{timeout, event_fifo_id++, userdata, event_type});
 }
 
 void ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type, u64 userdata) {
@@ -150,26 +288,11 @@ void ScheduleEventThreadsafe(s64 cycles_into_future, const EventType* event_type
 }
 
 void UnscheduleEvent(const EventType* event_type, u64 userdata) {
-    auto itr{std::remove_if(event_queue.begin(), event_queue.end(), [&](const Event& e) {
-        return e.type == event_type && e.userdata == userdata;
-    })};
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-    }
+    RemoveEventsOfType(event_type, [userdata](u64 pending) { return pending == userdata; });
 }
 
 void RemoveEvent(const EventType* event_type) {
-    auto itr{std::remove_if(event_queue.begin(), event_queue.end(),
-                            [&](const Event& e) { return e.type == event_type; })};
-
-    // Removing random items breaks the invariant so we have to re-establish it.
-    if (itr != event_queue.end()) {
-        event_queue.erase(itr, event_queue.end());
-        std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-    }
+    RemoveEventsOfType(event_type, [](u64) { return true; });
 }
 
 void RemoveNormalAndThreadsafeEvent(const EventType* event_type) {
@@ -188,8 +311,7 @@ void ForceExceptionCheck(s64 cycles) {
 void MoveEvents() {
     for (Event ev; ts_queue.Pop(ev);) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        PushEvent(ev);
     }
 }
 
@@ -202,19 +324,17 @@ void Advance() {
 
     is_global_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= global_timer) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    while (!event_heap.empty() && event_heap.front().time <= global_timer) {
+        const Event evt{RemoveEventInSlot(event_heap.front().slot)};
         evt.type->callback(evt.userdata, global_timer - evt.time);
     }
 
     is_global_timer_sane = false;
 
     // Still events left (scheduled in the future)
-    if (!event_queue.empty()) {
+    if (!event_heap.empty()) {
         slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - global_timer, MAX_SLICE_LENGTH));
+            std::min<s64>(event_heap.front().time - global_timer, MAX_SLICE_LENGTH));
     }
 
     downcount = slice_length;
@@ -1,22 +1,188 @@
 #include <algorithm>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/file_sys/romfs_reader.h"
 
 namespace FileSys {
 
+/// The decryptor is kept around and repositioned for each read, as setting up the key schedule is
+/// far more expensive than seeking.
+struct RomFSReader::Cipher {
+    Cipher(const std::array<u8, 16>& key, const std::array<u8, 16>& ctr)
+        : decryption(key.data(), key.size(), ctr.data()) {}
+
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption decryption;
+};
+
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
+    : is_encrypted(false), file(std::move(file)), file_offset(file_offset), data_size(data_size) {}
+
+RomFSReader::RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
+                         const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
+                         std::size_t crypto_offset)
+    : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
+      crypto_offset(crypto_offset), data_size(data_size),
+      cipher(std::make_unique<Cipher>(key, ctr)) {}
+
+RomFSReader::~RomFSReader() {
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        stop_readahead = true;
+    }
+    readahead_requested.notify_one();
+    if (readahead_thread.joinable()) {
+        readahead_thread.join();
+    }
+
+    const CacheStatistics stats = GetCacheStatistics();
+    LOG_DEBUG(Service_FS, "Block cache: {} hits, {} misses, {} read ahead, {} bytes decrypted",
+              stats.block_hits, stats.block_misses, stats.readahead_blocks, stats.bytes_decrypted);
+}
+
 std::size_t RomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
-    if (length == 0)
-        return 0; // Crypto++ does not like zero size buffer
+    if (length == 0 || offset >= data_size)
+        return 0;
+    const std::size_t read_length = std::min(length, data_size - offset);
+
+    // Reads this large would only flush the whole cache, so they go straight to the file
+    if (read_length >= CACHE_CAPACITY * BLOCK_SIZE / 2) {
+        std::lock_guard<std::mutex> lock(file_mutex);
+        return ReadUncached(offset, read_length, buffer);
+    }
+
+    std::size_t total_read = 0;
+    while (total_read < read_length) {
+        const std::size_t position = offset + total_read;
+        const std::size_t block_index = position / BLOCK_SIZE;
+        const std::size_t block_offset = position % BLOCK_SIZE;
+
+        Block block;
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            block = FindCachedBlock(block_index);
+        }
+        if (block) {
+            ++block_hits;
+        } else {
+            ++block_misses;
+            block = LoadBlock(block_index, false);
+        }
+
+        // The block is shorter than expected if the file is truncated
+        if (block_offset >= block->size())
+            break;
+        const std::size_t wanted = std::min(BLOCK_SIZE - block_offset, read_length - total_read);
+        const std::size_t copy_length = std::min(wanted, block->size() - block_offset);
+        std::memcpy(buffer + total_read, block->data() + block_offset, copy_length);
+        total_read += copy_length;
+        if (copy_length < wanted)
+            break;
+    }
+
+    if (total_read > 0) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        const bool sequential = offset == next_sequential_offset;
+        next_sequential_offset = offset + total_read;
+        if (sequential) {
+            RequestReadahead((next_sequential_offset - 1) / BLOCK_SIZE);
+        }
+    }
+
+    return total_read;
+}
+
+RomFSReader::CacheStatistics RomFSReader::GetCacheStatistics() const {
+    return {block_hits.load(), block_misses.load(), readahead_blocks.load(),
+            bytes_decrypted.load()};
+}
+
+std::size_t RomFSReader::ReadUncached(std::size_t offset, std::size_t length, u8* buffer) {
     file.Seek(file_offset + offset, SEEK_SET);
-    std::size_t read_length = std::min(length, data_size - offset);
-    read_length = file.ReadBytes(buffer, read_length);
-    if (is_encrypted) {
-        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-        d.Seek(crypto_offset + offset);
-        d.ProcessData(buffer, buffer, read_length);
+    const std::size_t read_length = file.ReadBytes(buffer, length);
+    if (is_encrypted && read_length > 0) { // Crypto++ does not like zero size buffer
+        cipher->decryption.Seek(crypto_offset + offset);
+        cipher->decryption.ProcessData(buffer, buffer, read_length);
+        bytes_decrypted += read_length;
     }
     return read_length;
 }
 
+RomFSReader::Block RomFSReader::FindCachedBlock(std::size_t block_index) {
+    const auto it = cache_index.find(block_index);
+    if (it == cache_index.end())
+        return nullptr;
+    cache.splice(cache.begin(), cache, it->second);
+    return it->second->data;
+}
+
+RomFSReader::Block RomFSReader::LoadBlock(std::size_t block_index, bool readahead) {
+    std::lock_guard<std::mutex> file_lock(file_mutex);
+
+    // Another thread may have loaded the block while this one was waiting for the file
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (Block block = FindCachedBlock(block_index))
+            return block;
+    }
+
+    const std::size_t offset = block_index * BLOCK_SIZE;
+    auto data = std::make_shared<std::vector<u8>>(std::min(BLOCK_SIZE, data_size - offset));
+    data->resize(ReadUncached(offset, data->size(), data->data()));
+    if (readahead) {
+        ++readahead_blocks;
+    }
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache.push_front({block_index, data});
+    cache_index[block_index] = cache.begin();
+    if (cache.size() > CACHE_CAPACITY) {
+        cache_index.erase(cache.back().index);
+        cache.pop_back();
+    }
+    return data;
+}
+
+void RomFSReader::RequestReadahead(std::size_t last_block_index) {
+    bool queued = false;
+    for (std::size_t i = 1; i <= READAHEAD_BLOCKS; ++i) {
+        const std::size_t block_index = last_block_index + i;
+        if (block_index * BLOCK_SIZE >= data_size)
+            break;
+        if (cache_index.count(block_index) != 0 ||
+            std::find(readahead_queue.begin(), readahead_queue.end(), block_index) !=
+                readahead_queue.end())
+            continue;
+        readahead_queue.push_back(block_index);
+        queued = true;
+    }
+    if (!queued)
+        return;
+
+    if (!readahead_thread.joinable()) {
+        readahead_thread = std::thread(&RomFSReader::ReadaheadLoop, this);
+    }
+    readahead_requested.notify_one();
+}
+
+void RomFSReader::ReadaheadLoop() {
+    Common::SetCurrentThreadName("RomFSReadahead");
+
+    while (true) {
+        std::size_t block_index;
+        {
+            std::unique_lock<std::mutex> lock(cache_mutex);
+            readahead_requested.wait(
+                lock, [this] { return stop_readahead || !readahead_queue.empty(); });
+            if (stop_readahead)
+                return;
+            block_index = readahead_queue.front();
+            readahead_queue.pop_front();
+        }
+        LoadBlock(block_index, true);
+    }
+}
+
 } // namespace FileSys
@@ -1,22 +1,40 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "common/file_util.h"
 
 namespace FileSys {
 
+/**
+ * Reads (and decrypts, if needed) the RomFS of a title from its file. Data is read in fixed-size
+ * blocks which are kept in an LRU cache, and when the title reads sequentially the following
+ * blocks are loaded ahead of time on a background thread. ReadFile may be called from any thread.
+ */
 class RomFSReader {
 public:
-    RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    /// Statistics about the block cache, for performance analysis
+    struct CacheStatistics {
+        u64 block_hits;
+        u64 block_misses;
+        u64 readahead_blocks;
+        u64 bytes_decrypted;
+    };
 
+    RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
     RomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                 const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                std::size_t crypto_offset);
+    ~RomFSReader();
 
     std::size_t GetSize() const {
         return data_size;
@@ -24,7 +42,47 @@ public:
 
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer);
 
+    CacheStatistics GetCacheStatistics() const;
+
 private:
+    /// Size of a cached block. A multiple of the AES block size so blocks can be decrypted alone.
+    static constexpr std::size_t BLOCK_SIZE = 0x10000;
+    /// Number of blocks kept in the cache
+    static constexpr std::size_t CACHE_CAPACITY = 64;
+    /// Number of blocks loaded ahead of a sequential read
+    static constexpr std::size_t READAHEAD_BLOCKS = 4;
+
+    using Block = std::shared_ptr<const std::vector<u8>>;
+
+    struct CachedBlock {
+        std::size_t index;
+        Block data;
+    };
+
+    struct Cipher;
+
+    /**
+     * Reads and decrypts data straight from the file. file_mutex must be held.
+     * @returns The number of bytes read, less than length if the file is truncated
+     */
+    std::size_t ReadUncached(std::size_t offset, std::size_t length, u8* buffer);
+
+    /**
+     * Looks up a block in the cache and marks it as the most recently used one. cache_mutex must
+     * be held.
+     * @returns The block, or nullptr if it isn't cached
+     */
+    Block FindCachedBlock(std::size_t block_index);
+
+    /// Loads a block from the file into the cache, unless another thread already did
+    Block LoadBlock(std::size_t block_index, bool readahead);
+
+    /// Queues the blocks following a read to be loaded by the readahead thread. cache_mutex must
+    /// be held.
+    void RequestReadahead(std::size_t last_block_index);
+
+    void ReadaheadLoop();
+
     bool is_encrypted;
     FileUtil::IOFile file;
     std::array<u8, 16> key;
@@ -32,6 +90,27 @@ private:
     std::size_t file_offset;
     std::size_t crypto_offset;
     std::size_t data_size;
+
+    /// Protects the file and the cipher
+    std::mutex file_mutex;
+    std::unique_ptr<Cipher> cipher;
+
+    /// Protects the cache, the readahead queue and the sequential read detection
+    mutable std::mutex cache_mutex;
+    /// Cached blocks, most recently used first
+    std::list<CachedBlock> cache;
+    std::unordered_map<std::size_t, std::list<CachedBlock>::iterator> cache_index;
+    std::size_t next_sequential_offset = 0;
+
+    std::deque<std::size_t> readahead_queue;
+    std::condition_variable readahead_requested;
+    std::thread readahead_thread;
+    bool stop_readahead = false;
+
+    std::atomic<u64> block_hits{0};
+    std::atomic<u64> block_misses{0};
+    std::atomic<u64> readahead_blocks{0};
+    std::atomic<u64> bytes_decrypted{0};
 };
 
 } // namespace FileSys
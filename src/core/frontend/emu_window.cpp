@@ -47,6 +47,8 @@ EmuWindow::EmuWindow() {
     Input::RegisterFactory<Input::TouchDevice>("emu_window", touch_state);
 }
 
+GraphicsContext::~GraphicsContext() = default;
+
 EmuWindow::~EmuWindow() {
     Input::UnregisterFactory<Input::TouchDevice>("emu_window");
 }
@@ -10,6 +10,21 @@
 #include "common/common_types.h"
 #include "core/frontend/framebuffer_layout.h"
 
+/**
+ * A graphics context sharing objects with the context of the window it was created from, used to
+ * do GPU work such as shader compilation on worker threads.
+ */
+class GraphicsContext {
+public:
+    virtual ~GraphicsContext();
+
+    /// Makes the graphics context current for the caller thread
+    virtual void MakeCurrent() = 0;
+
+    /// Releases the graphics context from the caller thread
+    virtual void DoneCurrent() = 0;
+};
+
 /**
  * Abstraction class used to provide an interface between emulation code and the frontend
  * (e.g. SDL, QGLWidget, GLFW, etc...).
@@ -50,6 +65,14 @@ public:
     /// Releases (dunno if this is the "right" word) the GLFW context from the caller thread
     virtual void DoneCurrent() = 0;
 
+    /**
+     * Creates a graphics context that shares objects with the context of this window. Returns
+     * nullptr if the frontend does not support shared contexts.
+     */
+    virtual std::unique_ptr<GraphicsContext> CreateSharedContext() const {
+        return nullptr;
+    }
+
     /**
      * Signal that a touch pressed event has occurred (e.g. mouse click pressed)
      * @param framebuffer_x Framebuffer x-coordinate that was pressed
@@ -11,6 +11,7 @@
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
+#include "core/memory.h"
 
 namespace Kernel {
 
@@ -247,4 +248,14 @@ void MappedBuffer::Write(const void* src_buffer, size_t offset, size_t size) {
     Memory::WriteBlock(*process, address + static_cast<VAddr>(offset), src_buffer, size);
 }
 
+boost::optional<std::vector<Memory::HostMemorySpan>> MappedBuffer::GetHostSpans(size_t offset,
+                                                                                size_t size,
+                                                                                bool for_writing) {
+    ASSERT(perms & (for_writing ? IPC::W : IPC::R));
+    ASSERT(offset + size <= this->size);
+    return Memory::GetHostMemorySpans(*process, address + static_cast<VAddr>(offset), size,
+                                      for_writing ? Memory::FlushMode::Invalidate
+                                                  : Memory::FlushMode::Flush);
+}
+
 } // namespace Kernel
@@ -11,11 +11,13 @@
 #include <string>
 #include <vector>
 #include <boost/container/small_vector.hpp>
+#include <boost/optional.hpp>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/memory.h"
 
 namespace Service {
 class ServiceFrameworkBase;
@@ -100,6 +102,17 @@ public:
     // interface for service
     void Read(void* dest_buffer, size_t offset, size_t size);
     void Write(const void* src_buffer, size_t offset, size_t size);
+
+    /**
+     * Gets the guest memory backing a part of the buffer as host spans, so that services can read
+     * from or write to it in place instead of copying through an intermediate buffer.
+     * @param for_writing Whether the spans will be written to rather than read from
+     * @returns The spans, or nothing if the buffer isn't backed by regular memory, in which case
+     *          Read/Write must be used instead
+     */
+    boost::optional<std::vector<Memory::HostMemorySpan>> GetHostSpans(size_t offset, size_t size,
+                                                                      bool for_writing);
+
     size_t GetSize() const {
         return size;
     }
@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <list>
+#include <set>
+#include <utility>
 #include <vector>
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -46,7 +48,28 @@ static Kernel::HandleTable wakeup_callback_handle_table;
 static std::vector<SharedPtr<Thread>> thread_list;
 
 // Lists only ready thread ids.
-static Common::ThreadQueueList<Thread*, THREADPRIO_LOWEST + 1> ready_queue;
+static Common::ThreadQueueList<Thread*, THREADPRIO_LOWEST + 1, &Thread::ready_queue_node>
+    ready_queue;
+
+// The threads in ready_queue, ordered by the tick they last ran at. A thread's last_running_ticks
+// doesn't change while it is ready, so only the front of this has to be checked for starvation.
+static std::set<std::pair<u64, Thread*>> ready_threads_by_last_run;
+
+/// Adds a thread to the ready queue, in front of or behind the threads of the same priority
+static void AddReadyThread(Thread* thread, bool in_front) {
+    if (in_front) {
+        ready_queue.push_front(thread->current_priority, thread);
+    } else {
+        ready_queue.push_back(thread->current_priority, thread);
+    }
+    ready_threads_by_last_run.emplace(thread->last_running_ticks, thread);
+}
+
+/// Removes a thread from the ready queue, if it's in it
+static void RemoveReadyThread(Thread* thread) {
+    ready_queue.remove(thread->current_priority, thread);
+    ready_threads_by_last_run.erase({thread->last_running_ticks, thread});
+}
 
 static SharedPtr<Thread> current_thread;
 
@@ -77,7 +100,7 @@ void Thread::Stop() {
     // Clean up thread from ready queue
     // This is only needed when the thread is termintated forcefully (SVC TerminateProcess)
     if (status == THREADSTATUS_READY) {
-        ready_queue.remove(current_priority, this);
+        RemoveReadyThread(this);
     }
 
     status = THREADSTATUS_DEAD;
@@ -103,16 +126,22 @@ void Thread::Stop() {
 /// Boost low priority threads (temporarily) that have been starved
 static void PriorityBoostStarvedThreads() {
     u64 current_ticks = CoreTiming::GetTicks();
+    const u64 boost_timeout = 2000000; // Boost threads that have been ready for > this long
 
-    for (auto& thread : thread_list) {
-        const u64 boost_timeout = 2000000; // Boost threads that have been ready for > this long
-
-        u64 delta = current_ticks - thread->last_running_ticks;
-
-        if (thread->status == THREADSTATUS_READY && delta > boost_timeout) {
-            const s32 priority = std::max(ready_queue.get_first()->current_priority - 1, 0u);
-            thread->BoostPriority(priority);
+    std::vector<Thread*> starved_threads;
+    for (const auto& [last_running_ticks, thread] : ready_threads_by_last_run) {
+        if (current_ticks - last_running_ticks <= boost_timeout) {
+            break;
         }
+        starved_threads.push_back(thread);
+    }
+
+    // Each boost is relative to the best ready thread at the time, so boost in creation order
+    std::sort(starved_threads.begin(), starved_threads.end(),
+              [](const Thread* a, const Thread* b) { return a->thread_id < b->thread_id; });
+    for (Thread* thread : starved_threads) {
+        const s32 priority = std::max(ready_queue.get_first()->current_priority - 1, 0u);
+        thread->BoostPriority(priority);
     }
 }
 
@@ -131,7 +160,7 @@ static void SwitchContext(Thread* new_thread) {
         if (previous_thread->status == THREADSTATUS_RUNNING) {
             // This is only the case when a reschedule is triggered without the current thread
             // yielding execution (i.e. an event triggered, system core time-sliced, etc)
-            ready_queue.push_front(previous_thread->current_priority, previous_thread);
+            AddReadyThread(previous_thread, true);
             previous_thread->status = THREADSTATUS_READY;
         }
     }
@@ -148,7 +177,7 @@ static void SwitchContext(Thread* new_thread) {
 
         current_thread = new_thread;
 
-        ready_queue.remove(new_thread->current_priority, new_thread);
+        RemoveReadyThread(new_thread);
         new_thread->status = THREADSTATUS_RUNNING;
 
         if (Settings::values.priority_boost)
@@ -188,6 +217,10 @@ static Thread* PopNextReadyThread() {
         next = ready_queue.pop_first();
     }
 
+    if (next) {
+        ready_threads_by_last_run.erase({next->last_running_ticks, next});
+    }
+
     return next;
 }
 
@@ -273,7 +306,7 @@ void Thread::ResumeFromWait() {
 
     wakeup_callback = nullptr;
 
-    ready_queue.push_back(current_priority, this);
+    AddReadyThread(this, false);
     status = THREADSTATUS_READY;
     Core::System::GetInstance().PrepareReschedule();
 }
@@ -366,7 +399,6 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     SharedPtr<Thread> thread(new Thread);
 
     thread_list.push_back(thread);
-    ready_queue.prepare(priority);
 
     thread->thread_id = NewThreadId();
     thread->status = THREADSTATUS_DORMANT;
@@ -427,7 +459,7 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     // to initialize the context
     ResetThreadContext(thread->context, stack_top, entry_point, arg);
 
-    ready_queue.push_back(thread->current_priority, thread.get());
+    AddReadyThread(thread.get(), false);
     thread->status = THREADSTATUS_READY;
 
     return MakeResult<SharedPtr<Thread>>(std::move(thread));
@@ -439,8 +471,6 @@ void Thread::SetPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == THREADSTATUS_READY)
         ready_queue.move(this, current_priority, priority);
-    else
-        ready_queue.prepare(priority);
 
     nominal_priority = current_priority = priority;
 }
@@ -458,8 +488,6 @@ void Thread::BoostPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == THREADSTATUS_READY)
         ready_queue.move(this, current_priority, priority);
-    else
-        ready_queue.prepare(priority);
     current_priority = priority;
 }
 
@@ -537,6 +565,7 @@ void ThreadingShutdown() {
     }
     thread_list.clear();
     ready_queue.clear();
+    ready_threads_by_last_run.clear();
     ClearProcessList();
 }
 
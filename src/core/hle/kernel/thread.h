@@ -10,6 +10,7 @@
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 #include "common/common_types.h"
+#include "common/thread_queue_list.h"
 #include "core/arm/arm_interface.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/wait_object.h"
@@ -195,6 +196,9 @@ public:
 
     u64 last_running_ticks; ///< CPU tick when thread was last running
 
+    /// Links to the neighbouring threads of the same priority while this thread is ready
+    Common::ThreadQueueListNode<Thread*> ready_queue_node;
+
     s32 processor_id;
 
     VAddr tls_address; ///< Virtual address of the Thread Local Storage of the thread
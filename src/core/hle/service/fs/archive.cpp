@@ -51,6 +51,72 @@ enum class DirectoryCommand : u32 {
     Close = 0x08020000,
 };
 
+/**
+ * Reads from a file straight into the guest memory backing a mapped buffer. An intermediate copy is
+ * made if that memory can't be accessed directly or isn't contiguous on the host, or if the read is
+ * larger than the buffer.
+ * @return Number of bytes read, or error code
+ */
+static ResultVal<size_t> ReadIntoMappedBuffer(const FileSys::FileBackend& backend, u64 offset,
+                                              size_t length, Kernel::MappedBuffer& buffer) {
+    // Getting the spans invalidates the rasterizer cache over them, so they must not extend past
+    // the end of the file, where nothing would be read to replace the cached data
+    const u64 file_size = backend.GetSize();
+    if (offset >= file_size) {
+        length = 0;
+    } else if (length > file_size - offset) {
+        length = static_cast<size_t>(file_size - offset);
+    }
+
+    auto spans = length <= buffer.GetSize() ? buffer.GetHostSpans(0, length, true) : boost::none;
+
+    // With several spans, a failed read of a later one would leave the buffer partially written
+    if (!spans || spans->size() != 1) {
+        std::vector<u8> data(length);
+        ResultVal<size_t> read = backend.Read(offset, data.size(), data.data());
+        if (read.Succeeded()) {
+            buffer.Write(data.data(), 0, *read);
+        }
+        return read;
+    }
+
+    const Memory::HostMemorySpan& span = spans->front();
+    return backend.Read(offset, span.size, span.pointer);
+}
+
+/**
+ * Writes to a file straight from the guest memory backing a mapped buffer. An intermediate copy is
+ * only made if that memory can't be accessed directly.
+ * @return Number of bytes written, or error code
+ */
+static ResultVal<size_t> WriteFromMappedBuffer(FileSys::FileBackend& backend, u64 offset,
+                                               size_t length, bool flush,
+                                               Kernel::MappedBuffer& buffer) {
+    auto spans = buffer.GetHostSpans(0, length, false);
+    if (!spans) {
+        std::vector<u8> data(length);
+        buffer.Read(data.data(), 0, data.size());
+        return backend.Write(offset, data.size(), flush, data.data());
+    }
+
+    size_t total_written = 0;
+    for (size_t i = 0; i < spans->size(); ++i) {
+        const Memory::HostMemorySpan& span = (*spans)[i];
+        // Only flush once all of the data has been written
+        const bool last_span = i + 1 == spans->size();
+        ResultVal<size_t> written =
+            backend.Write(offset + total_written, span.size, flush && last_span, span.pointer);
+        if (written.Failed()) {
+            return written.Code();
+        }
+        total_written += *written;
+        if (*written < span.size) {
+            break;
+        }
+    }
+    return MakeResult<size_t>(total_written);
+}
+
 File::File(std::unique_ptr<FileSys::FileBackend>&& backend, const FileSys::Path& path)
     : ServiceFramework("", 1), path(path), backend(std::move(backend)) {
     static const FunctionInfo functions[] = {
@@ -93,13 +159,11 @@ void File::Read(Kernel::HLERequestContext& ctx) {
 
     IPC::ResponseBuilder rb{rp.MakeBuilder(2, 2)};
 
-    std::vector<u8> data(length);
-    ResultVal<size_t> read = backend->Read(offset, data.size(), data.data());
+    ResultVal<size_t> read = ReadIntoMappedBuffer(*backend, offset, length, buffer);
     if (read.Failed()) {
         rb.Push(read.Code());
         rb.Push<u32>(0);
     } else {
-        buffer.Write(data.data(), 0, *read);
         rb.Push(RESULT_SUCCESS);
         rb.Push<u32>(static_cast<u32>(*read));
     }
@@ -134,9 +198,7 @@ void File::Write(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    std::vector<u8> data(length);
-    buffer.Read(data.data(), 0, data.size());
-    ResultVal<size_t> written = backend->Write(offset, data.size(), flush != 0, data.data());
+    ResultVal<size_t> written = WriteFromMappedBuffer(*backend, offset, length, flush != 0, buffer);
     if (written.Failed()) {
         rb.Push(written.Code());
         rb.Push<u32>(0);
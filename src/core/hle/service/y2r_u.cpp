@@ -5,6 +5,7 @@
 #include <cstring>
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
+#include "core/core_timing.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/process.h"
@@ -20,6 +21,10 @@ static const CoefficientSet standard_coefficients[4] = {
     {{0x12A, 0x1CA, 0x88, 0x36, 0x21C, -0x1F04, 0x99C, -0x2421}},  // ITU_Rec709_Scaling
 };
 
+/// Emulated time a conversion takes per pixel. This is an estimate, which puts a 400x240 frame at
+/// about 1.5ms.
+constexpr u64 CONVERSION_CYCLES_PER_PIXEL = 4;
+
 ResultCode ConversionConfiguration::SetInputLineWidth(u16 width) {
     if (width == 0 || width > 1024 || width % 8 != 0) {
         return ResultCode(ErrorDescription::OutOfRange, ErrorModule::CAM,
@@ -500,15 +505,28 @@ void Y2R_U::GetDitheringWeightParams(Kernel::HLERequestContext& ctx) {
 void Y2R_U::StartConversion(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp{ctx, 0x26, 0, 0};
 
-    // dst_image_size would seem to be perfect for this, but it doesn't include the gap :(
-    u32 total_output_size =
-        conversion.input_lines * (conversion.dst.transfer_unit + conversion.dst.gap);
-    Memory::RasterizerFlushVirtualRegion(conversion.dst.address, total_output_size,
-                                         Memory::FlushMode::FlushAndInvalidate);
+    if (pending_conversion) {
+        LOG_WARNING(Service_Y2R, "started a conversion while another one is in progress");
+        CancelConversion();
+    }
 
-    HW::Y2R::PerformConversion(conversion);
+    // TODO (wwylele): use the processes passed to SetSending* and SetReceiving
+    conversion_process = Kernel::g_current_process;
+    pending_conversion = std::make_unique<HW::Y2R::Conversion>(conversion);
+    pending_conversion->ReadInput(*conversion_process);
 
-    completion_event->Signal();
+    // Like on hardware, the buffers are left pointing past the transferred data. This only depends
+    // on the configuration, so it is done right away, and buffers the application sets while the
+    // conversion runs are kept.
+    HW::Y2R::AdvanceBuffers(conversion);
+
+    // The conversion itself runs on a worker thread. Its output is only written to memory when
+    // the completion event is scheduled, which blocks on the worker if it is not finished by then.
+    conversion_result =
+        std::async(std::launch::async, [job = pending_conversion.get()] { job->Perform(); });
+    const u64 num_pixels = conversion.input_lines * conversion.input_line_width;
+    CoreTiming::ScheduleEvent(static_cast<s64>(num_pixels * CONVERSION_CYCLES_PER_PIXEL),
+                              completion_event_callback);
 
     IPC::ResponseBuilder rb{rp.MakeBuilder(1, 0)};
     rb.Push(RESULT_SUCCESS);
@@ -519,6 +537,8 @@ void Y2R_U::StartConversion(Kernel::HLERequestContext& ctx) {
 void Y2R_U::StopConversion(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp{ctx, 0x27, 0, 0};
 
+    CancelConversion();
+
     IPC::ResponseBuilder rb{rp.MakeBuilder(1, 0)};
     rb.Push(RESULT_SUCCESS);
 
@@ -530,7 +550,7 @@ void Y2R_U::IsBusyConversion(Kernel::HLERequestContext& ctx) {
 
     IPC::ResponseBuilder rb{rp.MakeBuilder(2, 0)};
     rb.Push(RESULT_SUCCESS);
-    rb.Push<u8>(0); // StartConversion always finishes immediately
+    rb.Push<u8>(pending_conversion != nullptr);
 
     LOG_DEBUG(Service_Y2R, "called");
 }
@@ -683,9 +703,31 @@ Y2R_U::Y2R_U() : ServiceFramework("y2r:u", 1) {
     RegisterHandlers(functions);
 
     completion_event = Kernel::Event::Create(Kernel::ResetType::OneShot, "Y2R:Completed");
+    completion_event_callback = CoreTiming::RegisterEvent(
+        "Y2R::CompletionEventCallBack",
+        [this](u64 userdata, s64 cycles_late) { CompletionEventCallBack(userdata, cycles_late); });
 }
 
-Y2R_U::~Y2R_U() = default;
+Y2R_U::~Y2R_U() {
+    CancelConversion();
+}
+
+void Y2R_U::CompletionEventCallBack(u64, s64) {
+    conversion_result.wait();
+    pending_conversion->WriteOutput(*conversion_process);
+    pending_conversion.reset();
+    conversion_process = nullptr;
+    completion_event->Signal();
+}
+
+void Y2R_U::CancelConversion() {
+    if (!pending_conversion)
+        return;
+    CoreTiming::UnscheduleEvent(completion_event_callback, 0);
+    conversion_result.wait();
+    pending_conversion.reset();
+    conversion_process = nullptr;
+}
 
 void InstallInterfaces(SM::ServiceManager& service_manager) {
     std::make_shared<Y2R_U>()->InstallAsService(service_manager);
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <future>
 #include <memory>
 #include <string>
 #include "common/common_types.h"
@@ -12,8 +13,17 @@
 #include "core/hle/result.h"
 #include "core/hle/service/service.h"
 
+namespace CoreTiming {
+struct EventType;
+} // namespace CoreTiming
+
+namespace HW::Y2R {
+class Conversion;
+} // namespace HW::Y2R
+
 namespace Kernel {
 class Event;
+class Process;
 } // namespace Kernel
 
 namespace Service::Y2R {
@@ -290,7 +300,22 @@ private:
     void DriverFinalize(Kernel::HLERequestContext& ctx);
     void GetPackageParameter(Kernel::HLERequestContext& ctx);
 
+    /// Finishes the conversion in progress once the time it takes on hardware has passed.
+    void CompletionEventCallBack(u64, s64);
+
+    /// Abandons the conversion in progress, if any, without writing its output.
+    void CancelConversion();
+
     Kernel::SharedPtr<Kernel::Event> completion_event;
+    CoreTiming::EventType* completion_event_callback;
+
+    /// The conversion in progress, or nullptr if the engine is idle
+    std::unique_ptr<HW::Y2R::Conversion> pending_conversion;
+    /// Process whose memory the conversion in progress writes its output to
+    Kernel::SharedPtr<Kernel::Process> conversion_process;
+    /// Completes when the conversion in progress has been performed on its worker thread
+    std::future<void> conversion_result;
+
     ConversionConfiguration conversion{};
     DitheringWeightParams dithering_weight_params{};
     bool temporal_dithering_enabled = false;
@@ -2,25 +2,37 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <memory>
 #include <numeric>
 #include <type_traits>
+#include <vector>
 #include "common/alignment.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
+#include "core/hw/gpu_thread.h"
 #include "core/hw/hw.h"
 #include "core/memory.h"
+#include "core/settings.h"
 #include "video_core/command_processor.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace GPU {
 
 Regs g_regs;
@@ -44,26 +56,95 @@ inline void Read(T& var, const u32 raw_addr) {
     var = g_regs[index];
 }
 
-static Math::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_pixel) {
-    switch (input_format) {
-    case Regs::PixelFormat::RGBA8:
-        return Color::DecodeRGBA8(src_pixel);
+/// Minimum number of output pixels for a display transfer to be split across threads
+constexpr u32 PARALLEL_DISPLAY_TRANSFER_MIN_PIXELS = 0x8000;
+/// Number of output rows converted by one parallel task
+constexpr u32 PARALLEL_DISPLAY_TRANSFER_ROWS = 8;
+
+static std::unique_ptr<Common::ThreadPool> display_transfer_pool;
+static u16 display_transfer_pool_threads = 1;
+
+/// Returns the pool used for converting large display transfers, or nullptr if it's disabled
+static Common::ThreadPool* GetDisplayTransferPool() {
+    const u16 num_threads = Settings::values.display_transfer_num_threads;
+    if (num_threads != display_transfer_pool_threads) {
+        display_transfer_pool_threads = num_threads;
+        display_transfer_pool.reset();
+        if (num_threads != 1) {
+            display_transfer_pool =
+                std::make_unique<Common::ThreadPool>(num_threads, "DisplayTransfer");
+            if (display_transfer_pool->NumThreads() == 1) {
+                display_transfer_pool.reset();
+            }
+        }
+    }
+    return display_transfer_pool.get();
+}
 
+static constexpr u32 PixelSize(Regs::PixelFormat format) {
+    switch (format) {
+    case Regs::PixelFormat::RGBA8:
+        return 4;
     case Regs::PixelFormat::RGB8:
-        return Color::DecodeRGB8(src_pixel);
-
+        return 3;
     case Regs::PixelFormat::RGB565:
-        return Color::DecodeRGB565(src_pixel);
-
     case Regs::PixelFormat::RGB5A1:
-        return Color::DecodeRGB5A1(src_pixel);
-
     case Regs::PixelFormat::RGBA4:
+        return 2;
+    }
+    return 0;
+}
+
+template <Regs::PixelFormat format>
+static Math::Vec4<u8> DecodePixel(const u8* src_pixel) {
+    if constexpr (format == Regs::PixelFormat::RGBA8) {
+        return Color::DecodeRGBA8(src_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB8) {
+        return Color::DecodeRGB8(src_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB565) {
+        return Color::DecodeRGB565(src_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB5A1) {
+        return Color::DecodeRGB5A1(src_pixel);
+    } else {
+        static_assert(format == Regs::PixelFormat::RGBA4, "Unknown pixel format");
         return Color::DecodeRGBA4(src_pixel);
+    }
+}
 
-    default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", static_cast<u32>(input_format));
-        return {0, 0, 0, 0};
+template <Regs::PixelFormat format>
+static void EncodePixel(const Math::Vec4<u8>& color, u8* dst_pixel) {
+    if constexpr (format == Regs::PixelFormat::RGBA8) {
+        Color::EncodeRGBA8(color, dst_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB8) {
+        Color::EncodeRGB8(color, dst_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB565) {
+        Color::EncodeRGB565(color, dst_pixel);
+    } else if constexpr (format == Regs::PixelFormat::RGB5A1) {
+        Color::EncodeRGB5A1(color, dst_pixel);
+    } else {
+        static_assert(format == Regs::PixelFormat::RGBA4, "Unknown pixel format");
+        Color::EncodeRGBA4(color, dst_pixel);
+    }
+}
+
+/**
+ * Fills memory by repeating a value of up to 4 bytes.
+ * @param size Number of bytes to fill, which must be a multiple of value_size
+ */
+static void FillRepeated(u8* start, size_t size, const u8* value, size_t value_size) {
+    // Repeat the value once over a pattern which is a multiple of every value size, then keep
+    // doubling the filled area by copying it onto the rest.
+    std::array<u8, 48> pattern;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        pattern[i] = value[i % value_size];
+    }
+
+    size_t filled = std::min(size, pattern.size());
+    std::memcpy(start, pattern.data(), filled);
+    while (filled < size) {
+        const size_t copy_size = std::min(filled, size - filled);
+        std::memcpy(start + filled, start, copy_size);
+        filled += copy_size;
     }
 }
 
@@ -97,26 +178,259 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
     Memory::RasterizerInvalidateRegion(config.GetStartAddress(),
                                        config.GetEndAddress() - config.GetStartAddress());
 
+    const size_t size = static_cast<size_t>(end - start);
     if (config.fill_24bit) {
-        // fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
-        }
+        // fill with 24-bit values. The last value is written whole even if it crosses the end.
+        const u8 value[] = {static_cast<u8>(config.value_24bit_r),
+                            static_cast<u8>(config.value_24bit_g),
+                            static_cast<u8>(config.value_24bit_b)};
+        FillRepeated(start, Common::AlignUp(size, 3), value, sizeof(value));
     } else if (config.fill_32bit) {
         // fill with 32-bit values
-        if (end > start) {
-            u32 value = config.value_32bit;
-            size_t len = (end - start) / sizeof(u32);
-            for (size_t i = 0; i < len; ++i)
-                memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-        }
+        const u32 value = config.value_32bit;
+        FillRepeated(start, Common::AlignDown(size, sizeof(u32)),
+                     reinterpret_cast<const u8*>(&value), sizeof(u32));
     } else {
         // fill with 16-bit values
-        u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
-            memcpy(ptr, &value_16bit, sizeof(u16));
+        const u16 value_16bit = config.value_16bit.Value();
+        FillRepeated(start, Common::AlignUp(size, sizeof(u16)),
+                     reinterpret_cast<const u8*>(&value_16bit), sizeof(u16));
+    }
+}
+
+/**
+ * Converts one output row of a display transfer. The offset of each pixel within its row only
+ * depends on its column in every tiling mode, so it is looked up in per-column tables.
+ */
+using TransferRowFunc = void (*)(const u8* src_row, u8* dst_row, const u32* src_columns,
+                                 const u32* dst_columns, u32 width);
+
+template <Regs::PixelFormat input_format, Regs::PixelFormat output_format,
+          Regs::DisplayTransferConfig::ScalingMode scaling>
+static void TransferRow(const u8* src_row, u8* dst_row, const u32* src_columns,
+                        const u32* dst_columns, u32 width) {
+    constexpr u32 src_bytes_per_pixel = PixelSize(input_format);
+
+    for (u32 x = 0; x < width; ++x) {
+        const u8* src_pixel = src_row + src_columns[x];
+        Math::Vec4<u8> src_color = DecodePixel<input_format>(src_pixel);
+        if constexpr (scaling == Regs::DisplayTransferConfig::ScaleX) {
+            Math::Vec4<u8> pixel = DecodePixel<input_format>(src_pixel + src_bytes_per_pixel);
+            src_color = ((src_color + pixel) / 2).Cast<u8>();
+        } else if constexpr (scaling == Regs::DisplayTransferConfig::ScaleXY) {
+            Math::Vec4<u8> pixel1 = DecodePixel<input_format>(src_pixel + 1 * src_bytes_per_pixel);
+            Math::Vec4<u8> pixel2 = DecodePixel<input_format>(src_pixel + 2 * src_bytes_per_pixel);
+            Math::Vec4<u8> pixel3 = DecodePixel<input_format>(src_pixel + 3 * src_bytes_per_pixel);
+            src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
+        }
+        EncodePixel<output_format>(src_color, dst_row + dst_columns[x]);
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+/**
+ * Loads 4 RGBA8 pixels of a tiled row. Within a tile row, pixels come in pairs that are adjacent
+ * in memory, so the start of every other pixel is enough.
+ */
+static __m128i LoadTiledRGBA8(const u8* src_row, const u32* src_columns) {
+    const __m128i pixels01 =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_row + src_columns[0]));
+    const __m128i pixels23 =
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_row + src_columns[2]));
+    return _mm_unpacklo_epi64(pixels01, pixels23);
+}
+
+/// Converts a row of tiled RGBA8 pixels to linear RGBA8, 8 pixels at a time.
+static void TransferTiledRowRGBA8ToRGBA8(const u8* src_row, u8* dst_row, const u32* src_columns,
+                                         const u32* dst_columns, u32 width) {
+    const u32 simd_width = Common::AlignDown(width, 8u);
+    for (u32 x = 0; x < simd_width; x += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_row + x * 4),
+                         LoadTiledRGBA8(src_row, src_columns + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_row + x * 4 + 16),
+                         LoadTiledRGBA8(src_row, src_columns + x + 4));
+    }
+    TransferRow<Regs::PixelFormat::RGBA8, Regs::PixelFormat::RGBA8,
+                Regs::DisplayTransferConfig::NoScale>(src_row, dst_row, src_columns + simd_width,
+                                                      dst_columns + simd_width, width - simd_width);
+}
+
+/// Drops the alpha byte of 4 RGBA8 pixels, leaving the 12 bytes of their RGB8 encoding.
+static __m128i PackRGB8(__m128i pixels) {
+    const __m128i rgb = _mm_srli_epi32(pixels, 8);
+    const __m128i even_pixels = _mm_set_epi32(0, -1, 0, -1);
+    // Join pairs of pixels into the low 6 bytes of each 64-bit lane, then join the lanes
+    const __m128i pairs = _mm_or_si128(_mm_and_si128(rgb, even_pixels),
+                                       _mm_srli_epi64(_mm_andnot_si128(even_pixels, rgb), 8));
+    return _mm_or_si128(_mm_move_epi64(pairs), _mm_slli_si128(_mm_srli_si128(pairs, 8), 6));
+}
+
+/// Converts a row of tiled RGBA8 pixels to linear RGB8, 8 pixels at a time.
+static void TransferTiledRowRGBA8ToRGB8(const u8* src_row, u8* dst_row, const u32* src_columns,
+                                        const u32* dst_columns, u32 width) {
+    const u32 simd_width = Common::AlignDown(width, 8u);
+    for (u32 x = 0; x < simd_width; x += 8) {
+        const __m128i low = PackRGB8(LoadTiledRGBA8(src_row, src_columns + x));
+        const __m128i high = PackRGB8(LoadTiledRGBA8(src_row, src_columns + x + 4));
+        // 24 bytes are written as 16 + 8, so that nothing past the row is touched
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_row + x * 3),
+                         _mm_or_si128(low, _mm_slli_si128(high, 12)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst_row + x * 3 + 16),
+                         _mm_srli_si128(high, 4));
+    }
+    TransferRow<Regs::PixelFormat::RGBA8, Regs::PixelFormat::RGB8,
+                Regs::DisplayTransferConfig::NoScale>(src_row, dst_row, src_columns + simd_width,
+                                                      dst_columns + simd_width, width - simd_width);
+}
+
+#endif // ARCHITECTURE_x86_64
+
+template <Regs::PixelFormat input_format, Regs::PixelFormat output_format>
+static TransferRowFunc GetTransferRowFunc(Regs::DisplayTransferConfig::ScalingMode scaling) {
+    switch (scaling) {
+    case Regs::DisplayTransferConfig::NoScale:
+        return TransferRow<input_format, output_format, Regs::DisplayTransferConfig::NoScale>;
+    case Regs::DisplayTransferConfig::ScaleX:
+        return TransferRow<input_format, output_format, Regs::DisplayTransferConfig::ScaleX>;
+    case Regs::DisplayTransferConfig::ScaleXY:
+        return TransferRow<input_format, output_format, Regs::DisplayTransferConfig::ScaleXY>;
+    default:
+        return nullptr;
+    }
+}
+
+template <Regs::PixelFormat input_format>
+static TransferRowFunc GetTransferRowFunc(Regs::PixelFormat output_format,
+                                          Regs::DisplayTransferConfig::ScalingMode scaling) {
+    switch (output_format) {
+    case Regs::PixelFormat::RGBA8:
+        return GetTransferRowFunc<input_format, Regs::PixelFormat::RGBA8>(scaling);
+    case Regs::PixelFormat::RGB8:
+        return GetTransferRowFunc<input_format, Regs::PixelFormat::RGB8>(scaling);
+    case Regs::PixelFormat::RGB565:
+        return GetTransferRowFunc<input_format, Regs::PixelFormat::RGB565>(scaling);
+    case Regs::PixelFormat::RGB5A1:
+        return GetTransferRowFunc<input_format, Regs::PixelFormat::RGB5A1>(scaling);
+    case Regs::PixelFormat::RGBA4:
+        return GetTransferRowFunc<input_format, Regs::PixelFormat::RGBA4>(scaling);
+    default:
+        LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
+                  static_cast<u32>(output_format));
+        return nullptr;
+    }
+}
+
+static TransferRowFunc GetTransferRowFunc(const Regs::DisplayTransferConfig& config) {
+#ifdef ARCHITECTURE_x86_64
+    // Tiled to linear RGBA8 transfers are how every frame gets to the screen
+    if (!config.input_linear && !config.dont_swizzle && config.scaling == config.NoScale &&
+        config.input_format == Regs::PixelFormat::RGBA8) {
+        if (config.output_format == Regs::PixelFormat::RGBA8)
+            return TransferTiledRowRGBA8ToRGBA8;
+        if (config.output_format == Regs::PixelFormat::RGB8)
+            return TransferTiledRowRGBA8ToRGB8;
+    }
+#endif
+
+    switch (config.input_format) {
+    case Regs::PixelFormat::RGBA8:
+        return GetTransferRowFunc<Regs::PixelFormat::RGBA8>(config.output_format, config.scaling);
+    case Regs::PixelFormat::RGB8:
+        return GetTransferRowFunc<Regs::PixelFormat::RGB8>(config.output_format, config.scaling);
+    case Regs::PixelFormat::RGB565:
+        return GetTransferRowFunc<Regs::PixelFormat::RGB565>(config.output_format, config.scaling);
+    case Regs::PixelFormat::RGB5A1:
+        return GetTransferRowFunc<Regs::PixelFormat::RGB5A1>(config.output_format, config.scaling);
+    case Regs::PixelFormat::RGBA4:
+        return GetTransferRowFunc<Regs::PixelFormat::RGBA4>(config.output_format, config.scaling);
+    default:
+        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}",
+                  static_cast<u32>(config.input_format.Value()));
+        return nullptr;
+    }
+}
+
+/// Offset in pixels of column x within its row, in an image made of 8x8 Morton tiles
+static u32 GetTiledColumnOffset(u32 x) {
+    return VideoCore::MortonInterleave(x, 0) + (x & ~7) * 8;
+}
+
+/// Offset in pixels of row y, in an image made of 8x8 Morton tiles
+static u32 GetTiledRowOffset(u32 y, u32 width) {
+    return VideoCore::MortonInterleave(0, y) + (y & ~7) * width;
+}
+
+void ConvertDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src_pointer,
+                            u8* dst_pointer) {
+    const TransferRowFunc transfer_row = GetTransferRowFunc(config);
+    if (transfer_row == nullptr)
+        return;
+
+    int horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    int vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+
+    u32 output_width = config.output_width >> horizontal_scale;
+    u32 output_height = config.output_height >> vertical_scale;
+
+    u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
+    u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
+
+    // If the input is linear, the output is tiled unless dont_swizzle is set, and vice versa.
+    // dont_swizzle makes the output use the same layout as the input.
+    const bool input_tiled = !config.input_linear;
+    const bool output_tiled = config.input_linear != config.dont_swizzle;
+
+    std::vector<u32> src_columns(output_width);
+    std::vector<u32> dst_columns(output_width);
+    for (u32 x = 0; x < output_width; ++x) {
+        // Calculate the x position of the input image based on the output position and the scale
+        u32 input_x = x << horizontal_scale;
+        src_columns[x] =
+            (input_tiled ? GetTiledColumnOffset(input_x) : input_x) * src_bytes_per_pixel;
+        dst_columns[x] = (output_tiled ? GetTiledColumnOffset(x) : x) * dst_bytes_per_pixel;
+    }
+
+    const auto transfer_rows = [&](u32 begin, u32 end) {
+        for (u32 y = begin; y < end; ++y) {
+            u32 input_y = y << vertical_scale;
+
+            // Flip the y value of the output data, we do this after calculating the y position
+            // of the input image to account for the scaling options.
+            u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+            u32 src_offset = (input_tiled ? GetTiledRowOffset(input_y, config.input_width)
+                                          : input_y * config.input_width) *
+                             src_bytes_per_pixel;
+            u32 dst_offset = (output_tiled ? GetTiledRowOffset(output_y, output_width)
+                                           : output_y * output_width) *
+                             dst_bytes_per_pixel;
+            transfer_row(src_pointer + src_offset, dst_pointer + dst_offset, src_columns.data(),
+                         dst_columns.data(), output_width);
+        }
+    };
+
+    // Rows can only be converted out of order if they don't write over each other, which tiles
+    // cut by the end of a row do, and if the transfer doesn't write over its own input.
+    const u8* src_end =
+        src_pointer + config.input_width * config.input_height * src_bytes_per_pixel;
+    const u8* dst_end = dst_pointer + output_width * output_height * dst_bytes_per_pixel;
+    const bool overlapping = (output_tiled && output_width % 8 != 0) ||
+                             (src_pointer < dst_end && dst_pointer < src_end);
+
+    Common::ThreadPool* pool =
+        !overlapping && output_width * output_height >= PARALLEL_DISPLAY_TRANSFER_MIN_PIXELS
+            ? GetDisplayTransferPool()
+            : nullptr;
+    if (pool != nullptr) {
+        const u32 num_chunks =
+            (output_height + PARALLEL_DISPLAY_TRANSFER_ROWS - 1) / PARALLEL_DISPLAY_TRANSFER_ROWS;
+        pool->ParallelFor(num_chunks, [&](size_t chunk) {
+            const u32 begin = static_cast<u32>(chunk) * PARALLEL_DISPLAY_TRANSFER_ROWS;
+            transfer_rows(begin, std::min(begin + PARALLEL_DISPLAY_TRANSFER_ROWS, output_height));
+        });
+    } else {
+        transfer_rows(0, output_height);
     }
 }
 
@@ -187,116 +501,10 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Math::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            u32 input_x = x << horizontal_scale;
-            u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
-
-            u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
-            u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    u32 coarse_y = input_y & ~7;
-                    u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    u32 out_coarse_y = output_y & ~7;
-                    u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    u32 in_coarse_y = input_y & ~7;
-                    u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
-
-            if (!dst_pointer)
-                break;
-
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
-            if (config.scaling == config.ScaleX) {
-                Math::Vec4<u8> pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
-            } else if (config.scaling == config.ScaleXY) {
-                Math::Vec4<u8> pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                Math::Vec4<u8> pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                Math::Vec4<u8> pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
-            }
-
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Regs::PixelFormat::RGBA8:
-                Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB8:
-                Color::EncodeRGB8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB565:
-                Color::EncodeRGB565(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB5A1:
-                Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGBA4:
-                Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
+    if (!dst_pointer)
+        return;
 
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
-                          static_cast<u32>(config.output_format.Value()));
-                break;
-            }
-        }
-    }
+    ConvertDisplayTransfer(config, src_pointer, dst_pointer);
 }
 
 static void TextureCopy(const Regs::DisplayTransferConfig& config) {
@@ -381,6 +589,57 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
     }
 }
 
+void ExecuteMemoryFill(const Regs::MemoryFillConfig& config, bool is_second_filler) {
+    Core::PerfStats::ScopedSubsystemTimer timer{Core::System::GetInstance().perf_stats,
+                                                Core::PerfStats::Subsystem::GPU};
+    MemoryFill(config);
+    LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
+              config.GetEndAddress());
+
+    // It seems that it won't signal interrupt if "address_start" is zero.
+    // TODO: hwtest this
+    if (config.GetStartAddress() != 0) {
+        if (!is_second_filler) {
+            GPUThread::SignalInterrupt(Service::GSP::InterruptId::PSC0);
+        } else {
+            GPUThread::SignalInterrupt(Service::GSP::InterruptId::PSC1);
+        }
+    }
+}
+
+void ExecuteDisplayTransfer(const Regs::DisplayTransferConfig& config) {
+    Core::PerfStats::ScopedSubsystemTimer timer{Core::System::GetInstance().perf_stats,
+                                                Core::PerfStats::Subsystem::GPU};
+    if (config.is_texture_copy) {
+        TextureCopy(config);
+        LOG_TRACE(HW_GPU,
+                  "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
+                  "{:#010X}({}+{}), flags {:#010X}",
+                  config.texture_copy.size, config.GetPhysicalInputAddress(),
+                  config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
+                  config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
+                  config.texture_copy.output_gap * 16, config.flags);
+    } else {
+        DisplayTransfer(config);
+        LOG_TRACE(HW_GPU,
+                  "DisplayTransfer: {:#010X}({}x{})-> "
+                  "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
+                  config.GetPhysicalInputAddress(), config.input_width.Value(),
+                  config.input_height.Value(), config.GetPhysicalOutputAddress(),
+                  config.output_width.Value(), config.output_height.Value(),
+                  static_cast<u32>(config.output_format.Value()), config.flags);
+    }
+
+    GPUThread::SignalInterrupt(Service::GSP::InterruptId::PPF);
+}
+
+void ExecuteCommandList(PAddr address, u32 size) {
+    Core::PerfStats::ScopedSubsystemTimer timer{Core::System::GetInstance().perf_stats,
+                                                Core::PerfStats::Subsystem::GPU};
+    u32* buffer = (u32*)Memory::GetPhysicalPointer(address);
+    Pica::CommandProcessor::ProcessCommandList(buffer, size);
+}
+
 template <typename T>
 inline void Write(u32 addr, const T data) {
     addr -= HW::VADDR_GPU;
@@ -403,18 +662,10 @@ inline void Write(u32 addr, const T data) {
         auto& config = g_regs.memory_fill_config[is_second_filler];
 
         if (config.trigger) {
-            MemoryFill(config);
-            LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
-                      config.GetEndAddress());
-
-            // It seems that it won't signal interrupt if "address_start" is zero.
-            // TODO: hwtest this
-            if (config.GetStartAddress() != 0) {
-                if (!is_second_filler) {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
-                } else {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
-                }
+            if (GPUThread::IsAsync()) {
+                GPUThread::Submit(GPUThread::MemoryFillCommand{config, is_second_filler});
+            } else {
+                ExecuteMemoryFill(config, is_second_filler);
             }
 
             // Reset "trigger" flag and set the "finish" flag
@@ -428,28 +679,13 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX(display_transfer_config.trigger): {
         const auto& config = g_regs.display_transfer_config;
         if (config.trigger & 1) {
-            if (config.is_texture_copy) {
-                TextureCopy(config);
-                LOG_TRACE(HW_GPU,
-                          "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
-                          "{:#010X}({}+{}), flags {:#010X}",
-                          config.texture_copy.size, config.GetPhysicalInputAddress(),
-                          config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
-                          config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
-                          config.texture_copy.output_gap * 16, config.flags);
+            if (GPUThread::IsAsync()) {
+                GPUThread::Submit(GPUThread::DisplayTransferCommand{config});
             } else {
-                DisplayTransfer(config);
-                LOG_TRACE(HW_GPU,
-                          "DisplayTransfer: {:#010X}({}x{})-> "
-                          "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
-                          config.GetPhysicalInputAddress(), config.input_width.Value(),
-                          config.input_height.Value(), config.GetPhysicalOutputAddress(),
-                          config.output_width.Value(), config.output_height.Value(),
-                          static_cast<u32>(config.output_format.Value()), config.flags);
+                ExecuteDisplayTransfer(config);
             }
 
             g_regs.display_transfer_config.trigger = 0;
-            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
         }
         break;
     }
@@ -458,8 +694,12 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX(command_processor_config.trigger): {
         const auto& config = g_regs.command_processor_config;
         if (config.trigger & 1) {
-            u32* buffer = (u32*)Memory::GetPhysicalPointer(config.GetPhysicalAddress());
-            Pica::CommandProcessor::ProcessCommandList(buffer, config.size);
+            if (GPUThread::IsAsync()) {
+                GPUThread::Submit(
+                    GPUThread::ProcessCommandListCommand{config.GetPhysicalAddress(), config.size});
+            } else {
+                ExecuteCommandList(config.GetPhysicalAddress(), config.size);
+            }
             g_regs.command_processor_config.trigger = 0;
         }
         break;
@@ -484,6 +724,8 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
 static void VBlankCallback(u64 userdata, s64 cycles_late) {
+    // Make sure all GPU work queued during this frame has landed in memory before presenting it
+    GPUThread::WaitIdle();
     VideoCore::g_renderer->SwapBuffers();
 
     // Signal to GSP that GPU interrupt has occurred
@@ -536,6 +778,9 @@ void Init() {
 
 /// Shutdown hardware
 void Shutdown() {
+    display_transfer_pool.reset();
+    display_transfer_pool_threads = 1;
+
     LOG_DEBUG(HW_GPU, "shutdown OK");
 }
 
@@ -325,6 +325,22 @@ void Read(T& var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/// Performs a memory fill and raises the matching PSC interrupt
+void ExecuteMemoryFill(const Regs::MemoryFillConfig& config, bool is_second_filler);
+
+/// Performs a display transfer or texture copy and raises the PPF interrupt
+void ExecuteDisplayTransfer(const Regs::DisplayTransferConfig& config);
+
+/**
+ * Converts the image of a display transfer between two host buffers, without touching emulated
+ * memory or the rasterizer caches. The output must not partially overlap the input.
+ */
+void ConvertDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src_pointer,
+                            u8* dst_pointer);
+
+/// Runs the PICA command list located at the given physical address
+void ExecuteCommandList(PAddr address, u32 size);
+
 /// Initialize hardware
 void Init();
 
@@ -0,0 +1,154 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/core_timing.h"
+#include "core/hle/service/gsp/gsp.h"
+#include "core/hw/gpu.h"
+#include "core/hw/gpu_thread.h"
+#include "core/settings.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace GPUThread {
+
+/// Maximum number of commands that may be pending before the emu thread blocks on submission
+constexpr size_t MAX_QUEUED_COMMANDS = 64;
+
+static std::thread gpu_thread;
+static std::thread::id gpu_thread_id;
+
+static std::mutex queue_mutex;
+/// Signalled when a command is queued or the thread is asked to stop
+static std::condition_variable work_available;
+/// Signalled when a command has been dequeued or completed
+static std::condition_variable work_done;
+
+static std::deque<CommandData> queue;
+/// Number of submitted commands that have not completed yet, including the one being executed
+static size_t pending_commands = 0;
+static bool stop_requested = false;
+static bool is_running = false;
+
+/// Event used to deliver interrupts raised on the GPU thread to the emu thread
+static CoreTiming::EventType* interrupt_event;
+
+static void ExecuteCommand(const CommandData& command) {
+    if (const auto* list = std::get_if<ProcessCommandListCommand>(&command)) {
+        GPU::ExecuteCommandList(list->address, list->size);
+    } else if (const auto* fill = std::get_if<MemoryFillCommand>(&command)) {
+        GPU::ExecuteMemoryFill(fill->config, fill->is_second_filler);
+    } else if (const auto* transfer = std::get_if<DisplayTransferCommand>(&command)) {
+        GPU::ExecuteDisplayTransfer(transfer->config);
+    } else {
+        UNREACHABLE();
+    }
+}
+
+static void RunThread() {
+    Common::SetCurrentThreadName("GPUThread");
+
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    while (true) {
+        work_available.wait(lock, [] { return stop_requested || !queue.empty(); });
+        if (queue.empty()) {
+            // Only reached when stopping, as the queue is always drained first
+            break;
+        }
+
+        CommandData command = std::move(queue.front());
+        queue.pop_front();
+        work_done.notify_all();
+
+        lock.unlock();
+        ExecuteCommand(command);
+        lock.lock();
+
+        --pending_commands;
+        work_done.notify_all();
+    }
+}
+
+static void InterruptCallback(u64 userdata, s64 cycles_late) {
+    Service::GSP::SignalInterrupt(static_cast<Service::GSP::InterruptId>(userdata));
+}
+
+void Init() {
+    interrupt_event = CoreTiming::RegisterEvent("GPUThread::InterruptCallback", InterruptCallback);
+
+    if (!Settings::values.use_asynchronous_gpu_emulation) {
+        return;
+    }
+
+    stop_requested = false;
+    pending_commands = 0;
+    is_running = true;
+    gpu_thread = std::thread(RunThread);
+    gpu_thread_id = gpu_thread.get_id();
+
+    LOG_INFO(HW_GPU, "Asynchronous GPU emulation enabled");
+}
+
+void Shutdown() {
+    if (!is_running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stop_requested = true;
+    }
+    work_available.notify_one();
+    gpu_thread.join();
+
+    gpu_thread_id = {};
+    is_running = false;
+}
+
+bool IsAsync() {
+    // The rasterizer is only ever swapped out during SwapBuffers, which happens after the queue has
+    // been drained, so checking it here is consistent with the work already in flight.
+    return is_running && !VideoCore::g_renderer->IsOpenGLRasterizerActive();
+}
+
+bool IsGPUThread() {
+    return is_running && std::this_thread::get_id() == gpu_thread_id;
+}
+
+void Submit(CommandData command) {
+    DEBUG_ASSERT(is_running && !IsGPUThread());
+
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        work_done.wait(lock, [] { return queue.size() < MAX_QUEUED_COMMANDS; });
+        queue.emplace_back(std::move(command));
+        ++pending_commands;
+    }
+    work_available.notify_one();
+}
+
+void WaitIdle() {
+    if (!is_running || IsGPUThread()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    work_done.wait(lock, [] { return pending_commands == 0; });
+}
+
+void SignalInterrupt(Service::GSP::InterruptId interrupt_id) {
+    if (IsGPUThread()) {
+        CoreTiming::ScheduleEventThreadsafe(0, interrupt_event, static_cast<u64>(interrupt_id));
+    } else {
+        Service::GSP::SignalInterrupt(interrupt_id);
+    }
+}
+
+} // namespace GPUThread
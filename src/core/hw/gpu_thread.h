@@ -0,0 +1,86 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <variant>
+#include "common/common_types.h"
+#include "core/hw/gpu.h"
+
+namespace Service::GSP {
+enum class InterruptId : u8;
+} // namespace Service::GSP
+
+/**
+ * Optional worker thread that takes PICA command list processing, memory fills and display
+ * transfers off the emu thread. The emu thread only latches the GPU registers and queues the
+ * work; the GPU thread executes it in submission order.
+ *
+ * Synchronization rules:
+ * - GSP interrupts raised by queued work are delivered to the emu thread through a threadsafe
+ *   CoreTiming event once the work has completed, mirroring real hardware where the CPU learns
+ *   about GPU progress only through interrupts.
+ * - Every Memory::Rasterizer*Region call made from outside the GPU thread drains the queue first,
+ *   so CPU-side accesses to GPU-owned memory observe all previously submitted work.
+ * - The queue is drained on every VBlank before the frame is presented.
+ *
+ * The worker is only used while the software rasterizer is active, since the OpenGL rasterizer
+ * needs the GL context that is current on the emu thread.
+ */
+namespace GPUThread {
+
+/// Process a PICA command list located at the given physical address
+struct ProcessCommandListCommand {
+    PAddr address;
+    u32 size;
+};
+
+/// Perform a memory fill using a snapshot of one of the fill register blocks
+struct MemoryFillCommand {
+    GPU::Regs::MemoryFillConfig config;
+    bool is_second_filler;
+};
+
+/// Perform a display transfer or texture copy using a snapshot of the transfer registers
+struct DisplayTransferCommand {
+    GPU::Regs::DisplayTransferConfig config;
+};
+
+using CommandData =
+    std::variant<ProcessCommandListCommand, MemoryFillCommand, DisplayTransferCommand>;
+
+/// Starts the GPU thread if asynchronous GPU emulation is enabled in the settings
+void Init();
+
+/// Drains any pending work and stops the GPU thread
+void Shutdown();
+
+/**
+ * Returns whether GPU work should be queued to the GPU thread rather than executed inline.
+ * Must only be called from the emu thread.
+ */
+bool IsAsync();
+
+/// Returns whether the caller is running on the GPU thread
+bool IsGPUThread();
+
+/**
+ * Queues a command for the GPU thread. Blocks while the queue is full.
+ * Must only be called from the emu thread while IsAsync() returns true.
+ */
+void Submit(CommandData command);
+
+/**
+ * Blocks until all submitted work has completed. This is a no-op when the GPU thread is not
+ * running or when called from the GPU thread itself.
+ */
+void WaitIdle();
+
+/**
+ * Signals a GSP interrupt. When called from the GPU thread the interrupt is forwarded to the emu
+ * thread, otherwise it is signalled immediately.
+ */
+void SignalInterrupt(Service::GSP::InterruptId interrupt_id);
+
+} // namespace GPUThread
@@ -5,15 +5,21 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
+#include "core/hle/kernel/process.h"
 #include "core/hle/service/y2r_u.h"
 #include "core/hw/y2r.h"
 #include "core/memory.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace HW::Y2R {
 
 using namespace Service::Y2R;
@@ -22,120 +28,248 @@ static const size_t MAX_TILES = 1024 / 8;
 static const size_t TILE_SIZE = 8 * 8;
 using ImageTile = std::array<u32, TILE_SIZE>;
 
-/// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles.
-static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
-                            const u8* input_V, ImageTile output[], unsigned int width,
-                            unsigned int height, const CoefficientSet& coefficients) {
+/// Size in bytes of an input sample. 16-bit formats only use the LSB of each sample.
+static constexpr size_t InputSampleSize(InputFormat format) {
+    return format == InputFormat::YUV422_Indiv16 || format == InputFormat::YUV420_Indiv16 ? 2 : 1;
+}
+
+static constexpr size_t OutputPixelSize(OutputFormat format) {
+    switch (format) {
+    case OutputFormat::RGBA8:
+        return 4;
+    case OutputFormat::RGB8:
+        return 3;
+    case OutputFormat::RGB5A1:
+    case OutputFormat::RGB565:
+        return 2;
+    }
+    return 0;
+}
+
+/// Converts a single pixel to RGB32.
+static u32 ConvertPixel(s32 Y, s32 U, s32 V, const CoefficientSet& c) {
+    // This conversion process is bit-exact with hardware, as far as could be tested.
+    s32 cY = c[0] * Y;
+
+    s32 r = cY + c[1] * V;
+    s32 g = cY - c[2] * V - c[3] * U;
+    s32 b = cY + c[4] * U;
+
+    const s32 rounding_offset = 0x18;
+    r = (r >> 3) + c[5] + rounding_offset;
+    g = (g >> 3) + c[6] + rounding_offset;
+    b = (b >> 3) + c[7] + rounding_offset;
+
+    return ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) | ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
+           ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+/// Coefficients laid out for _mm_madd_epi16, which multiplies pairs of 16-bit lanes and sums them
+struct SSECoefficients {
+    explicit SSECoefficients(const CoefficientSet& c)
+        : r(Pair(c[0], c[1])), g(Pair(c[0], c[2])), g_U(Pair(c[3], 0)), b(Pair(c[0], c[4])),
+          offset_r(_mm_set1_epi32(c[5] + rounding_offset)),
+          offset_g(_mm_set1_epi32(c[6] + rounding_offset)),
+          offset_b(_mm_set1_epi32(c[7] + rounding_offset)) {}
+
+    static __m128i Pair(s16 low, s16 high) {
+        return _mm_set1_epi32(static_cast<u16>(low) |
+                              static_cast<u32>(static_cast<u16>(high)) << 16);
+    }
+
+    static constexpr s32 rounding_offset = 0x18;
+
+    __m128i r, g, g_U, b;
+    __m128i offset_r, offset_g, offset_b;
+};
+
+/// Scales and offsets one channel of 4 pixels, like ConvertPixel does before clamping
+static __m128i FinishChannel(__m128i sum, __m128i offset) {
+    return _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(sum, 3), offset), 5);
+}
+
+/**
+ * Converts a row of 8 pixels, given as one 16-bit lane per pixel and component, to RGB32. Every
+ * product is summed in 32-bit lanes, so the result is the same as ConvertPixel's. Subtracted terms
+ * are computed by negating the samples rather than the coefficients, which could overflow.
+ */
+static void ConvertRowSSE2(__m128i Y, __m128i U, __m128i V, u32* output,
+                           const SSECoefficients& c) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i neg_U = _mm_sub_epi16(zero, U);
+    const __m128i neg_V = _mm_sub_epi16(zero, V);
+
+    const __m128i r_lo = _mm_madd_epi16(_mm_unpacklo_epi16(Y, V), c.r);
+    const __m128i r_hi = _mm_madd_epi16(_mm_unpackhi_epi16(Y, V), c.r);
+    const __m128i g_lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(Y, neg_V), c.g),
+                                       _mm_madd_epi16(_mm_unpacklo_epi16(neg_U, zero), c.g_U));
+    const __m128i g_hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(Y, neg_V), c.g),
+                                       _mm_madd_epi16(_mm_unpackhi_epi16(neg_U, zero), c.g_U));
+    const __m128i b_lo = _mm_madd_epi16(_mm_unpacklo_epi16(Y, U), c.b);
+    const __m128i b_hi = _mm_madd_epi16(_mm_unpackhi_epi16(Y, U), c.b);
+
+    // Saturating to 16 and then 8 bits clamps the channels to [0, 255]
+    const __m128i r = _mm_packs_epi32(FinishChannel(r_lo, c.offset_r),
+                                      FinishChannel(r_hi, c.offset_r));
+    const __m128i g = _mm_packs_epi32(FinishChannel(g_lo, c.offset_g),
+                                      FinishChannel(g_hi, c.offset_g));
+    const __m128i b = _mm_packs_epi32(FinishChannel(b_lo, c.offset_b),
+                                      FinishChannel(b_hi, c.offset_b));
+    const __m128i rg = _mm_packus_epi16(r, g);
+    const __m128i b8 = _mm_packus_epi16(b, b);
+
+    // Interleave into 0xRRGGBB00 words
+    const __m128i low = _mm_unpacklo_epi8(zero, b8);
+    const __m128i high = _mm_unpacklo_epi8(_mm_srli_si128(rg, 8), rg);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi16(low, high));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 4), _mm_unpackhi_epi16(low, high));
+}
+
+#endif // ARCHITECTURE_x86_64
+
+/**
+ * Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles. Each tile row
+ * of 8 pixels is converted at once. 16-bit formats are narrowed to 8-bit as they are received, so
+ * they use the same code as their 8-bit counterparts.
+ */
+template <InputFormat input_format>
+static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V,
+                            ImageTile output[], unsigned int width, unsigned int height,
+                            const CoefficientSet& coefficients) {
+#ifdef ARCHITECTURE_x86_64
+    const SSECoefficients sse_coefficients(coefficients);
+    const __m128i zero = _mm_setzero_si128();
+#endif
 
     for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            s32 Y = 0;
-            s32 U = 0;
-            s32 V = 0;
-            switch (input_format) {
-            case InputFormat::YUV422_Indiv8:
-            case InputFormat::YUV422_Indiv16:
-                Y = input_Y[y * width + x];
-                U = input_U[(y * width + x) / 2];
-                V = input_V[(y * width + x) / 2];
-                break;
-            case InputFormat::YUV420_Indiv8:
-            case InputFormat::YUV420_Indiv16:
-                Y = input_Y[y * width + x];
-                U = input_U[((y / 2) * width + x) / 2];
-                V = input_V[((y / 2) * width + x) / 2];
-                break;
-            case InputFormat::YUYV422_Interleaved:
-                Y = input_Y[(y * width + x) * 2];
-                U = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
-                V = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
-                break;
+        for (unsigned int x = 0; x < width; x += 8) {
+            const size_t pixel = y * width + x;
+            u32* out = &output[x / 8][y * 8];
+
+            if (input_format == InputFormat::YUYV422_Interleaved) {
+                const u8* row = input_Y + pixel * 2;
+#ifdef ARCHITECTURE_x86_64
+                // Each 16-bit lane holds a Y sample, with U or V in the high byte
+                const __m128i yuyv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+                const __m128i chroma = _mm_srli_epi16(yuyv, 8);
+                const __m128i Y = _mm_and_si128(yuyv, _mm_set1_epi16(0xFF));
+                const __m128i U = _mm_shufflehi_epi16(
+                    _mm_shufflelo_epi16(chroma, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+                const __m128i V = _mm_shufflehi_epi16(
+                    _mm_shufflelo_epi16(chroma, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+                ConvertRowSSE2(Y, U, V, out, sse_coefficients);
+#else
+                for (unsigned int i = 0; i < 8; ++i) {
+                    out[i] = ConvertPixel(row[i * 2], row[(i / 2) * 4 + 1], row[(i / 2) * 4 + 3],
+                                          coefficients);
+                }
+#endif
+                continue;
             }
 
-            // This conversion process is bit-exact with hardware, as far as could be tested.
-            auto& c = coefficients;
-            s32 cY = c[0] * Y;
-
-            s32 r = cY + c[1] * V;
-            s32 g = cY - c[2] * V - c[3] * U;
-            s32 b = cY + c[4] * U;
-
-            const s32 rounding_offset = 0x18;
-            r = (r >> 3) + c[5] + rounding_offset;
-            g = (g >> 3) + c[6] + rounding_offset;
-            b = (b >> 3) + c[7] + rounding_offset;
-
-            unsigned int tile = x / 8;
-            unsigned int tile_x = x % 8;
-            u32* out = &output[tile][y * 8 + tile_x];
-            *out = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
-                   ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
-                   ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+            const size_t chroma_offset = input_format == InputFormat::YUV420_Indiv8
+                                             ? ((y / 2) * width + x) / 2
+                                             : pixel / 2;
+            const u8* row_Y = input_Y + pixel;
+            const u8* row_U = input_U + chroma_offset;
+            const u8* row_V = input_V + chroma_offset;
+#ifdef ARCHITECTURE_x86_64
+            // Each chroma sample covers two pixels
+            u32 samples_U, samples_V;
+            std::memcpy(&samples_U, row_U, sizeof(u32));
+            std::memcpy(&samples_V, row_V, sizeof(u32));
+            const __m128i U = _mm_cvtsi32_si128(static_cast<int>(samples_U));
+            const __m128i V = _mm_cvtsi32_si128(static_cast<int>(samples_V));
+            ConvertRowSSE2(
+                _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row_Y)), zero),
+                _mm_unpacklo_epi8(_mm_unpacklo_epi8(U, U), zero),
+                _mm_unpacklo_epi8(_mm_unpacklo_epi8(V, V), zero), out, sse_coefficients);
+#else
+            for (unsigned int i = 0; i < 8; ++i) {
+                out[i] = ConvertPixel(row_Y[i], row_U[i / 2], row_V[i / 2], coefficients);
+            }
+#endif
         }
     }
 }
 
-/// Simulates an incoming CDMA transfer. The N parameter is used to automatically convert 16-bit
-/// formats to 8-bit.
-template <size_t N>
-static void ReceiveData(u8* output, ConversionBuffer& buf, size_t amount_of_data) {
-    const u8* input = Memory::GetPointer(buf.address);
+static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
+                            const u8* input_V, ImageTile output[], unsigned int width,
+                            unsigned int height, const CoefficientSet& coefficients) {
+    switch (input_format) {
+    case InputFormat::YUV422_Indiv8:
+    case InputFormat::YUV422_Indiv16:
+        ConvertYUVToRGB<InputFormat::YUV422_Indiv8>(input_Y, input_U, input_V, output, width,
+                                                    height, coefficients);
+        break;
+    case InputFormat::YUV420_Indiv8:
+    case InputFormat::YUV420_Indiv16:
+        ConvertYUVToRGB<InputFormat::YUV420_Indiv8>(input_Y, input_U, input_V, output, width,
+                                                    height, coefficients);
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        ConvertYUVToRGB<InputFormat::YUYV422_Interleaved>(input_Y, input_U, input_V, output, width,
+                                                          height, coefficients);
+        break;
+    }
+}
+
+/// Advances a buffer past a number of DMA transfers, like the hardware does as it transfers them.
+static void AdvanceBuffer(ConversionBuffer& buf, size_t num_transfers) {
+    buf.address += static_cast<VAddr>(num_transfers * (buf.transfer_unit + buf.gap));
+    buf.image_size -= static_cast<u32>(num_transfers * buf.transfer_unit);
+}
 
+/**
+ * Simulates an incoming CDMA transfer from a copy of the source data, which holds the transfers
+ * back to back. The N parameter is used to automatically convert 16-bit formats to 8-bit.
+ * @param input Position in the copied source data, advanced past the received data
+ * @param output Buffer to narrow 16-bit data into. 8-bit data is used in place instead.
+ * @returns Pointer to the received 8-bit data
+ */
+template <size_t N>
+static const u8* ReceiveData(const u8*& input, u8* output, const ConversionBuffer& buf,
+                             size_t amount_of_data) {
     size_t output_unit = buf.transfer_unit / N;
     ASSERT(amount_of_data % output_unit == 0);
-
-    while (amount_of_data > 0) {
-        for (size_t i = 0; i < output_unit; ++i) {
-            output[i] = input[i * N];
+    const size_t num_transfers = amount_of_data / output_unit;
+
+    const u8* received = input;
+    if (N == 1) {
+        input += num_transfers * buf.transfer_unit;
+    } else {
+        received = output;
+        for (size_t transfer = 0; transfer < num_transfers; ++transfer) {
+            for (size_t i = 0; i < output_unit; ++i) {
+                output[i] = input[i * N];
+            }
+            output += output_unit;
+            input += buf.transfer_unit;
         }
-
-        output += output_unit;
-        input += buf.transfer_unit + buf.gap;
-
-        buf.address += buf.transfer_unit + buf.gap;
-        buf.image_size -= buf.transfer_unit;
-        amount_of_data -= output_unit;
     }
-}
 
-/// Convert intermediate RGB32 format to the final output format while simulating an outgoing CDMA
-/// transfer.
-static void SendData(const u32* input, ConversionBuffer& buf, int amount_of_data,
-                     OutputFormat output_format, u8 alpha) {
-
-    u8* output = Memory::GetPointer(buf.address);
-
-    while (amount_of_data > 0) {
-        u8* unit_end = output + buf.transfer_unit;
-        while (output < unit_end) {
-            u32 color = *input++;
-            Math::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
-
-            switch (output_format) {
-            case OutputFormat::RGBA8:
-                Color::EncodeRGBA8(col_vec, output);
-                output += 4;
-                break;
-            case OutputFormat::RGB8:
-                Color::EncodeRGB8(col_vec, output);
-                output += 3;
-                break;
-            case OutputFormat::RGB5A1:
-                Color::EncodeRGB5A1(col_vec, output);
-                output += 2;
-                break;
-            case OutputFormat::RGB565:
-                Color::EncodeRGB565(col_vec, output);
-                output += 2;
-                break;
-            }
+    return received;
+}
 
-            amount_of_data -= 1;
-        }
+template <OutputFormat output_format>
+static void EncodePixel(u32 color, u8 alpha, u8* output) {
+    Math::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
 
-        output += buf.gap;
-        buf.address += buf.transfer_unit + buf.gap;
-        buf.image_size -= buf.transfer_unit;
+    switch (output_format) {
+    case OutputFormat::RGBA8:
+        Color::EncodeRGBA8(col_vec, output);
+        break;
+    case OutputFormat::RGB8:
+        Color::EncodeRGB8(col_vec, output);
+        break;
+    case OutputFormat::RGB5A1:
+        Color::EncodeRGB5A1(col_vec, output);
+        break;
+    case OutputFormat::RGB565:
+        Color::EncodeRGB565(col_vec, output);
+        break;
     }
 }
 
@@ -165,46 +299,215 @@ static const u8 morton_lut[TILE_SIZE] = {
     // clang-format on
 };
 
-static void RotateTile0(const ImageTile& input, ImageTile& output, int height,
-                        const u8 out_map[64]) {
-    for (int i = 0; i < height * 8; ++i) {
-        output[out_map[i]] = input[i];
+/**
+ * Rotates the tiles of a strip, lays them out linearly or in 8x8 blocks and encodes them to the
+ * output format, all in a single pass. The order in which the pixels of a tile are read and where
+ * they are written only depends on the strip configuration, so it is computed once per strip.
+ */
+template <OutputFormat output_format>
+static void EncodeStrip(const ImageTile tiles[], size_t num_tiles,
+                        const ConversionConfiguration& cvt, unsigned int row_height, u8* output) {
+    constexpr size_t pixel_size = OutputPixelSize(output_format);
+
+    // LUT used to remap writes to a tile. Used to allow linear or swizzled output without
+    // requiring two different code paths.
+    const u8* tile_remap = nullptr;
+    // Distances in pixels between the lines of a tile and between tiles in the output
+    size_t line_stride = 0;
+    size_t tile_stride = 0;
+    const bool transposed =
+        cvt.rotation == Rotation::Clockwise_90 || cvt.rotation == Rotation::Clockwise_270;
+
+    switch (cvt.block_alignment) {
+    case BlockAlignment::Linear:
+        tile_remap = linear_lut;
+        line_stride = transposed ? 8 : cvt.input_line_width;
+        tile_stride = transposed ? 8 * row_height : 8;
+        break;
+    case BlockAlignment::Block8x8:
+        tile_remap = morton_lut;
+        line_stride = 8;
+        tile_stride = TILE_SIZE;
+        break;
     }
-}
 
-static void RotateTile90(const ImageTile& input, ImageTile& output, int height,
-                         const u8 out_map[64]) {
+    // Index in the source tile of each pixel in output order
+    std::array<u8, TILE_SIZE> source;
+    const int height = static_cast<int>(row_height);
     int out_i = 0;
-    for (int x = 0; x < 8; ++x) {
-        for (int y = height - 1; y >= 0; --y) {
-            output[out_map[out_i++]] = input[y * 8 + x];
+    switch (cvt.rotation) {
+    case Rotation::None:
+        for (int i = 0; i < height * 8; ++i) {
+            source[out_i++] = static_cast<u8>(i);
+        }
+        break;
+    case Rotation::Clockwise_90:
+        for (int x = 0; x < 8; ++x) {
+            for (int y = height - 1; y >= 0; --y) {
+                source[out_i++] = static_cast<u8>(y * 8 + x);
+            }
+        }
+        break;
+    case Rotation::Clockwise_180:
+        for (int i = height * 8 - 1; i >= 0; --i) {
+            source[out_i++] = static_cast<u8>(i);
+        }
+        break;
+    case Rotation::Clockwise_270:
+        for (int x = 8 - 1; x >= 0; --x) {
+            for (int y = 0; y < height; ++y) {
+                source[out_i++] = static_cast<u8>(y * 8 + x);
+            }
+        }
+        break;
+    }
+
+    // Offset in bytes from the start of the tile in the output of each pixel in output order
+    std::array<u32, TILE_SIZE> destination;
+    for (int i = 0; i < out_i; ++i) {
+        const u8 position = tile_remap[i];
+        destination[i] =
+            static_cast<u32>(((position / 8) * line_stride + position % 8) * pixel_size);
+    }
+
+    // For 180 and 270 degree rotations we also invert the order of tiles in the strip, since the
+    // rotates are done individually on each tile.
+    const bool reversed =
+        cvt.rotation == Rotation::Clockwise_180 || cvt.rotation == Rotation::Clockwise_270;
+    const u8 alpha = static_cast<u8>(cvt.alpha);
+
+    for (size_t i = 0; i < num_tiles; ++i) {
+        const ImageTile& tile = tiles[reversed ? num_tiles - i - 1 : i];
+        u8* tile_output = output + i * tile_stride * pixel_size;
+        for (int j = 0; j < out_i; ++j) {
+            EncodePixel<output_format>(tile[source[j]], alpha, tile_output + destination[j]);
         }
     }
 }
 
-static void RotateTile180(const ImageTile& input, ImageTile& output, int height,
-                          const u8 out_map[64]) {
-    int out_i = 0;
-    for (int i = height * 8 - 1; i >= 0; --i) {
-        output[out_map[out_i++]] = input[i];
+static void EncodeStrip(const ImageTile tiles[], size_t num_tiles,
+                        const ConversionConfiguration& cvt, unsigned int row_height, u8* output) {
+    switch (cvt.output_format) {
+    case OutputFormat::RGBA8:
+        EncodeStrip<OutputFormat::RGBA8>(tiles, num_tiles, cvt, row_height, output);
+        break;
+    case OutputFormat::RGB8:
+        EncodeStrip<OutputFormat::RGB8>(tiles, num_tiles, cvt, row_height, output);
+        break;
+    case OutputFormat::RGB5A1:
+        EncodeStrip<OutputFormat::RGB5A1>(tiles, num_tiles, cvt, row_height, output);
+        break;
+    case OutputFormat::RGB565:
+        EncodeStrip<OutputFormat::RGB565>(tiles, num_tiles, cvt, row_height, output);
+        break;
     }
 }
 
-static void RotateTile270(const ImageTile& input, ImageTile& output, int height,
-                          const u8 out_map[64]) {
-    int out_i = 0;
-    for (int x = 8 - 1; x >= 0; --x) {
-        for (int y = 0; y < height; ++y) {
-            output[out_map[out_i++]] = input[y * 8 + x];
-        }
+/// Size in bytes of the DMA out of a strip. Whole transfers are sent, even if the last one
+/// overruns the strip.
+static size_t StripOutputSize(const ConversionConfiguration& cvt, unsigned int row_height) {
+    const size_t transfer_unit = cvt.dst.transfer_unit;
+    ASSERT(transfer_unit != 0);
+    const size_t size = row_height * cvt.input_line_width * OutputPixelSize(cvt.output_format);
+    return (size + transfer_unit - 1) / transfer_unit * transfer_unit;
+}
+
+/**
+ * Copies the data a source buffer sends over a whole conversion, leaving out the gaps.
+ * @param num_samples Number of samples the conversion receives from the buffer
+ */
+static std::vector<u8> ReadSource(const Kernel::Process& process, const ConversionBuffer& buf,
+                                  size_t num_samples, size_t sample_size, size_t padding) {
+    const size_t output_unit = buf.transfer_unit / sample_size;
+    ASSERT(output_unit != 0);
+    const size_t num_transfers = (num_samples + output_unit - 1) / output_unit;
+    const size_t size = num_transfers * buf.transfer_unit;
+
+    std::vector<u8> data(size + padding);
+    if (buf.gap == 0) {
+        Memory::ReadBlock(process, buf.address, data.data(), size);
+        return data;
     }
+    for (size_t i = 0; i < num_transfers; ++i) {
+        const VAddr address = buf.address + static_cast<VAddr>(i * (buf.transfer_unit + buf.gap));
+        Memory::ReadBlock(process, address, data.data() + i * buf.transfer_unit,
+                          buf.transfer_unit);
+    }
+    return data;
 }
 
-static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, int line_stride) {
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            output[y * line_stride + x] = tile[y * 8 + x];
+void AdvanceBuffers(ConversionConfiguration& cvt) {
+    const size_t sample_size = InputSampleSize(cvt.input_format);
+    const auto advance_input = [sample_size](ConversionBuffer& buf, size_t num_samples) {
+        AdvanceBuffer(buf, num_samples / (buf.transfer_unit / sample_size));
+    };
+
+    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
+        const unsigned int row_height = std::min(cvt.input_lines - y, 8u);
+        const size_t row_data_size = row_height * cvt.input_line_width;
+
+        switch (cvt.input_format) {
+        case InputFormat::YUV422_Indiv8:
+        case InputFormat::YUV422_Indiv16:
+            advance_input(cvt.src_Y, row_data_size);
+            advance_input(cvt.src_U, row_data_size / 2);
+            advance_input(cvt.src_V, row_data_size / 2);
+            break;
+        case InputFormat::YUV420_Indiv8:
+        case InputFormat::YUV420_Indiv16:
+            advance_input(cvt.src_Y, row_data_size);
+            advance_input(cvt.src_U, row_data_size / 4);
+            advance_input(cvt.src_V, row_data_size / 4);
+            break;
+        case InputFormat::YUYV422_Interleaved:
+            advance_input(cvt.src_YUYV, row_data_size * 2);
+            break;
         }
+
+        AdvanceBuffer(cvt.dst, StripOutputSize(cvt, row_height) / cvt.dst.transfer_unit);
+    }
+}
+
+Conversion::Conversion(const ConversionConfiguration& config) : config(config) {}
+
+void Conversion::ReadInput(const Kernel::Process& process) {
+    const ConversionConfiguration& cvt = config;
+    const size_t num_pixels = cvt.input_lines * cvt.input_line_width;
+    const size_t sample_size = InputSampleSize(cvt.input_format);
+    // With 4:2:0 subsampling and an odd number of lines, the last line reads chroma samples past
+    // the received ones. This keeps it within the copy.
+    const size_t padding = cvt.input_line_width;
+
+    switch (cvt.input_format) {
+    case InputFormat::YUV422_Indiv8:
+    case InputFormat::YUV422_Indiv16:
+        src_Y = ReadSource(process, cvt.src_Y, num_pixels, sample_size, padding);
+        src_U = ReadSource(process, cvt.src_U, num_pixels / 2, sample_size, padding);
+        src_V = ReadSource(process, cvt.src_V, num_pixels / 2, sample_size, padding);
+        break;
+    case InputFormat::YUV420_Indiv8:
+    case InputFormat::YUV420_Indiv16:
+        src_Y = ReadSource(process, cvt.src_Y, num_pixels, sample_size, padding);
+        src_U = ReadSource(process, cvt.src_U, num_pixels / 4, sample_size, padding);
+        src_V = ReadSource(process, cvt.src_V, num_pixels / 4, sample_size, padding);
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        src_YUYV = ReadSource(process, cvt.src_YUYV, num_pixels * 2, sample_size, padding);
+        break;
+    }
+}
+
+void Conversion::WriteOutput(const Kernel::Process& process) const {
+    const ConversionBuffer& buf = config.dst;
+    if (buf.gap == 0) {
+        Memory::WriteBlock(process, buf.address, dst.data(), dst.size());
+        return;
+    }
+    const size_t num_transfers = dst.size() / buf.transfer_unit;
+    for (size_t i = 0; i < num_transfers; ++i) {
+        const VAddr address = buf.address + static_cast<VAddr>(i * (buf.transfer_unit + buf.gap));
+        Memory::WriteBlock(process, address, dst.data() + i * buf.transfer_unit,
+                           buf.transfer_unit);
     }
 }
 
@@ -243,8 +546,12 @@ static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, in
  *
  * In this implementation, to avoid the combinatorial explosion of parameter combinations, common
  * intermediate formats are used and where possible tables or parameters are used instead of
- * diverging code paths to keep the amount of branches in check. Some steps are also merged to
- * increase efficiency.
+ * diverging code paths to keep the amount of branches in check. The input and output formats are
+ * template parameters of the decoding and encoding steps, so that their dispatch happens once per
+ * strip, and rotation, block alignment and output encoding are merged into a single pass.
+ *
+ * The DMA transfers are simulated on copies of guest memory made by ReadInput, and the output is
+ * only copied back by WriteOutput, so this function doesn't touch guest memory.
  *
  * Output for all valid settings combinations matches hardware, however output in some edge-cases
  * differs:
@@ -258,30 +565,30 @@ static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, in
  * Hardware behaves strangely (doesn't fire the completion interrupt, for example) in these cases,
  * so they are believed to be invalid configurations anyway.
  */
-void PerformConversion(ConversionConfiguration& cvt) {
+void Conversion::Perform() {
+    const ConversionConfiguration& cvt = config;
     ASSERT(cvt.input_line_width % 8 == 0);
     ASSERT(cvt.block_alignment != BlockAlignment::Block8x8 || cvt.input_lines % 8 == 0);
     // Tiles per row
     size_t num_tiles = cvt.input_line_width / 8;
     ASSERT(num_tiles <= MAX_TILES);
 
-    // Buffer used as a CDMA source/target.
-    std::unique_ptr<u8[]> data_buffer(new u8[cvt.input_line_width * 8 * 4]);
+    size_t output_size = 0;
+    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
+        output_size += StripOutputSize(cvt, std::min(cvt.input_lines - y, 8u));
+    }
+    dst.assign(output_size, 0);
+
+    // Buffer 16-bit input is narrowed into as it is received.
+    std::unique_ptr<u8[]> data_buffer(new u8[cvt.input_line_width * 8 * 2]);
     // Intermediate storage for decoded 8x8 image tiles. Always stored as RGB32.
     std::unique_ptr<ImageTile[]> tiles(new ImageTile[num_tiles]);
-    ImageTile tmp_tile;
 
-    // LUT used to remap writes to a tile. Used to allow linear or swizzled output without
-    // requiring two different code paths.
-    const u8* tile_remap = nullptr;
-    switch (cvt.block_alignment) {
-    case BlockAlignment::Linear:
-        tile_remap = linear_lut;
-        break;
-    case BlockAlignment::Block8x8:
-        tile_remap = morton_lut;
-        break;
-    }
+    const u8* next_Y = src_Y.data();
+    const u8* next_U = src_U.data();
+    const u8* next_V = src_V.data();
+    const u8* next_YUYV = src_YUYV.data();
+    u8* next_output = dst.data();
 
     for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
         unsigned int row_height = std::min(cvt.input_lines - y, 8u);
@@ -289,90 +596,45 @@ void PerformConversion(ConversionConfiguration& cvt) {
         // Total size in pixels of incoming data required for this strip.
         const size_t row_data_size = row_height * cvt.input_line_width;
 
-        u8* input_Y = data_buffer.get();
-        u8* input_U = input_Y + 8 * cvt.input_line_width;
-        u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+        u8* buffer_Y = data_buffer.get();
+        u8* buffer_U = buffer_Y + 8 * cvt.input_line_width;
+        u8* buffer_V = buffer_U + 8 * cvt.input_line_width / 2;
+        const u8* input_Y = nullptr;
+        const u8* input_U = nullptr;
+        const u8* input_V = nullptr;
 
         switch (cvt.input_format) {
         case InputFormat::YUV422_Indiv8:
-            ReceiveData<1>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<1>(input_V, cvt.src_V, row_data_size / 2);
+            input_Y = ReceiveData<1>(next_Y, buffer_Y, cvt.src_Y, row_data_size);
+            input_U = ReceiveData<1>(next_U, buffer_U, cvt.src_U, row_data_size / 2);
+            input_V = ReceiveData<1>(next_V, buffer_V, cvt.src_V, row_data_size / 2);
             break;
         case InputFormat::YUV420_Indiv8:
-            ReceiveData<1>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<1>(input_V, cvt.src_V, row_data_size / 4);
+            input_Y = ReceiveData<1>(next_Y, buffer_Y, cvt.src_Y, row_data_size);
+            input_U = ReceiveData<1>(next_U, buffer_U, cvt.src_U, row_data_size / 4);
+            input_V = ReceiveData<1>(next_V, buffer_V, cvt.src_V, row_data_size / 4);
             break;
         case InputFormat::YUV422_Indiv16:
-            ReceiveData<2>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<2>(input_V, cvt.src_V, row_data_size / 2);
+            input_Y = ReceiveData<2>(next_Y, buffer_Y, cvt.src_Y, row_data_size);
+            input_U = ReceiveData<2>(next_U, buffer_U, cvt.src_U, row_data_size / 2);
+            input_V = ReceiveData<2>(next_V, buffer_V, cvt.src_V, row_data_size / 2);
             break;
         case InputFormat::YUV420_Indiv16:
-            ReceiveData<2>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<2>(input_V, cvt.src_V, row_data_size / 4);
+            input_Y = ReceiveData<2>(next_Y, buffer_Y, cvt.src_Y, row_data_size);
+            input_U = ReceiveData<2>(next_U, buffer_U, cvt.src_U, row_data_size / 4);
+            input_V = ReceiveData<2>(next_V, buffer_V, cvt.src_V, row_data_size / 4);
             break;
         case InputFormat::YUYV422_Interleaved:
-            input_U = nullptr;
-            input_V = nullptr;
-            ReceiveData<1>(input_Y, cvt.src_YUYV, row_data_size * 2);
+            input_Y = ReceiveData<1>(next_YUYV, buffer_Y, cvt.src_YUYV, row_data_size * 2);
             break;
         }
 
-        // Note(yuriks): If additional optimization is required, input_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
         ConvertYUVToRGB(cvt.input_format, input_Y, input_U, input_V, tiles.get(),
                         cvt.input_line_width, row_height, cvt.coefficients);
 
-        u32* output_buffer = reinterpret_cast<u32*>(data_buffer.get());
-
-        for (size_t i = 0; i < num_tiles; ++i) {
-            int image_strip_width = 0;
-            int output_stride = 0;
-
-            switch (cvt.rotation) {
-            case Rotation::None:
-                RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_90:
-                RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            case Rotation::Clockwise_180:
-                // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
-                // since the rotates are done individually on each tile.
-                RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_270:
-                RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            }
-
-            switch (cvt.block_alignment) {
-            case BlockAlignment::Linear:
-                WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
-                output_buffer += output_stride;
-                break;
-            case BlockAlignment::Block8x8:
-                WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
-                output_buffer += TILE_SIZE;
-                break;
-            }
-        }
-
-        // Note(yuriks): If additional optimization is required, output_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        SendData(reinterpret_cast<u32*>(data_buffer.get()), cvt.dst, (int)row_data_size,
-                 cvt.output_format, (u8)cvt.alpha);
+        EncodeStrip(tiles.get(), num_tiles, cvt, row_height, next_output);
+        next_output += StripOutputSize(cvt, row_height);
     }
 }
+
 } // namespace HW::Y2R
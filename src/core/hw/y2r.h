@@ -4,10 +4,47 @@
 
 #pragma once
 
-namespace Service::Y2R {
-struct ConversionConfiguration;
-} // namespace Service::Y2R
+#include <vector>
+#include "common/common_types.h"
+#include "core/hle/service/y2r_u.h"
+
+namespace Kernel {
+class Process;
+} // namespace Kernel
 
 namespace HW::Y2R {
-void PerformConversion(Service::Y2R::ConversionConfiguration& cvt);
+
+/**
+ * A Y2R conversion, working on host copies of the guest memory it reads and writes so that it can
+ * be performed on any thread. Guest memory is only accessed by ReadInput and WriteOutput, which
+ * must be called from the emulation thread.
+ */
+class Conversion {
+public:
+    explicit Conversion(const Service::Y2R::ConversionConfiguration& config);
+
+    /// Copies the image data the conversion will DMA in from the memory of a process
+    void ReadInput(const Kernel::Process& process);
+
+    /// Converts the copied input. This is the expensive part, and can be called from any thread.
+    void Perform();
+
+    /// Copies the converted image to the memory of a process, skipping the output gaps
+    void WriteOutput(const Kernel::Process& process) const;
+
+private:
+    /// Configuration the conversion was started with
+    const Service::Y2R::ConversionConfiguration config;
+
+    /// Copies of the DMAed data, with the transfers laid out back to back
+    std::vector<u8> src_Y, src_U, src_V, src_YUYV;
+    std::vector<u8> dst;
+};
+
+/**
+ * Advances the buffers of a configuration past all the data a conversion of it transfers, which is
+ * where the hardware leaves them once the conversion is done.
+ */
+void AdvanceBuffers(Service::Y2R::ConversionConfiguration& cvt);
+
 } // namespace HW::Y2R
@@ -14,6 +14,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
+#include "core/hw/gpu_thread.h"
 #include "core/memory.h"
 #include "core/memory_setup.h"
 #include "video_core/renderer_base.h"
@@ -393,6 +394,8 @@ void RasterizerFlushRegion(PAddr start, u32 size) {
         return;
     }
 
+    GPUThread::WaitIdle();
+
     VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size);
 }
 
@@ -401,6 +404,8 @@ void RasterizerInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
+    GPUThread::WaitIdle();
+
     VideoCore::g_renderer->Rasterizer()->InvalidateRegion(start, size);
 }
 
@@ -411,6 +416,8 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
         return;
     }
 
+    GPUThread::WaitIdle();
+
     VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
 }
 
@@ -421,6 +428,8 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
         return;
     }
 
+    GPUThread::WaitIdle();
+
     VAddr end = start + size;
 
     auto CheckRegion = [&](VAddr region_start, VAddr region_end) {
@@ -470,6 +479,53 @@ u64 Read64(const VAddr addr) {
     return Read<u64_le>(addr);
 }
 
+boost::optional<std::vector<HostMemorySpan>> GetHostMemorySpans(const Kernel::Process& process,
+                                                                const VAddr addr, const size_t size,
+                                                                FlushMode mode) {
+    auto& page_table = process.vm_manager.page_table;
+
+    std::vector<HostMemorySpan> spans;
+    size_t remaining_size = size;
+    size_t page_index = addr >> PAGE_BITS;
+    size_t page_offset = addr & PAGE_MASK;
+
+    while (remaining_size > 0) {
+        const size_t span_size = std::min(PAGE_SIZE - page_offset, remaining_size);
+        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
+
+        u8* pointer;
+        switch (page_table.attributes[page_index]) {
+        case PageType::Memory: {
+            DEBUG_ASSERT(page_table.pointers[page_index]);
+            pointer = page_table.pointers[page_index] + page_offset;
+            break;
+        }
+        case PageType::RasterizerCachedMemory: {
+            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(span_size), mode);
+            pointer = GetPointerFromVMA(process, current_vaddr);
+            break;
+        }
+        case PageType::Unmapped:
+        case PageType::Special:
+            return boost::none;
+        default:
+            UNREACHABLE();
+        }
+
+        if (!spans.empty() && spans.back().pointer + spans.back().size == pointer) {
+            spans.back().size += span_size;
+        } else {
+            spans.push_back({pointer, span_size});
+        }
+
+        page_index++;
+        page_offset = 0;
+        remaining_size -= span_size;
+    }
+
+    return spans;
+}
+
 void ReadBlock(const Kernel::Process& process, const VAddr src_addr, void* dest_buffer,
                const size_t size) {
     auto& page_table = process.vm_manager.page_table;
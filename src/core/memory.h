@@ -273,4 +273,21 @@ enum class FlushMode {
  */
 void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode);
 
+/// A run of host memory backing a contiguous range of guest virtual memory
+struct HostMemorySpan {
+    u8* pointer;
+    size_t size;
+};
+
+/**
+ * Gets the host memory backing a block of guest virtual memory, so that it can be accessed
+ * without going through ReadBlock/WriteBlock. Adjacent pages that are also adjacent on the host
+ * are merged into a single span. Rasterizer cached pages are flushed with the given mode first,
+ * i.e. FlushMode::Flush before reading from the spans and FlushMode::Invalidate before writing.
+ * @returns The spans in address order, or nothing if part of the block is unmapped or MMIO
+ */
+boost::optional<std::vector<HostMemorySpan>> GetHostMemorySpans(const Kernel::Process& process,
+                                                                VAddr addr, size_t size,
+                                                                FlushMode mode);
+
 } // namespace Memory
@@ -29,6 +29,9 @@ void PerfStats::EndSystemFrame() {
     auto frame_end{Clock::now()};
     accumulated_frametime += frame_end - frame_begin;
     system_frames += 1;
+    if (record_frame_times) {
+        recorded_frame_times.push_back(duration_cast<DoubleSecs>(frame_end - frame_begin).count());
+    }
 
     previous_frame_length = frame_end - previous_frame_end;
     previous_frame_end = frame_end;
@@ -40,6 +43,29 @@ void PerfStats::EndGameFrame() {
     game_frames += 1;
 }
 
+void PerfStats::AddSubsystemTime(Subsystem subsystem, Clock::duration time) {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    subsystem_time[static_cast<size_t>(subsystem)] += time;
+}
+
+void PerfStats::SetFrameTimeRecording(bool enabled) {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    record_frame_times = enabled;
+    if (!enabled) {
+        recorded_frame_times.clear();
+    }
+}
+
+std::vector<double> PerfStats::TakeRecordedFrameTimes() {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    std::vector<double> frame_times;
+    frame_times.swap(recorded_frame_times);
+    return frame_times;
+}
+
 PerfStats::Results PerfStats::GetAndResetStats(u64 current_system_time_us) {
     std::lock_guard<std::mutex> lock(object_mutex);
 
@@ -56,6 +82,12 @@ PerfStats::Results PerfStats::GetAndResetStats(u64 current_system_time_us) {
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second / 1'000'000.0;
+    results.gpu_time =
+        duration_cast<DoubleSecs>(subsystem_time[static_cast<size_t>(Subsystem::GPU)]).count() /
+        static_cast<double>(system_frames);
+    results.audio_time =
+        duration_cast<DoubleSecs>(subsystem_time[static_cast<size_t>(Subsystem::Audio)]).count() /
+        static_cast<double>(system_frames);
 
     // Reset counters
     reset_point = now;
@@ -63,6 +95,7 @@ PerfStats::Results PerfStats::GetAndResetStats(u64 current_system_time_us) {
     accumulated_frametime = Clock::duration::zero();
     system_frames = 0;
     game_frames = 0;
+    subsystem_time.fill(Clock::duration::zero());
 
     return results;
 }
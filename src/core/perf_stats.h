@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <mutex>
+#include <vector>
 #include "common/common_types.h"
 
 namespace Core {
@@ -18,6 +20,28 @@ class PerfStats {
 public:
     using Clock = std::chrono::high_resolution_clock;
 
+    /// Parts of the emulated system whose walltime is accounted separately
+    enum class Subsystem {
+        GPU,
+        Audio,
+        NumSubsystems,
+    };
+
+    /// Adds the walltime between its construction and destruction to a subsystem
+    class ScopedSubsystemTimer {
+    public:
+        ScopedSubsystemTimer(PerfStats& perf_stats, Subsystem subsystem)
+            : perf_stats(perf_stats), subsystem(subsystem), begin(Clock::now()) {}
+        ~ScopedSubsystemTimer() {
+            perf_stats.AddSubsystemTime(subsystem, Clock::now() - begin);
+        }
+
+    private:
+        PerfStats& perf_stats;
+        Subsystem subsystem;
+        Clock::time_point begin;
+    };
+
     struct Results {
         /// System FPS (LCD VBlanks) in Hz
         double system_fps;
@@ -27,12 +51,28 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Walltime per system frame spent emulating the GPU, in seconds. With asynchronous GPU
+        /// emulation this overlaps with the rest of the frame.
+        double gpu_time;
+        /// Walltime per system frame spent emulating the DSP, in seconds
+        double audio_time;
     };
 
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
 
+    void AddSubsystemTime(Subsystem subsystem, Clock::duration time);
+
+    /// Starts or stops keeping the walltime of every system frame, for TakeRecordedFrameTimes
+    void SetFrameTimeRecording(bool enabled);
+
+    /**
+     * Gets the walltime of each system frame (excluding any waits) recorded since the previous
+     * call, in seconds, and clears them.
+     */
+    std::vector<double> TakeRecordedFrameTimes();
+
     Results GetAndResetStats(u64 current_system_time_us);
 
     /**
@@ -55,6 +95,12 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
+    /// Cumulative walltime spent in each subsystem since last reset
+    std::array<Clock::duration, static_cast<size_t>(Subsystem::NumSubsystems)> subsystem_time{};
+
+    bool record_frame_times = false;
+    /// Walltime of the system frames that ended since the last TakeRecordedFrameTimes call
+    std::vector<double> recorded_frame_times;
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
@@ -44,11 +44,23 @@ void LogSettings() {
     LOG_INFO(Config, "Citra Configuration:");
     LogSetting("Core_UseCpuJit", Settings::values.use_cpu_jit);
     LogSetting("Core_KeyboardMode", static_cast<int>(Settings::values.keyboard_mode));
+    LogSetting("Renderer_Backend", static_cast<int>(Settings::values.renderer_backend));
     LogSetting("Renderer_UseHwRenderer", Settings::values.use_hw_renderer);
     LogSetting("Renderer_UseHwShader", Settings::values.use_hw_shader);
     LogSetting("Renderer_ShadersAccurateGs", Settings::values.shaders_accurate_gs);
     LogSetting("Renderer_ShadersAccurateMul", Settings::values.shaders_accurate_mul);
     LogSetting("Renderer_UseShaderJit", Settings::values.use_shader_jit);
+    LogSetting("Renderer_UseDiskShaderCache", Settings::values.use_disk_shader_cache);
+    LogSetting("Renderer_UseAsynchronousShaderCompilation",
+               Settings::values.use_asynchronous_shader_compilation);
+    LogSetting("Renderer_UseAsynchronousGpuEmulation",
+               Settings::values.use_asynchronous_gpu_emulation);
+    LogSetting("Renderer_UseTextureDeduplication", Settings::values.use_texture_deduplication);
+    LogSetting("Renderer_SWRasterizerNumThreads", Settings::values.swrasterizer_num_threads);
+    LogSetting("Renderer_VertexShadingNumThreads", Settings::values.vertex_shading_num_threads);
+    LogSetting("Renderer_SurfaceTilingNumThreads", Settings::values.surface_tiling_num_threads);
+    LogSetting("Renderer_DisplayTransferNumThreads",
+               Settings::values.display_transfer_num_threads);
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
     LogSetting("Renderer_UseVsync", Settings::values.use_vsync);
     LogSetting("Renderer_UseFrameLimit", Settings::values.use_frame_limit);
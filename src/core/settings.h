@@ -21,6 +21,15 @@ enum class InitClock {
     FixedTime = 1,
 };
 
+/// How the emulated screens are presented
+enum class RendererBackend {
+    /// Draw them to the window with OpenGL
+    OpenGL,
+    /// Composite them in memory and hand them to the frontend, without needing a GL context. Always
+    /// uses the software rasterizer.
+    Software,
+};
+
 enum class LayoutOption {
     Default,
     SingleScreen,
@@ -134,11 +143,20 @@ struct Values {
     bool enable_new_mode;
 
     // Renderer
+    RendererBackend renderer_backend;
     bool use_hw_renderer;
     bool use_hw_shader;
     bool shaders_accurate_gs;
     bool shaders_accurate_mul;
     bool use_shader_jit;
+    bool use_disk_shader_cache;
+    bool use_asynchronous_shader_compilation;
+    bool use_asynchronous_gpu_emulation;
+    bool use_texture_deduplication;
+    u16 swrasterizer_num_threads;
+    u16 vertex_shading_num_threads;
+    u16 surface_tiling_num_threads;
+    u16 display_transfer_num_threads;
     u16 resolution_factor;
     bool use_vsync;
     bool use_frame_limit;
@@ -2,15 +2,19 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <memory>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
+#include "core/hw/gpu_thread.h"
 #include "core/memory.h"
 #include "core/settings.h"
 #include "video_core/command_processor.h"
@@ -43,6 +47,165 @@ static const u32 expand_bits_to_bytes[] = {
     0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff, 0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff,
 };
 
+/**
+ * Post-transform vertex cache for indexed draws, keyed directly by vertex index. Every entry is
+ * tagged with the draw it was shaded in, so moving on to the next draw only bumps the current
+ * generation instead of clearing the table.
+ */
+struct VertexCache {
+    struct Entry {
+        Shader::AttributeBuffer output;
+        u32 generation = 0;
+    };
+
+    std::vector<Entry> entries;
+    u32 generation = 0;
+
+    /// Prepares the cache for a draw whose indices are all below index_range
+    void BeginDraw(u32 index_range) {
+        if (entries.size() < index_range) {
+            entries.resize(index_range);
+        }
+
+        if (++generation == 0) {
+            // The generation counter wrapped around, so old tags could alias the new generation
+            for (auto& entry : entries) {
+                entry.generation = 0;
+            }
+            generation = 1;
+        }
+    }
+};
+
+static VertexCache vertex_cache;
+static VertexCacheStats vertex_cache_stats;
+
+VertexCacheStats GetAndResetVertexCacheStats() {
+    VertexCacheStats stats = vertex_cache_stats;
+    vertex_cache_stats = {};
+    return stats;
+}
+
+/// Draws with fewer vertices than this are shaded serially even if parallel shading is enabled
+constexpr u32 PARALLEL_SHADING_MIN_VERTICES = 256;
+/// Number of unique vertices shaded by one parallel task
+constexpr size_t PARALLEL_SHADING_CHUNK_SIZE = 64;
+/// Number of vertices handed to the shader engine at once, so it can shade them together
+constexpr size_t SHADING_GROUP_SIZE = 8;
+
+static std::unique_ptr<Common::ThreadPool> vertex_shading_pool;
+static u16 vertex_shading_pool_threads = 1;
+
+/// Maps a vertex id to its output slot during parallel shading, or INVALID_SLOT if unseen
+static std::vector<u32> vertex_slots;
+/// Output slot of every element of the current draw, in submission order
+static std::vector<u32> element_slots;
+/// (index, vertex) pairs of the unique vertices of the current draw
+static std::vector<std::pair<u32, u32>> unique_vertices;
+/// Shaded output of every unique vertex of the current draw
+static std::vector<Shader::AttributeBuffer> shaded_vertices;
+/// Outputs waiting for the vertices queued for shading, in submission order
+static std::vector<const Shader::AttributeBuffer*> pending_vertices;
+constexpr u32 INVALID_SLOT = 0xFFFFFFFF;
+
+/// Returns the pool used for parallel vertex shading, or nullptr if it's disabled
+static Common::ThreadPool* GetVertexShadingPool() {
+    const u16 num_threads = Settings::values.vertex_shading_num_threads;
+    if (num_threads != vertex_shading_pool_threads) {
+        vertex_shading_pool_threads = num_threads;
+        vertex_shading_pool.reset();
+        if (num_threads != 1) {
+            vertex_shading_pool =
+                std::make_unique<Common::ThreadPool>(num_threads, "VertexShading");
+            if (vertex_shading_pool->NumThreads() == 1) {
+                vertex_shading_pool.reset();
+            }
+        }
+    }
+    return vertex_shading_pool.get();
+}
+
+/**
+ * Shades all vertices of a draw using a thread pool and submits them to the geometry pipeline in
+ * their original order. Indices referring to the same vertex are only shaded once.
+ */
+static void ProcessVerticesParallel(Common::ThreadPool& pool, const VertexLoader& loader,
+                                    u32 base_address, bool is_indexed, const u8* index_address_8,
+                                    bool index_u16) {
+    const auto& regs = g_state.regs;
+    const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+    const u32 num_vertices = regs.pipeline.num_vertices;
+
+    if (vertex_slots.empty()) {
+        vertex_slots.resize(0x10000, INVALID_SLOT);
+    }
+
+    element_slots.resize(num_vertices);
+    unique_vertices.clear();
+
+    for (u32 index = 0; index < num_vertices; ++index) {
+        // Indexed rendering doesn't use the start offset
+        const u32 vertex = is_indexed
+                               ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                               : (index + regs.pipeline.vertex_offset);
+
+        if (!is_indexed) {
+            element_slots[index] = static_cast<u32>(unique_vertices.size());
+            unique_vertices.emplace_back(index, vertex);
+            continue;
+        }
+
+        u32& slot = vertex_slots[vertex];
+        if (slot == INVALID_SLOT) {
+            slot = static_cast<u32>(unique_vertices.size());
+            unique_vertices.emplace_back(index, vertex);
+        }
+        element_slots[index] = slot;
+    }
+
+    if (is_indexed) {
+        for (const auto& unique_vertex : unique_vertices) {
+            vertex_slots[unique_vertex.second] = INVALID_SLOT;
+        }
+    }
+
+    shaded_vertices.resize(unique_vertices.size());
+
+    const auto* shader_engine = Shader::GetEngine();
+    const size_t num_chunks =
+        (unique_vertices.size() + PARALLEL_SHADING_CHUNK_SIZE - 1) / PARALLEL_SHADING_CHUNK_SIZE;
+    if (is_indexed) {
+        const u64 misses = unique_vertices.size();
+        vertex_cache_stats.hits += num_vertices - misses;
+        vertex_cache_stats.misses += misses;
+    }
+
+    pool.ParallelFor(num_chunks, [&](size_t chunk) {
+        const size_t begin = chunk * PARALLEL_SHADING_CHUNK_SIZE;
+        const size_t end = std::min(begin + PARALLEL_SHADING_CHUNK_SIZE, unique_vertices.size());
+
+        std::array<Shader::UnitState, SHADING_GROUP_SIZE> shader_units;
+        Shader::AttributeBuffer input;
+        for (size_t group = begin; group < end; group += SHADING_GROUP_SIZE) {
+            const size_t group_end = std::min(group + SHADING_GROUP_SIZE, end);
+            for (size_t i = group; i < group_end; ++i) {
+                loader.LoadVertex(base_address, unique_vertices[i].first,
+                                  unique_vertices[i].second, input);
+                shader_units[i - group].LoadInput(regs.vs, input);
+            }
+            shader_engine->RunMultiple(g_state.vs, shader_units.data(),
+                                       static_cast<unsigned>(group_end - group));
+            for (size_t i = group; i < group_end; ++i) {
+                shader_units[i - group].WriteOutput(regs.vs, shaded_vertices[i]);
+            }
+        }
+    });
+
+    for (u32 index = 0; index < num_vertices; ++index) {
+        g_state.geometry_pipeline.SubmitVertex(shaded_vertices[element_slots[index]]);
+    }
+}
+
 static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
     if (&setup == &g_state.vs) {
         return "vertex shader";
@@ -134,7 +297,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     switch (id) {
     // Trigger IRQ
     case PICA_REG_INDEX(trigger_irq):
-        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
+        GPUThread::SignalInterrupt(Service::GSP::InterruptId::P3D);
         break;
 
     case PICA_REG_INDEX(pipeline.triangle_topology):
@@ -286,8 +449,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         }
 
         // Processes information about internal vertex attributes to figure out how a vertex is
-        // loaded.
-        // Later, these can be compiled and cached.
+        // loaded. On x86_64 the loader is compiled and cached per attribute layout.
         const u32 base_address = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress();
         VertexLoader loader(regs.pipeline);
         Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
@@ -300,18 +462,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
         bool index_u16 = index_info.format != 0;
 
-        // Simple circular-replacement vertex cache
-        // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-        const size_t VERTEX_CACHE_SIZE = 32;
-        std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-        std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-        std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-        Shader::AttributeBuffer vs_output;
-
-        unsigned int vertex_cache_pos = 0;
-
         auto* shader_engine = Shader::GetEngine();
-        Shader::UnitState shader_unit;
 
         shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
 
@@ -320,48 +471,102 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         if (g_state.geometry_pipeline.NeedIndexInput())
             ASSERT(is_indexed);
 
+        if (regs.pipeline.num_vertices >= PARALLEL_SHADING_MIN_VERTICES &&
+            !g_state.geometry_pipeline.NeedIndexInput()) {
+            if (auto* pool = GetVertexShadingPool()) {
+                ProcessVerticesParallel(*pool, loader, base_address, is_indexed, index_address_8,
+                                        index_u16);
+                VideoCore::g_renderer->Rasterizer()->DrawTriangles();
+                break;
+            }
+        }
+
+        const bool use_vertex_cache = is_indexed && !g_state.geometry_pipeline.NeedIndexInput();
+        if (use_vertex_cache) {
+            u32 max_index = 0;
+            for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+                max_index = std::max<u32>(
+                    max_index, index_u16 ? index_address_16[index] : index_address_8[index]);
+            }
+            vertex_cache.BeginDraw(max_index + 1);
+        }
+
+        u64 vertex_cache_hits = 0;
+        u64 vertex_cache_misses = 0;
+
+        // Vertices that miss the cache are queued and shaded in groups. Their submission, and that
+        // of every vertex after them, waits until the group has been shaded.
+        std::array<Shader::UnitState, SHADING_GROUP_SIZE> shader_units;
+        std::array<Shader::AttributeBuffer, SHADING_GROUP_SIZE> group_outputs;
+        std::array<Shader::AttributeBuffer*, SHADING_GROUP_SIZE> group_targets;
+        unsigned group_size = 0;
+        pending_vertices.clear();
+
+        const auto shade_group = [&] {
+            shader_engine->RunMultiple(g_state.vs, shader_units.data(), group_size);
+            for (unsigned i = 0; i < group_size; ++i) {
+                shader_units[i].WriteOutput(regs.vs, *group_targets[i]);
+            }
+            group_size = 0;
+
+            // Send to geometry pipeline
+            for (const auto* output : pending_vertices) {
+                g_state.geometry_pipeline.SubmitVertex(*output);
+            }
+            pending_vertices.clear();
+        };
+
         for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
             // Indexed rendering doesn't use the start offset
             unsigned int vertex =
                 is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
                            : (index + regs.pipeline.vertex_offset);
 
-            bool vertex_cache_hit = false;
+            if (is_indexed && g_state.geometry_pipeline.NeedIndexInput()) {
+                g_state.geometry_pipeline.SubmitIndex(vertex);
+                continue;
+            }
 
-            if (is_indexed) {
-                if (g_state.geometry_pipeline.NeedIndexInput()) {
-                    g_state.geometry_pipeline.SubmitIndex(vertex);
+            // Shade straight into the cache entry so hits can be submitted without a copy
+            Shader::AttributeBuffer* output = &group_outputs[group_size];
+            if (use_vertex_cache) {
+                auto& entry = vertex_cache.entries[vertex];
+                output = &entry.output;
+
+                if (entry.generation == vertex_cache.generation) {
+                    ++vertex_cache_hits;
+                    if (pending_vertices.empty()) {
+                        g_state.geometry_pipeline.SubmitVertex(*output);
+                    } else {
+                        pending_vertices.push_back(output);
+                    }
                     continue;
                 }
 
-                for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                    if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                        vs_output = vertex_cache[i];
-                        vertex_cache_hit = true;
-                        break;
-                    }
-                }
+                ++vertex_cache_misses;
+                entry.generation = vertex_cache.generation;
             }
 
-            if (!vertex_cache_hit) {
-                // Initialize data for the current vertex
-                Shader::AttributeBuffer input;
-                loader.LoadVertex(base_address, index, vertex, input);
+            // Initialize data for the current vertex
+            Shader::AttributeBuffer input;
+            loader.LoadVertex(base_address, index, vertex, input);
 
-                shader_unit.LoadInput(regs.vs, input);
-                shader_engine->Run(g_state.vs, shader_unit);
-                shader_unit.WriteOutput(regs.vs, vs_output);
-
-                if (is_indexed) {
-                    vertex_cache[vertex_cache_pos] = vs_output;
-                    vertex_cache_valid[vertex_cache_pos] = true;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
-                }
+            shader_units[group_size].LoadInput(regs.vs, input);
+            group_targets[group_size++] = output;
+            pending_vertices.push_back(output);
+            if (group_size == SHADING_GROUP_SIZE) {
+                shade_group();
             }
+        }
+        if (group_size != 0) {
+            shade_group();
+        }
 
-            // Send to geometry pipeline
-            g_state.geometry_pipeline.SubmitVertex(vs_output);
+        if (use_vertex_cache) {
+            vertex_cache_stats.hits += vertex_cache_hits;
+            vertex_cache_stats.misses += vertex_cache_misses;
+            LOG_TRACE(HW_GPU, "Vertex cache: {} hits, {} misses", vertex_cache_hits,
+                      vertex_cache_misses);
         }
 
         VideoCore::g_renderer->Rasterizer()->DrawTriangles();
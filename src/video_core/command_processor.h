@@ -32,6 +32,17 @@ static_assert(std::is_standard_layout<CommandHeader>::value == true,
               "CommandHeader does not use standard layout");
 static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect size!");
 
+/// Counters of the post-transform vertex cache used by indexed software draws
+struct VertexCacheStats {
+    /// Number of indices whose vertex had already been shaded earlier in the same draw
+    u64 hits = 0;
+    /// Number of indices that required running the vertex shader
+    u64 misses = 0;
+};
+
+/// Returns the vertex cache counters accumulated since the previous call and resets them
+VertexCacheStats GetAndResetVertexCacheStats();
+
 void ProcessCommandList(const u32* list, u32 size);
 
 } // namespace Pica::CommandProcessor
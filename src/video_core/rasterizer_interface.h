@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include "common/common_types.h"
 #include "core/hw/gpu.h"
 
@@ -15,6 +17,9 @@ struct OutputVertex;
 
 namespace VideoCore {
 
+/// Reports the progress of loading disk resources, as the number of items loaded and the total
+using DiskResourceLoadCallback = std::function<void(std::size_t current, std::size_t total)>;
+
 class RasterizerInterface {
 public:
     virtual ~RasterizerInterface() {}
@@ -69,5 +74,8 @@ public:
     virtual bool AccelerateDrawBatch(bool is_indexed) {
         return false;
     }
+
+    /// Load resources cached on disk for the given title, such as previously generated shaders
+    virtual void LoadDiskResources(u64 title_id, const DiskResourceLoadCallback& callback) {}
 };
 } // namespace VideoCore
@@ -38,7 +38,17 @@ public:
 
     void RefreshRasterizerSetting();
 
+    bool IsOpenGLRasterizerActive() const {
+        return opengl_rasterizer_active;
+    }
+
 protected:
+    /// Whether the renderer can present the output of the OpenGL rasterizer. If not, the software
+    /// rasterizer is used regardless of the hardware renderer setting.
+    virtual bool SupportsOpenGLRasterizer() const {
+        return true;
+    }
+
     EmuWindow& render_window; ///< Reference to the render window handle.
     std::unique_ptr<VideoCore::RasterizerInterface> rasterizer;
 
@@ -7,6 +7,7 @@
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 #include <glad/glad.h>
 #include "common/alignment.h"
 #include "common/assert.h"
@@ -14,7 +15,9 @@
 #include "common/math_util.h"
 #include "common/scope_exit.h"
 #include "common/vector_math.h"
+#include "core/frontend/emu_window.h"
 #include "core/hw/gpu.h"
+#include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/regs_framebuffer.h"
 #include "video_core/regs_rasterizer.h"
@@ -27,6 +30,9 @@
 using PixelFormat = SurfaceParams::PixelFormat;
 using SurfaceType = SurfaceParams::SurfaceType;
 
+/// Number of worker threads compiling shaders when asynchronous shader compilation is enabled
+constexpr std::size_t ASYNC_SHADER_COMPILER_THREADS = 2;
+
 static bool IsVendorAmd() {
     std::string gpu_vendor{reinterpret_cast<char const*>(glGetString(GL_VENDOR))};
     return gpu_vendor == "ATI Technologies Inc." || gpu_vendor == "Advanced Micro Devices, Inc.";
@@ -146,6 +152,24 @@ RasterizerOpenGL::RasterizerOpenGL(EmuWindow& window)
     shader_program_manager =
         std::make_unique<ShaderProgramManager>(GLAD_GL_ARB_separate_shader_objects, is_amd);
 
+    if (Settings::values.use_asynchronous_shader_compilation) {
+        std::vector<std::unique_ptr<GraphicsContext>> contexts;
+        for (std::size_t i = 0; i < ASYNC_SHADER_COMPILER_THREADS; ++i) {
+            auto context = window.CreateSharedContext();
+            if (context == nullptr) {
+                break;
+            }
+            contexts.push_back(std::move(context));
+        }
+
+        if (contexts.empty()) {
+            LOG_WARNING(Render_OpenGL,
+                        "Shared contexts are unavailable, compiling shaders synchronously");
+        } else {
+            shader_program_manager->EnableAsyncCompilation(std::move(contexts));
+        }
+    }
+
     glEnable(GL_BLEND);
 
     SyncEntireState();
@@ -373,6 +397,15 @@ bool RasterizerOpenGL::SetupGeometryShader() {
     }
 }
 
+void RasterizerOpenGL::LoadDiskResources(u64 title_id,
+                                         const VideoCore::DiskResourceLoadCallback& callback) {
+    // Homebrew without a title ID has nothing to key the cache on
+    if (!Settings::values.use_disk_shader_cache || title_id == 0) {
+        return;
+    }
+    shader_program_manager->LoadDiskCache(title_id, callback);
+}
+
 bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
     const auto& regs = Pica::g_state.regs;
     if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
@@ -748,8 +781,7 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
 
     // Sync and bind the shader
     if (shader_dirty) {
-        SetShader();
-        shader_dirty = false;
+        shader_dirty = !SetShader();
     }
 
     // Sync the LUTs within the texture buffer
@@ -772,7 +804,10 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
 
     // Draw the vertex batch
     bool succeeded = true;
-    if (accelerate) {
+    if (shader_dirty) {
+        // The fragment shader is still being compiled in the background. Dropping the batch
+        // causes a brief visual glitch instead of stalling emulation until the driver is done.
+    } else if (accelerate) {
         succeeded = AccelerateDrawBatchInternal(is_indexed, use_gs);
     } else {
         state.draw.vertex_array = sw_vao.handle;
@@ -1568,9 +1603,9 @@ void RasterizerOpenGL::SamplerInfo::SyncWithConfig(
     }
 }
 
-void RasterizerOpenGL::SetShader() {
+bool RasterizerOpenGL::SetShader() {
     auto config = GLShader::PicaFSConfig::BuildFromRegs(Pica::g_state.regs);
-    shader_program_manager->UseFragmentShader(config);
+    return shader_program_manager->UseFragmentShader(config);
 }
 
 void RasterizerOpenGL::SyncClipEnabled() {
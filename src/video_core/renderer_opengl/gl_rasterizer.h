@@ -52,6 +52,8 @@ public:
     bool AccelerateDisplay(const GPU::Regs::FramebufferConfig& config, PAddr framebuffer_addr,
                            u32 pixel_stride, ScreenInfo& screen_info) override;
     bool AccelerateDrawBatch(bool is_indexed) override;
+    void LoadDiskResources(u64 title_id,
+                           const VideoCore::DiskResourceLoadCallback& callback) override;
 
 private:
     struct SamplerInfo {
@@ -126,8 +128,11 @@ private:
     /// Syncs the clip coefficients to match the PICA register
     void SyncClipCoef();
 
-    /// Sets the OpenGL shader in accordance with the current PICA register state
-    void SetShader();
+    /**
+     * Sets the OpenGL shader in accordance with the current PICA register state.
+     * @returns false if the shader is still being compiled in the background
+     */
+    bool SetShader();
 
     /// Syncs the cull mode to match the PICA register
     void SyncCullMode();
@@ -16,10 +16,13 @@
 #include <glad/glad.h>
 #include "common/alignment.h"
 #include "common/bit_field.h"
+#include "common/cityhash.h"
 #include "common/color.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/scope_exit.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 #include "core/frontend/emu_window.h"
 #include "core/memory.h"
@@ -31,6 +34,10 @@
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 using SurfaceType = SurfaceParams::SurfaceType;
 using PixelFormat = SurfaceParams::PixelFormat;
 
@@ -81,14 +88,125 @@ static u16 GetResolutionScaleFactor() {
                : Settings::values.resolution_factor;
 }
 
+#ifdef ARCHITECTURE_x86_64
+
+/// Swaps the depth and stencil bytes of D24S8 pixels between the PICA and the OpenGL layout
+template <bool morton_to_gl>
+static __m128i ConvertD24S8(__m128i pixels) {
+    if (morton_to_gl) {
+        return _mm_or_si128(_mm_slli_epi32(pixels, 8), _mm_srli_epi32(pixels, 24));
+    }
+    return _mm_or_si128(_mm_srli_epi32(pixels, 8), _mm_slli_epi32(pixels, 24));
+}
+
+/**
+ * Copies an 8x8 tile of 2 or 4 bytes per pixel two rows at a time. Each Morton ordered block of
+ * 16 bytes holds the pixels of both rows in a 2x2 (4 bpp) or 4x2 (2 bpp) square, which a few
+ * shuffles turn into row segments and back.
+ */
+template <bool morton_to_gl, u32 bytes_per_pixel, bool convert_d24s8>
+static void MortonCopyTileSSE2(u32 stride, u8* tile_buffer, u8* gl_buffer) {
+    static_assert(bytes_per_pixel == 2 || bytes_per_pixel == 4, "");
+    const auto load = [](const u8* ptr) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    };
+    const auto store = [](u8* ptr, __m128i value) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value);
+    };
+
+    for (u32 y = 0; y < 8; y += 2) {
+        u8* const tile_rows = tile_buffer + VideoCore::MortonInterleave(0, y) * bytes_per_pixel;
+        u8* const gl_row0 = gl_buffer + (7 - y) * stride * bytes_per_pixel;
+        u8* const gl_row1 = gl_buffer + (6 - y) * stride * bytes_per_pixel;
+
+        // Offsets of the blocks holding pixels 0, 2, 4 and 6 (4 bpp) or 0 and 4 (2 bpp) of the rows
+        constexpr u32 block_count = 16 / bytes_per_pixel;
+        constexpr u32 blocks_per_row = 8 / (block_count / 2);
+        std::array<u8*, 4> blocks;
+        for (u32 i = 0; i < blocks_per_row; ++i) {
+            blocks[i] = tile_rows +
+                        VideoCore::MortonInterleave(i * block_count / 2, 0) * bytes_per_pixel;
+        }
+
+        if (morton_to_gl) {
+            __m128i row0[2], row1[2];
+            if (bytes_per_pixel == 4) {
+                for (u32 i = 0; i < 2; ++i) {
+                    const __m128i a = load(blocks[2 * i]);
+                    const __m128i b = load(blocks[2 * i + 1]);
+                    row0[i] = _mm_unpacklo_epi64(a, b);
+                    row1[i] = _mm_unpackhi_epi64(a, b);
+                }
+            } else {
+                const __m128i a = _mm_shuffle_epi32(load(blocks[0]), _MM_SHUFFLE(3, 1, 2, 0));
+                const __m128i b = _mm_shuffle_epi32(load(blocks[1]), _MM_SHUFFLE(3, 1, 2, 0));
+                row0[0] = _mm_unpacklo_epi64(a, b);
+                row1[0] = _mm_unpackhi_epi64(a, b);
+            }
+            for (u32 i = 0; i < bytes_per_pixel / 2; ++i) {
+                store(gl_row0 + i * 16, convert_d24s8 ? ConvertD24S8<true>(row0[i]) : row0[i]);
+                store(gl_row1 + i * 16, convert_d24s8 ? ConvertD24S8<true>(row1[i]) : row1[i]);
+            }
+        } else {
+            __m128i row0[2], row1[2];
+            for (u32 i = 0; i < bytes_per_pixel / 2; ++i) {
+                row0[i] = load(gl_row0 + i * 16);
+                row1[i] = load(gl_row1 + i * 16);
+                if (convert_d24s8) {
+                    row0[i] = ConvertD24S8<false>(row0[i]);
+                    row1[i] = ConvertD24S8<false>(row1[i]);
+                }
+            }
+            if (bytes_per_pixel == 4) {
+                for (u32 i = 0; i < 2; ++i) {
+                    store(blocks[2 * i], _mm_unpacklo_epi64(row0[i], row1[i]));
+                    store(blocks[2 * i + 1], _mm_unpackhi_epi64(row0[i], row1[i]));
+                }
+            } else {
+                store(blocks[0], _mm_shuffle_epi32(_mm_unpacklo_epi64(row0[0], row1[0]),
+                                                   _MM_SHUFFLE(3, 1, 2, 0)));
+                store(blocks[1], _mm_shuffle_epi32(_mm_unpackhi_epi64(row0[0], row1[0]),
+                                                   _MM_SHUFFLE(3, 1, 2, 0)));
+            }
+        }
+    }
+}
+
+#endif // ARCHITECTURE_x86_64
+
 template <bool morton_to_gl, PixelFormat format>
 static void MortonCopyTile(u32 stride, u8* tile_buffer, u8* gl_buffer) {
     constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
     constexpr u32 gl_bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(format);
+
+#ifdef ARCHITECTURE_x86_64
+    if constexpr (bytes_per_pixel == gl_bytes_per_pixel &&
+                  (bytes_per_pixel == 2 || bytes_per_pixel == 4)) {
+        MortonCopyTileSSE2<morton_to_gl, bytes_per_pixel, format == PixelFormat::D24S8>(
+            stride, tile_buffer, gl_buffer);
+        return;
+    }
+#endif
+
     for (u32 y = 0; y < 8; ++y) {
+        u8* const gl_row = gl_buffer + (7 - y) * stride * gl_bytes_per_pixel;
+        if (format != PixelFormat::D24S8 && bytes_per_pixel == gl_bytes_per_pixel) {
+            // Pixels 2n and 2n + 1 in Morton order are horizontal neighbours
+            for (u32 x = 0; x < 8; x += 2) {
+                u8* tile_ptr = tile_buffer + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
+                u8* gl_ptr = gl_row + x * gl_bytes_per_pixel;
+                if (morton_to_gl) {
+                    std::memcpy(gl_ptr, tile_ptr, 2 * bytes_per_pixel);
+                } else {
+                    std::memcpy(tile_ptr, gl_ptr, 2 * bytes_per_pixel);
+                }
+            }
+            continue;
+        }
+
         for (u32 x = 0; x < 8; ++x) {
             u8* tile_ptr = tile_buffer + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
-            u8* gl_ptr = gl_buffer + ((7 - y) * stride + x) * gl_bytes_per_pixel;
+            u8* gl_ptr = gl_row + x * gl_bytes_per_pixel;
             if (morton_to_gl) {
                 if (format == PixelFormat::D24S8) {
                     gl_ptr[0] = tile_ptr[3];
@@ -108,6 +226,28 @@ static void MortonCopyTile(u32 stride, u8* tile_buffer, u8* gl_buffer) {
     }
 }
 
+/// Minimum number of whole tiles for a Morton copy to be split across threads
+constexpr u32 PARALLEL_MORTON_COPY_MIN_TILES = 256;
+
+static std::unique_ptr<Common::ThreadPool> morton_copy_pool;
+static u16 morton_copy_pool_threads = 1;
+
+/// Returns the pool used for copying large surfaces, or nullptr if it's disabled
+static Common::ThreadPool* GetMortonCopyPool() {
+    const u16 num_threads = Settings::values.surface_tiling_num_threads;
+    if (num_threads != morton_copy_pool_threads) {
+        morton_copy_pool_threads = num_threads;
+        morton_copy_pool.reset();
+        if (num_threads != 1) {
+            morton_copy_pool = std::make_unique<Common::ThreadPool>(num_threads, "MortonCopy");
+            if (morton_copy_pool->NumThreads() == 1) {
+                morton_copy_pool.reset();
+            }
+        }
+    }
+    return morton_copy_pool.get();
+}
+
 template <bool morton_to_gl, PixelFormat format>
 static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr start, PAddr end) {
     constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
@@ -123,44 +263,54 @@ static void MortonCopy(u32 stride, u32 height, u8* gl_buffer, PAddr base, PAddr
 
     ASSERT(!morton_to_gl || (aligned_start == start && aligned_end == end));
 
-    const u32 begin_pixel_index = (aligned_down_start - base) / bytes_per_pixel;
-    u32 x = (begin_pixel_index % (stride * 8)) / 8;
-    u32 y = (begin_pixel_index / (stride * 8)) * 8;
-
-    gl_buffer += ((height - 8 - y) * stride + x) * gl_bytes_per_pixel;
-
-    auto glbuf_next_tile = [&] {
-        x = (x + 8) % stride;
-        gl_buffer += 8 * gl_bytes_per_pixel;
-        if (!x) {
-            y += 8;
-            gl_buffer -= stride * 9 * gl_bytes_per_pixel;
-        }
+    const u32 tiles_per_row = stride / 8;
+    const auto get_gl_tile = [&](u32 tile_index) {
+        const u32 x = (tile_index % tiles_per_row) * 8;
+        const u32 y = (tile_index / tiles_per_row) * 8;
+        return gl_buffer + ((height - 8 - y) * stride + x) * gl_bytes_per_pixel;
     };
 
-    u8* tile_buffer = Memory::GetPhysicalPointer(start);
+    u8* const start_buffer = Memory::GetPhysicalPointer(start);
 
     if (start < aligned_start && !morton_to_gl) {
         std::array<u8, tile_size> tmp_buf;
-        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_buffer);
-        std::memcpy(tile_buffer, &tmp_buf[start - aligned_down_start],
+        MortonCopyTile<morton_to_gl, format>(
+            stride, &tmp_buf[0], get_gl_tile((aligned_down_start - base) / tile_size));
+        std::memcpy(start_buffer, &tmp_buf[start - aligned_down_start],
                     std::min(aligned_start, end) - start);
-
-        tile_buffer += aligned_start - start;
-        glbuf_next_tile();
     }
 
-    const u8* const buffer_end = tile_buffer + aligned_end - aligned_start;
-    while (tile_buffer < buffer_end) {
-        MortonCopyTile<morton_to_gl, format>(stride, tile_buffer, gl_buffer);
-        tile_buffer += tile_size;
-        glbuf_next_tile();
+    if (aligned_end > aligned_start) {
+        u8* const tile_buffer = start_buffer + (aligned_start - start);
+        const u32 first_tile = (aligned_start - base) / tile_size;
+        const u32 num_tiles = (aligned_end - aligned_start) / tile_size;
+
+        const auto copy_tiles = [&](u32 begin, u32 end) {
+            for (u32 tile = begin; tile < end; ++tile) {
+                MortonCopyTile<morton_to_gl, format>(stride, tile_buffer + tile * tile_size,
+                                                     get_gl_tile(first_tile + tile));
+            }
+        };
+
+        Common::ThreadPool* pool =
+            num_tiles >= PARALLEL_MORTON_COPY_MIN_TILES ? GetMortonCopyPool() : nullptr;
+        if (pool != nullptr) {
+            // Tiles never share any bytes, so each thread can copy a row's worth of them
+            const u32 num_chunks = (num_tiles + tiles_per_row - 1) / tiles_per_row;
+            pool->ParallelFor(num_chunks, [&](size_t chunk) {
+                const u32 begin = static_cast<u32>(chunk) * tiles_per_row;
+                copy_tiles(begin, std::min(begin + tiles_per_row, num_tiles));
+            });
+        } else {
+            copy_tiles(0, num_tiles);
+        }
     }
 
     if (end > std::max(aligned_start, aligned_end) && !morton_to_gl) {
         std::array<u8, tile_size> tmp_buf;
-        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0], gl_buffer);
-        std::memcpy(tile_buffer, &tmp_buf[0], end - aligned_end);
+        MortonCopyTile<morton_to_gl, format>(stride, &tmp_buf[0],
+                                             get_gl_tile((aligned_end - base) / tile_size));
+        std::memcpy(start_buffer + (aligned_end - start), &tmp_buf[0], end - aligned_end);
     }
 }
 
@@ -661,14 +811,11 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
             const auto rect = GetSubRect(FromInterval(load_interval));
             ASSERT(FromInterval(load_interval).GetInterval() == load_interval);
 
-            for (unsigned y = rect.bottom; y < rect.top; ++y) {
-                for (unsigned x = rect.left; x < rect.right; ++x) {
-                    auto vec4 =
-                        Pica::Texture::LookupTexture(texture_src_data, x, height - 1 - y, tex_info);
-                    const size_t offset = (x + (width * y)) * 4;
-                    std::memcpy(&gl_buffer[offset], vec4.AsArray(), 4);
-                }
-            }
+            // Textures are stored bottom to top, so decode into the buffer with a negative stride
+            Pica::Texture::DecodeTexture(texture_src_data, tex_info, rect.left, height - rect.top,
+                                         rect.GetWidth(), rect.GetHeight(),
+                                         &gl_buffer[(rect.left + width * (rect.top - 1)) * 4],
+                                         -static_cast<ptrdiff_t>(width * 4));
         } else {
             morton_to_gl_fns[static_cast<size_t>(pixel_format)](stride, height, &gl_buffer[0], addr,
                                                                 load_start, load_end);
@@ -1006,6 +1153,13 @@ RasterizerCacheOpenGL::~RasterizerCacheOpenGL() {
     FlushAll();
     while (!surface_cache.empty())
         UnregisterSurface(*surface_cache.begin()->second.begin());
+
+    if (content_cache_stats.lookups != 0) {
+        LOG_INFO(Render_OpenGL,
+                 "Texture deduplication reused {} of {} surface loads, skipping {} bytes",
+                 content_cache_stats.hits, content_cache_stats.lookups,
+                 content_cache_stats.bytes_reused);
+    }
 }
 
 bool RasterizerCacheOpenGL::BlitSurfaces(const Surface& src_surface,
@@ -1207,6 +1361,29 @@ SurfaceRect_Tuple RasterizerCacheOpenGL::GetSurfaceSubRect(const SurfaceParams&
     return std::make_tuple(surface, surface->GetScaledSubRect(params));
 }
 
+/// Maximum number of surfaces kept for texture deduplication
+constexpr std::size_t MAX_CONTENT_CACHE_SURFACES = 256;
+
+/**
+ * Computes the key of the guest memory contents of a surface for texture deduplication. The key
+ * covers the layout of the surface, so that only compatible textures are ever shared. Returns 0 if
+ * the surface memory can't be hashed.
+ */
+static u64 ComputeContentHash(const SurfaceParams& params) {
+    if (params.type == SurfaceType::Fill || params.type == SurfaceType::Invalid)
+        return 0;
+
+    const u8* const data = Memory::GetPhysicalPointer(params.addr);
+    if (data == nullptr || Memory::GetPhysicalPointer(params.end - 1) != data + params.size - 1)
+        return 0;
+
+    const std::array<u32, 5> layout{static_cast<u32>(params.pixel_format), params.width,
+                                    params.height, params.stride, params.is_tiled};
+    const u64 layout_hash = Common::ComputeHash64(layout.data(), sizeof(layout));
+    return Common::CityHash64WithSeed(reinterpret_cast<const char*>(data), params.size,
+                                      layout_hash);
+}
+
 Surface RasterizerCacheOpenGL::GetTextureSurface(
     const Pica::TexturingRegs::FullTextureConfig& config) {
     Pica::Texture::TextureInfo info =
@@ -1477,6 +1654,7 @@ void RasterizerCacheOpenGL::DuplicateSurface(const Surface& src_surface,
 
     BlitSurfaces(src_surface, src_surface->GetScaledRect(), dest_surface,
                  dest_surface->GetScaledSubRect(*src_surface));
+    dest_surface->content_hash = 0;
 
     dest_surface->invalid_regions -= src_surface->GetInterval();
     dest_surface->invalid_regions += src_surface->invalid_regions;
@@ -1518,6 +1696,7 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
         if (copy_surface != nullptr) {
             SurfaceInterval copy_interval = params.GetCopyableInterval(copy_surface);
             CopySurface(copy_surface, surface, copy_interval);
+            RemoveFromContentCache(surface);
             surface->invalid_regions.erase(copy_interval);
             continue;
         }
@@ -1537,6 +1716,7 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
 
                 ConvertD24S8toABGR(reinterpret_surface->texture.handle, src_rect,
                                    surface->texture.handle, dest_rect);
+                RemoveFromContentCache(surface);
 
                 surface->invalid_regions.erase(convert_interval);
                 continue;
@@ -1553,17 +1733,98 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
                 retry = true;
             }
 
-            if (retry)
+            if (retry) {
+                // The texture no longer holds the contents it was hashed with
+                RemoveFromContentCache(surface);
                 continue;
+            }
         }
 
         // Load data from 3DS memory
         FlushRegion(params.addr, params.size);
+
+        const bool whole_surface = params.GetInterval() == surface->GetInterval();
+        const u64 content_hash = Settings::values.use_texture_deduplication && whole_surface
+                                     ? ComputeContentHash(*surface)
+                                     : 0;
+        if (content_hash != 0 && LoadFromContentCache(surface, content_hash)) {
+            surface->invalid_regions.erase(params.GetInterval());
+            continue;
+        }
+
+        // Only uploads of the whole surface are hashed, anything else makes the key stale
+        RemoveFromContentCache(surface);
         surface->LoadGLBuffer(params.addr, params.end);
         surface->UploadGLTexture(surface->GetSubRect(params), read_framebuffer.handle,
                                  draw_framebuffer.handle);
         surface->invalid_regions.erase(params.GetInterval());
+
+        if (content_hash != 0) {
+            InsertIntoContentCache(surface, content_hash);
+        }
+    }
+}
+
+bool RasterizerCacheOpenGL::LoadFromContentCache(const Surface& surface, u64 content_hash) {
+    ++content_cache_stats.lookups;
+
+    const auto index_it = content_cache_index.find(content_hash);
+    if (index_it == content_cache_index.end())
+        return false;
+
+    const auto cache_it = index_it->second;
+    const Surface& source = cache_it->second;
+    if (source->content_hash != content_hash) {
+        // The texture was written to since its contents were hashed
+        content_cache.erase(cache_it);
+        content_cache_index.erase(index_it);
+        return false;
+    }
+
+    // The key includes the format and dimensions, so the textures are always compatible. If the
+    // memory was merely rewritten with identical data, the texture is already up to date.
+    if (source != surface) {
+        RemoveFromContentCache(surface);
+        if (!BlitSurfaces(source, source->GetScaledRect(), surface, surface->GetScaledRect()))
+            return false;
+        surface->content_hash = content_hash;
+    }
+
+    content_cache.splice(content_cache.begin(), content_cache, cache_it);
+    ++content_cache_stats.hits;
+    content_cache_stats.bytes_reused += surface->size;
+    return true;
+}
+
+void RasterizerCacheOpenGL::InsertIntoContentCache(const Surface& surface, u64 content_hash) {
+    surface->content_hash = content_hash;
+
+    const auto index_it = content_cache_index.find(content_hash);
+    if (index_it != content_cache_index.end()) {
+        index_it->second->second = surface;
+        content_cache.splice(content_cache.begin(), content_cache, index_it->second);
+        return;
+    }
+
+    content_cache.emplace_front(content_hash, surface);
+    content_cache_index.emplace(content_hash, content_cache.begin());
+
+    if (content_cache.size() > MAX_CONTENT_CACHE_SURFACES) {
+        content_cache_index.erase(content_cache.back().first);
+        content_cache.pop_back();
+    }
+}
+
+void RasterizerCacheOpenGL::RemoveFromContentCache(const Surface& surface) {
+    if (surface->content_hash == 0)
+        return;
+
+    const auto index_it = content_cache_index.find(surface->content_hash);
+    if (index_it != content_cache_index.end() && index_it->second->second == surface) {
+        content_cache.erase(index_it->second);
+        content_cache_index.erase(index_it);
     }
+    surface->content_hash = 0;
 }
 
 void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, Surface flush_surface) {
@@ -1610,6 +1871,7 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
 
     if (region_owner != nullptr) {
         ASSERT(region_owner->type != SurfaceType::Texture);
+        region_owner->content_hash = 0;
         ASSERT(addr >= region_owner->addr && addr + size <= region_owner->end);
         // Surfaces can't have a gap
         ASSERT(region_owner->width == region_owner->stride);
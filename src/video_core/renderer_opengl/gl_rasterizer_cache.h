@@ -306,6 +306,10 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     bool registered = false;
     SurfaceRegions invalid_regions;
 
+    /// Key of the guest memory contents last uploaded to the whole texture, 0 if it was modified
+    /// since then
+    u64 content_hash = 0;
+
     u32 fill_size = 0; /// Number of bytes to read from fill_data
     std::array<u8, 4> fill_data;
 
@@ -340,6 +344,8 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     }
 
     void InvalidateAllWatcher() {
+        // Watchers are notified whenever the texture is written to
+        content_hash = 0;
         for (const auto& watcher : watchers) {
             if (auto locked = watcher.lock()) {
                 locked->valid = false;
@@ -451,6 +457,17 @@ public:
     /// Flush all cached resources tracked by this cache manager
     void FlushAll();
 
+    struct ContentCacheStats {
+        u64 lookups = 0;      ///< Whole surface loads looked up in the content cache
+        u64 hits = 0;         ///< Loads that reused a texture with identical contents
+        u64 bytes_reused = 0; ///< Guest memory that did not need to be decoded and uploaded
+    };
+
+    /// Returns the statistics of the texture deduplication
+    const ContentCacheStats& GetContentCacheStats() const {
+        return content_cache_stats;
+    }
+
 private:
     void DuplicateSurface(const Surface& src_surface, const Surface& dest_surface);
 
@@ -469,6 +486,15 @@ private:
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
+    /// Fills the whole surface from a texture holding identical contents, if there is one
+    bool LoadFromContentCache(const Surface& surface, u64 content_hash);
+
+    /// Remembers that the texture of the surface holds the contents with the given key
+    void InsertIntoContentCache(const Surface& surface, u64 content_hash);
+
+    /// Forgets the contents the texture of the surface was hashed with, before it is modified
+    void RemoveFromContentCache(const Surface& surface);
+
     SurfaceCache surface_cache;
     PageMap cached_pages;
     SurfaceMap dirty_regions;
@@ -485,4 +511,11 @@ private:
     GLint d24s8_abgr_viewport_u_id;
 
     std::unordered_map<TextureCubeConfig, CachedTextureCube> texture_cube_cache;
+
+    /// Surfaces by the key of their texture's contents, most recently used first. Entries keep
+    /// their surface alive, so that textures of removed surfaces can still be reused.
+    using ContentCacheList = std::list<std::pair<u64, Surface>>;
+    ContentCacheList content_cache;
+    std::unordered_map<u64, ContentCacheList::iterator> content_cache_index;
+    ContentCacheStats content_cache_stats;
 };
@@ -0,0 +1,208 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <fmt/format.h>
+#include "common/common_paths.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+
+/// Magic number identifying shader disk cache files ("CSDC")
+constexpr u32 SHADER_DISK_CACHE_MAGIC = 0x43445343;
+/// Version of the file layout. Bump this whenever the entry format changes.
+constexpr u32 SHADER_DISK_CACHE_VERSION = 1;
+/// Upper bound for the size of a single stored config, source or binary, used to detect corruption
+constexpr u32 MAX_ENTRY_DATA_SIZE = 64 * 1024 * 1024;
+
+static u64 GetDriverHash() {
+    const auto get_string = [](GLenum name) -> std::string {
+        const GLubyte* string = glGetString(name);
+        return string != nullptr ? reinterpret_cast<const char*>(string) : "";
+    };
+    const std::string driver = get_string(GL_VENDOR) + '\n' + get_string(GL_RENDERER) + '\n' +
+                               get_string(GL_VERSION);
+    return Common::ComputeHash64(driver.data(), driver.size());
+}
+
+static bool ReadEntry(FileUtil::IOFile& file, ShaderDiskCacheEntry& entry) {
+    u32 stage, config_size, source_size;
+    if (file.ReadBytes(&stage, sizeof(stage)) != sizeof(stage) ||
+        file.ReadBytes(&config_size, sizeof(config_size)) != sizeof(config_size) ||
+        file.ReadBytes(&source_size, sizeof(source_size)) != sizeof(source_size)) {
+        return false;
+    }
+    if (stage > static_cast<u32>(ShaderDiskCacheStage::Fragment) ||
+        config_size > MAX_ENTRY_DATA_SIZE || source_size > MAX_ENTRY_DATA_SIZE) {
+        return false;
+    }
+
+    entry.stage = static_cast<ShaderDiskCacheStage>(stage);
+    entry.config.resize(config_size);
+    entry.source.resize(source_size);
+    return file.ReadArray(entry.config.data(), config_size) == config_size &&
+           file.ReadArray(&entry.source[0], source_size) == source_size;
+}
+
+static void WriteEntry(FileUtil::IOFile& file, const ShaderDiskCacheEntry& entry) {
+    const u32 stage = static_cast<u32>(entry.stage);
+    const u32 config_size = static_cast<u32>(entry.config.size());
+    const u32 source_size = static_cast<u32>(entry.source.size());
+    file.WriteObject(stage);
+    file.WriteObject(config_size);
+    file.WriteObject(source_size);
+    file.WriteArray(entry.config.data(), config_size);
+    file.WriteArray(entry.source.data(), source_size);
+}
+
+static bool ReadBinary(FileUtil::IOFile& file, u64& source_hash, ShaderDiskCacheBinary& binary) {
+    u32 format, size;
+    if (file.ReadBytes(&source_hash, sizeof(source_hash)) != sizeof(source_hash) ||
+        file.ReadBytes(&format, sizeof(format)) != sizeof(format) ||
+        file.ReadBytes(&size, sizeof(size)) != sizeof(size) || size > MAX_ENTRY_DATA_SIZE) {
+        return false;
+    }
+
+    binary.format = static_cast<GLenum>(format);
+    binary.data.resize(size);
+    return file.ReadArray(binary.data.data(), size) == size;
+}
+
+static void WriteBinary(FileUtil::IOFile& file, u64 source_hash,
+                        const ShaderDiskCacheBinary& binary) {
+    const u32 format = static_cast<u32>(binary.format);
+    const u32 size = static_cast<u32>(binary.data.size());
+    file.WriteObject(source_hash);
+    file.WriteObject(format);
+    file.WriteObject(size);
+    file.WriteArray(binary.data.data(), size);
+}
+
+ShaderDiskCache::ShaderDiskCache(u64 title_id)
+    : build_hash(Common::ComputeHash64(Common::g_scm_rev, std::strlen(Common::g_scm_rev))),
+      driver_hash(GetDriverHash()) {
+    const std::string base_path = FileUtil::GetUserPath(D_CACHE_IDX) + "shaders" DIR_SEP
+                                  "opengl" DIR_SEP + fmt::format("{:016X}", title_id);
+    sources_path = base_path + "_sources.bin";
+    binaries_path = base_path + "_binaries.bin";
+}
+
+ShaderDiskCache::~ShaderDiskCache() = default;
+
+bool ShaderDiskCache::OpenForReading(FileUtil::IOFile& file, const std::string& path,
+                                     u64 expected_driver_hash) const {
+    if (!FileUtil::Exists(path) || !file.Open(path, "rb")) {
+        return false;
+    }
+
+    FileHeader header;
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != SHADER_DISK_CACHE_MAGIC || header.version != SHADER_DISK_CACHE_VERSION ||
+        header.build_hash != build_hash || header.driver_hash != expected_driver_hash) {
+        LOG_INFO(Render_OpenGL, "Discarding outdated shader disk cache {}", path);
+        file.Close();
+        return false;
+    }
+    return true;
+}
+
+bool ShaderDiskCache::OpenForAppending(FileUtil::IOFile& file, const std::string& path,
+                                       u64 expected_driver_hash) const {
+    if (file.IsOpen()) {
+        return true;
+    }
+
+    FileUtil::IOFile existing;
+    if (OpenForReading(existing, path, expected_driver_hash)) {
+        existing.Close();
+        return file.Open(path, "ab");
+    }
+
+    if (!FileUtil::CreateFullPath(path) || !file.Open(path, "wb")) {
+        LOG_ERROR(Render_OpenGL, "Failed to create shader disk cache {}", path);
+        return false;
+    }
+
+    const FileHeader header{SHADER_DISK_CACHE_MAGIC, SHADER_DISK_CACHE_VERSION, build_hash,
+                            expected_driver_hash};
+    file.WriteObject(header);
+    return true;
+}
+
+std::vector<ShaderDiskCacheEntry> ShaderDiskCache::LoadEntries() {
+    std::vector<ShaderDiskCacheEntry> entries;
+
+    FileUtil::IOFile file;
+    if (!OpenForReading(file, sources_path, 0)) {
+        return entries;
+    }
+
+    const u64 file_size = file.GetSize();
+    ShaderDiskCacheEntry entry;
+    while (file.Tell() < file_size) {
+        if (!ReadEntry(file, entry)) {
+            // Most likely a write interrupted by a crash. Keep what was read and rewrite the file
+            // so that entries appended from now on are readable again.
+            LOG_WARNING(Render_OpenGL, "Shader disk cache {} is corrupted, recovered {} entries",
+                        sources_path, entries.size());
+            file.Close();
+            FileUtil::Delete(sources_path);
+            if (OpenForAppending(sources_file, sources_path, 0)) {
+                for (const auto& valid_entry : entries) {
+                    WriteEntry(sources_file, valid_entry);
+                }
+                sources_file.Flush();
+            }
+            break;
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    LOG_INFO(Render_OpenGL, "Found {} shaders in disk cache {}", entries.size(), sources_path);
+    return entries;
+}
+
+ShaderDiskCacheBinaries ShaderDiskCache::LoadBinaries() {
+    ShaderDiskCacheBinaries binaries;
+
+    FileUtil::IOFile file;
+    if (!OpenForReading(file, binaries_path, driver_hash)) {
+        return binaries;
+    }
+
+    const u64 file_size = file.GetSize();
+    u64 source_hash;
+    ShaderDiskCacheBinary binary;
+    while (file.Tell() < file_size) {
+        if (!ReadBinary(file, source_hash, binary)) {
+            // Binaries are cheap to rebuild from the sources, so simply start over
+            LOG_WARNING(Render_OpenGL, "Shader disk cache {} is corrupted, discarding it",
+                        binaries_path);
+            file.Close();
+            FileUtil::Delete(binaries_path);
+            binaries.clear();
+            break;
+        }
+        binaries.insert_or_assign(source_hash, std::move(binary));
+    }
+
+    return binaries;
+}
+
+void ShaderDiskCache::SaveEntry(const ShaderDiskCacheEntry& entry) {
+    if (!OpenForAppending(sources_file, sources_path, 0)) {
+        return;
+    }
+    WriteEntry(sources_file, entry);
+    sources_file.Flush();
+}
+
+void ShaderDiskCache::SaveBinary(u64 source_hash, const ShaderDiskCacheBinary& binary) {
+    if (!OpenForAppending(binaries_file, binaries_path, driver_hash)) {
+        return;
+    }
+    WriteBinary(binaries_file, source_hash, binary);
+    binaries_file.Flush();
+}
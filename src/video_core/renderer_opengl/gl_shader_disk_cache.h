@@ -0,0 +1,81 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "common/file_util.h"
+
+/// Kinds of generated shaders stored in the disk cache
+enum class ShaderDiskCacheStage : u32 {
+    ProgrammableVertex,
+    ProgrammableGeometry,
+    FixedGeometry,
+    Fragment,
+};
+
+/// A generated shader, identified by the raw state of the config it was generated from
+struct ShaderDiskCacheEntry {
+    ShaderDiskCacheStage stage;
+    std::vector<u8> config;
+    std::string source;
+};
+
+/// A program binary as returned by glGetProgramBinary
+struct ShaderDiskCacheBinary {
+    GLenum format;
+    std::vector<u8> data;
+};
+
+/// Program binaries keyed by the hash of the GLSL source they were built from
+using ShaderDiskCacheBinaries = std::unordered_map<u64, ShaderDiskCacheBinary>;
+
+/**
+ * Per-title cache of the GLSL generated for PICA configurations and of the program binaries the
+ * driver built from it. Both are stored in separate files, which are appended to as new shaders
+ * are encountered:
+ * - The sources file is discarded when it was written by a different emulator build, since the
+ *   shader generators may have changed.
+ * - The binaries file is additionally discarded when the GL vendor, renderer or version changes.
+ */
+class ShaderDiskCache {
+public:
+    explicit ShaderDiskCache(u64 title_id);
+    ~ShaderDiskCache();
+
+    /// Reads all generated shaders stored for the title
+    std::vector<ShaderDiskCacheEntry> LoadEntries();
+
+    /// Reads all program binaries stored for the title
+    ShaderDiskCacheBinaries LoadBinaries();
+
+    /// Appends a generated shader to the sources file
+    void SaveEntry(const ShaderDiskCacheEntry& entry);
+
+    /// Appends a program binary built from the GLSL source with the given hash
+    void SaveBinary(u64 source_hash, const ShaderDiskCacheBinary& binary);
+
+private:
+    struct FileHeader {
+        u32 magic;
+        u32 version;
+        u64 build_hash;
+        u64 driver_hash;
+    };
+
+    bool OpenForReading(FileUtil::IOFile& file, const std::string& path, u64 driver_hash) const;
+    bool OpenForAppending(FileUtil::IOFile& file, const std::string& path, u64 driver_hash) const;
+
+    std::string sources_path;
+    std::string binaries_path;
+    u64 build_hash;
+    u64 driver_hash;
+
+    FileUtil::IOFile sources_file;
+    FileUtil::IOFile binaries_file;
+};
@@ -3,9 +3,19 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <boost/functional/hash.hpp>
 #include <boost/variant.hpp>
+#include "common/hash.h"
+#include "common/thread.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
 
 static void SetShaderUniformBlockBinding(GLuint shader, const char* name, UniformBindings binding,
@@ -100,16 +110,68 @@ public:
     }
 
     void Create(const char* source, GLenum type) {
+        Compile(source, type);
+        BindResources();
+    }
+
+    /// Builds the stage without touching any OpenGLState, so that it can be done on any thread
+    void Compile(const char* source, GLenum type) {
         if (shader_or_program.which() == 0) {
             boost::get<OGLShader>(shader_or_program).Create(source, type);
         } else {
             OGLShader shader;
             shader.Create(source, type);
-            OGLProgram& program = boost::get<OGLProgram>(shader_or_program);
-            program.Create(true, {shader.handle});
-            SetShaderUniformBlockBindings(program.handle);
-            SetShaderSamplerBindings(program.handle);
+            boost::get<OGLProgram>(shader_or_program).Create(true, {shader.handle});
+        }
+    }
+
+    /// Binds the uniform blocks and samplers of a separable stage
+    void BindResources() {
+        if (shader_or_program.which() == 1) {
+            const GLuint handle = boost::get<OGLProgram>(shader_or_program).handle;
+            SetShaderUniformBlockBindings(handle);
+            SetShaderSamplerBindings(handle);
+        }
+    }
+
+    /// Creates a separable stage from a program binary. Returns false if the driver rejected it.
+    bool CreateFromBinary(const ShaderDiskCacheBinary& binary) {
+        ASSERT(shader_or_program.which() == 1);
+        GLuint handle = glCreateProgram();
+        glProgramParameteri(handle, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        glProgramBinary(handle, binary.format, binary.data.data(),
+                        static_cast<GLsizei>(binary.data.size()));
+
+        GLint link_status = GL_FALSE;
+        glGetProgramiv(handle, GL_LINK_STATUS, &link_status);
+        if (link_status != GL_TRUE) {
+            glDeleteProgram(handle);
+            return false;
+        }
+
+        boost::get<OGLProgram>(shader_or_program).handle = handle;
+        SetShaderUniformBlockBindings(handle);
+        SetShaderSamplerBindings(handle);
+        return true;
+    }
+
+    /// Retrieves the program binary of a separable stage, if the driver supports it
+    boost::optional<ShaderDiskCacheBinary> GetBinary() const {
+        if (shader_or_program.which() == 0 || !GLAD_GL_ARB_get_program_binary) {
+            return boost::none;
+        }
+
+        const GLuint handle = boost::get<OGLProgram>(shader_or_program).handle;
+        GLint length = 0;
+        glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) {
+            return boost::none;
         }
+
+        ShaderDiskCacheBinary binary;
+        binary.data.resize(length);
+        glGetProgramBinary(handle, length, nullptr, &binary.format, binary.data.data());
+        return binary;
     }
 
     GLuint GetHandle() const {
@@ -124,6 +186,133 @@ private:
     boost::variant<OGLShader, OGLProgram> shader_or_program;
 };
 
+/**
+ * Compiles shader stages on worker threads, each of which owns a graphics context shared with the
+ * main one. A job is only marked as done once the driver has finished building its objects, after
+ * which the stage still needs its resources bound on the main thread.
+ */
+class AsyncShaderCompiler {
+public:
+    struct Job {
+        Job(std::string source, GLenum type, bool separable)
+            : source(std::move(source)), type(type), stage(separable) {}
+
+        std::string source;
+        GLenum type;
+        OGLShaderStage stage;
+        std::atomic<bool> done{false};
+    };
+
+    explicit AsyncShaderCompiler(std::vector<std::unique_ptr<GraphicsContext>> contexts_)
+        : contexts(std::move(contexts_)) {
+        for (auto& context : contexts) {
+            workers.emplace_back([this, context = context.get()] { WorkerLoop(*context); });
+        }
+    }
+
+    ~AsyncShaderCompiler() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stop_requested = true;
+        }
+        work_available.notify_all();
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    std::shared_ptr<Job> Queue(std::string source, GLenum type, bool separable) {
+        auto job = std::make_shared<Job>(std::move(source), type, separable);
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.push_back(job);
+        }
+        work_available.notify_one();
+        return job;
+    }
+
+private:
+    void WorkerLoop(GraphicsContext& context) {
+        Common::SetCurrentThreadName("ShaderCompiler");
+        context.MakeCurrent();
+
+        while (true) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                work_available.wait(lock, [this] { return stop_requested || !queue.empty(); });
+                if (stop_requested) {
+                    break;
+                }
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            job->stage.Compile(job->source.c_str(), job->type);
+            // Objects are only guaranteed to be complete in other contexts once the commands that
+            // built them have finished
+            glFinish();
+            job->done.store(true, std::memory_order_release);
+        }
+
+        context.DoneCurrent();
+    }
+
+    std::vector<std::unique_ptr<GraphicsContext>> contexts;
+    std::vector<std::thread> workers;
+
+    std::mutex queue_mutex;
+    std::condition_variable work_available;
+    std::deque<std::shared_ptr<Job>> queue;
+    bool stop_requested = false;
+};
+
+template <typename KeyConfigType>
+static boost::optional<KeyConfigType> ConfigFromBytes(const std::vector<u8>& bytes) {
+    KeyConfigType config;
+    if (bytes.size() != sizeof(config.state)) {
+        return boost::none;
+    }
+    std::memcpy(&config.state, bytes.data(), sizeof(config.state));
+    return config;
+}
+
+/// Stores a newly generated shader in the disk cache, along with its binary if it was just built
+template <typename KeyConfigType>
+static void SaveToDiskCache(ShaderDiskCache* disk_cache, ShaderDiskCacheStage stage,
+                            const KeyConfigType& config, const std::string& source,
+                            const OGLShaderStage* built_stage) {
+    if (disk_cache == nullptr) {
+        return;
+    }
+
+    const u8* config_data = reinterpret_cast<const u8*>(&config.state);
+    disk_cache->SaveEntry({stage, {config_data, config_data + sizeof(config.state)}, source});
+
+    if (built_stage != nullptr) {
+        if (auto binary = built_stage->GetBinary()) {
+            disk_cache->SaveBinary(Common::ComputeHash64(source.data(), source.size()), *binary);
+        }
+    }
+}
+
+/// Builds a stage loaded from the disk cache, preferring a stored binary over the GLSL source
+static void BuildFromDiskCache(OGLShaderStage& stage, GLenum type, const std::string& source,
+                               const ShaderDiskCacheBinaries& binaries,
+                               ShaderDiskCache* disk_cache) {
+    const u64 source_hash = Common::ComputeHash64(source.data(), source.size());
+    auto binary = binaries.find(source_hash);
+    if (binary != binaries.end() && stage.CreateFromBinary(binary->second)) {
+        return;
+    }
+
+    stage.Create(source.c_str(), type);
+    if (auto new_binary = stage.GetBinary()) {
+        disk_cache->SaveBinary(source_hash, *new_binary);
+    }
+}
+
 class TrivialVertexShader {
 public:
     explicit TrivialVertexShader(bool separable) : program(separable) {
@@ -138,22 +327,77 @@ private:
 };
 
 template <typename KeyConfigType, std::string (*CodeGenerator)(const KeyConfigType&, bool),
-          GLenum ShaderType>
+          GLenum ShaderType, ShaderDiskCacheStage DiskCacheStage>
 class ShaderCache {
 public:
     explicit ShaderCache(bool separable) : separable(separable) {}
     GLuint Get(const KeyConfigType& config) {
+        if (async_compiler != nullptr) {
+            return GetAsync(config);
+        }
+
         auto [iter, new_shader] = shaders.emplace(config, OGLShaderStage{separable});
         OGLShaderStage& cached_shader = iter->second;
         if (new_shader) {
-            cached_shader.Create(CodeGenerator(config, separable).c_str(), ShaderType);
+            const std::string source = CodeGenerator(config, separable);
+            cached_shader.Create(source.c_str(), ShaderType);
+            SaveToDiskCache(disk_cache, DiskCacheStage, config, source, &cached_shader);
         }
         return cached_shader.GetHandle();
     }
 
+    void SetDiskCache(ShaderDiskCache* cache) {
+        disk_cache = cache;
+    }
+
+    void SetAsyncCompiler(AsyncShaderCompiler* compiler) {
+        async_compiler = compiler;
+    }
+
+    void LoadFromDiskCache(const ShaderDiskCacheEntry& entry,
+                           const ShaderDiskCacheBinaries& binaries) {
+        auto config = ConfigFromBytes<KeyConfigType>(entry.config);
+        if (!config) {
+            return;
+        }
+        auto [iter, new_shader] = shaders.emplace(*config, OGLShaderStage{separable});
+        if (new_shader) {
+            BuildFromDiskCache(iter->second, ShaderType, entry.source, binaries, disk_cache);
+        }
+    }
+
 private:
+    /// Queues new shaders on the async compiler. Returns 0 while the shader is not ready yet.
+    GLuint GetAsync(const KeyConfigType& config) {
+        auto iter = shaders.find(config);
+        if (iter != shaders.end()) {
+            return iter->second.GetHandle();
+        }
+
+        auto [job_iter, new_job] = pending_jobs.try_emplace(config);
+        if (new_job) {
+            job_iter->second =
+                async_compiler->Queue(CodeGenerator(config, separable), ShaderType, separable);
+            return 0;
+        }
+
+        AsyncShaderCompiler::Job& job = *job_iter->second;
+        if (!job.done.load(std::memory_order_acquire)) {
+            return 0;
+        }
+
+        OGLShaderStage& cached_shader = shaders.emplace(config, std::move(job.stage)).first->second;
+        cached_shader.BindResources();
+        SaveToDiskCache(disk_cache, DiskCacheStage, config, job.source, &cached_shader);
+        pending_jobs.erase(job_iter);
+        return cached_shader.GetHandle();
+    }
+
     bool separable;
     std::unordered_map<KeyConfigType, OGLShaderStage> shaders;
+    std::unordered_map<KeyConfigType, std::shared_ptr<AsyncShaderCompiler::Job>> pending_jobs;
+    ShaderDiskCache* disk_cache = nullptr;
+    AsyncShaderCompiler* async_compiler = nullptr;
 };
 
 // This is a cache designed for shaders translated from PICA shaders. The first cache matches the
@@ -164,7 +408,7 @@ private:
 template <typename KeyConfigType,
           boost::optional<std::string> (*CodeGenerator)(const Pica::Shader::ShaderSetup&,
                                                         const KeyConfigType&, bool),
-          GLenum ShaderType>
+          GLenum ShaderType, ShaderDiskCacheStage DiskCacheStage>
 class ShaderDoubleCache {
 public:
     explicit ShaderDoubleCache(bool separable) : separable(separable) {}
@@ -183,6 +427,8 @@ public:
             if (new_shader) {
                 cached_shader.Create(program.c_str(), ShaderType);
             }
+            SaveToDiskCache(disk_cache, DiskCacheStage, key, program,
+                            new_shader ? &cached_shader : nullptr);
             shader_map[key] = &cached_shader;
             return cached_shader.GetHandle();
         }
@@ -194,25 +440,44 @@ public:
         return map_it->second->GetHandle();
     }
 
+    void SetDiskCache(ShaderDiskCache* cache) {
+        disk_cache = cache;
+    }
+
+    void LoadFromDiskCache(const ShaderDiskCacheEntry& entry,
+                           const ShaderDiskCacheBinaries& binaries) {
+        auto key = ConfigFromBytes<KeyConfigType>(entry.config);
+        if (!key) {
+            return;
+        }
+        auto [iter, new_shader] = shader_cache.emplace(entry.source, OGLShaderStage{separable});
+        if (new_shader) {
+            BuildFromDiskCache(iter->second, ShaderType, entry.source, binaries, disk_cache);
+        }
+        shader_map[*key] = &iter->second;
+    }
+
 private:
     bool separable;
     std::unordered_map<KeyConfigType, OGLShaderStage*> shader_map;
     std::unordered_map<std::string, OGLShaderStage> shader_cache;
+    ShaderDiskCache* disk_cache = nullptr;
 };
 
 using ProgrammableVertexShaders =
-    ShaderDoubleCache<GLShader::PicaVSConfig, &GLShader::GenerateVertexShader, GL_VERTEX_SHADER>;
+    ShaderDoubleCache<GLShader::PicaVSConfig, &GLShader::GenerateVertexShader, GL_VERTEX_SHADER,
+                      ShaderDiskCacheStage::ProgrammableVertex>;
 
 using ProgrammableGeometryShaders =
     ShaderDoubleCache<GLShader::PicaGSConfig, &GLShader::GenerateGeometryShader,
-                      GL_GEOMETRY_SHADER>;
+                      GL_GEOMETRY_SHADER, ShaderDiskCacheStage::ProgrammableGeometry>;
 
 using FixedGeometryShaders =
     ShaderCache<GLShader::PicaFixedGSConfig, &GLShader::GenerateFixedGeometryShader,
-                GL_GEOMETRY_SHADER>;
+                GL_GEOMETRY_SHADER, ShaderDiskCacheStage::FixedGeometry>;
 
-using FragmentShaders =
-    ShaderCache<GLShader::PicaFSConfig, &GLShader::GenerateFragmentShader, GL_FRAGMENT_SHADER>;
+using FragmentShaders = ShaderCache<GLShader::PicaFSConfig, &GLShader::GenerateFragmentShader,
+                                    GL_FRAGMENT_SHADER, ShaderDiskCacheStage::Fragment>;
 
 class ShaderProgramManager::Impl {
 public:
@@ -263,6 +528,11 @@ public:
     bool separable;
     std::unordered_map<ShaderTuple, OGLProgram, ShaderTuple::Hash> program_cache;
     OGLPipeline pipeline;
+
+    std::unique_ptr<ShaderDiskCache> disk_cache;
+
+    // Declared last so that the workers are stopped before any of the caches are destroyed
+    std::unique_ptr<AsyncShaderCompiler> async_compiler;
 };
 
 ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd)
@@ -270,6 +540,52 @@ ShaderProgramManager::ShaderProgramManager(bool separable, bool is_amd)
 
 ShaderProgramManager::~ShaderProgramManager() = default;
 
+void ShaderProgramManager::EnableAsyncCompilation(
+    std::vector<std::unique_ptr<GraphicsContext>> contexts) {
+    impl->async_compiler = std::make_unique<AsyncShaderCompiler>(std::move(contexts));
+    impl->fragment_shaders.SetAsyncCompiler(impl->async_compiler.get());
+}
+
+void ShaderProgramManager::LoadDiskCache(u64 title_id,
+                                         const VideoCore::DiskResourceLoadCallback& callback) {
+    impl->disk_cache = std::make_unique<ShaderDiskCache>(title_id);
+    impl->programmable_vertex_shaders.SetDiskCache(impl->disk_cache.get());
+    impl->programmable_geometry_shaders.SetDiskCache(impl->disk_cache.get());
+    impl->fixed_geometry_shaders.SetDiskCache(impl->disk_cache.get());
+    impl->fragment_shaders.SetDiskCache(impl->disk_cache.get());
+
+    const std::vector<ShaderDiskCacheEntry> entries = impl->disk_cache->LoadEntries();
+
+    // Program binaries only exist for separable stages; linked programs of non-separable stages
+    // are still built on first use, from shader objects compiled here.
+    ShaderDiskCacheBinaries binaries;
+    if (impl->separable && GLAD_GL_ARB_get_program_binary) {
+        binaries = impl->disk_cache->LoadBinaries();
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const ShaderDiskCacheEntry& entry = entries[i];
+        switch (entry.stage) {
+        case ShaderDiskCacheStage::ProgrammableVertex:
+            impl->programmable_vertex_shaders.LoadFromDiskCache(entry, binaries);
+            break;
+        case ShaderDiskCacheStage::ProgrammableGeometry:
+            impl->programmable_geometry_shaders.LoadFromDiskCache(entry, binaries);
+            break;
+        case ShaderDiskCacheStage::FixedGeometry:
+            impl->fixed_geometry_shaders.LoadFromDiskCache(entry, binaries);
+            break;
+        case ShaderDiskCacheStage::Fragment:
+            impl->fragment_shaders.LoadFromDiskCache(entry, binaries);
+            break;
+        }
+
+        if (callback) {
+            callback(i + 1, entries.size());
+        }
+    }
+}
+
 bool ShaderProgramManager::UseProgrammableVertexShader(const GLShader::PicaVSConfig& config,
                                                        const Pica::Shader::ShaderSetup& setup) {
     GLuint handle = impl->programmable_vertex_shaders.Get(config, setup);
@@ -300,8 +616,12 @@ void ShaderProgramManager::UseTrivialGeometryShader() {
     impl->current.gs = 0;
 }
 
-void ShaderProgramManager::UseFragmentShader(const GLShader::PicaFSConfig& config) {
-    impl->current.fs = impl->fragment_shaders.Get(config);
+bool ShaderProgramManager::UseFragmentShader(const GLShader::PicaFSConfig& config) {
+    GLuint handle = impl->fragment_shaders.Get(config);
+    if (handle == 0)
+        return false;
+    impl->current.fs = handle;
+    return true;
 }
 
 void ShaderProgramManager::ApplyTo(OpenGLState& state) {
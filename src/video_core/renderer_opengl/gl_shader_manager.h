@@ -5,12 +5,17 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/regs_lighting.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 
+class GraphicsContext;
+
 enum class UniformBindings : GLuint { Common, VS, GS };
 
 struct LightSrc {
@@ -102,6 +107,19 @@ public:
     ShaderProgramManager(bool separable, bool is_amd);
     ~ShaderProgramManager();
 
+    /**
+     * Builds all shaders stored in the disk cache of the given title, and stores the shaders
+     * generated from now on in it.
+     * @param callback Called with the number of shaders built so far and the total number
+     */
+    void LoadDiskCache(u64 title_id, const VideoCore::DiskResourceLoadCallback& callback);
+
+    /**
+     * Compiles new fragment shaders on worker threads, one per given shared context. Until a
+     * shader is ready, UseFragmentShader returns false.
+     */
+    void EnableAsyncCompilation(std::vector<std::unique_ptr<GraphicsContext>> contexts);
+
     bool UseProgrammableVertexShader(const GLShader::PicaVSConfig& config,
                                      const Pica::Shader::ShaderSetup& setup);
 
@@ -114,7 +132,7 @@ public:
 
     void UseTrivialGeometryShader();
 
-    void UseFragmentShader(const GLShader::PicaFSConfig& config);
+    bool UseFragmentShader(const GLShader::PicaFSConfig& config);
 
     void ApplyTo(OpenGLState& state);
 
@@ -0,0 +1,193 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+#include "common/assert.h"
+#include "common/color.h"
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+#include "core/settings.h"
+#include "video_core/renderer_software/renderer_software.h"
+
+RendererSoftware::RendererSoftware(EmuWindow& window) : RendererBase{window} {}
+RendererSoftware::~RendererSoftware() = default;
+
+void RendererSoftware::SwapBuffers() {
+    if (frame_callback) {
+        const Layout::FramebufferLayout& layout = render_window.GetFramebufferLayout();
+        const auto& top_screen = layout.top_screen;
+        const auto& bottom_screen = layout.bottom_screen;
+
+        ClearFrame(layout.width, layout.height);
+
+        // Same placement as RendererOpenGL::DrawScreens
+        const auto left_half = [](const MathUtil::Rectangle<unsigned>& rect) {
+            return MathUtil::Rectangle<unsigned>{rect.left / 2, rect.top,
+                                                 rect.left / 2 + rect.GetWidth() / 2, rect.bottom};
+        };
+        if (layout.top_screen_enabled) {
+            if (!Settings::values.toggle_3d) {
+                DrawScreen(0, top_screen);
+            } else {
+                DrawScreen(0, left_half(top_screen));
+                DrawScreen(1, left_half(top_screen).TranslateX(layout.width / 2));
+            }
+        }
+        if (layout.bottom_screen_enabled) {
+            if (!Settings::values.toggle_3d) {
+                DrawScreen(2, bottom_screen);
+            } else {
+                DrawScreen(2, left_half(bottom_screen));
+                DrawScreen(2, left_half(bottom_screen).TranslateX(layout.width / 2));
+            }
+        }
+
+        frame_callback(frame.data(), frame_width, frame_height);
+    }
+
+    Core::System::GetInstance().perf_stats.EndSystemFrame();
+
+    render_window.PollEvents();
+
+    Core::System::GetInstance().frame_limiter.DoFrameLimiting(CoreTiming::GetGlobalTimeUs());
+    Core::System::GetInstance().perf_stats.BeginSystemFrame();
+
+    RefreshRasterizerSetting();
+}
+
+/// Initialize the renderer
+Core::System::ResultStatus RendererSoftware::Init() {
+    RefreshRasterizerSetting();
+
+    return Core::System::ResultStatus::Success;
+}
+
+void RendererSoftware::SetFrameCallback(FrameCallback callback) {
+    frame_callback = std::move(callback);
+}
+
+void RendererSoftware::ClearFrame(u32 width, u32 height) {
+    frame_width = width;
+    frame_height = height;
+    frame.resize(static_cast<size_t>(width) * height * 4);
+
+    const auto to_u8 = [](float value) {
+        return static_cast<u8>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    const u8 bg_r = to_u8(Settings::values.bg_red);
+    const u8 bg_g = to_u8(Settings::values.bg_green);
+    const u8 bg_b = to_u8(Settings::values.bg_blue);
+    for (size_t i = 0; i < frame.size(); i += 4) {
+        frame[i + 0] = bg_r;
+        frame[i + 1] = bg_g;
+        frame[i + 2] = bg_b;
+        frame[i + 3] = 0xFF;
+    }
+}
+
+void RendererSoftware::FillRect(const MathUtil::Rectangle<unsigned>& rect, u8 r, u8 g, u8 b) {
+    for (u32 y = rect.top; y < std::min<u32>(rect.bottom, frame_height); ++y) {
+        for (u32 x = rect.left; x < std::min<u32>(rect.right, frame_width); ++x) {
+            u8* pixel = &frame[(static_cast<size_t>(y) * frame_width + x) * 4];
+            pixel[0] = r;
+            pixel[1] = g;
+            pixel[2] = b;
+            pixel[3] = 0xFF;
+        }
+    }
+}
+
+void RendererSoftware::DrawScreen(int screen_id, const MathUtil::Rectangle<unsigned>& rect) {
+    const int fb_id = screen_id == 2 ? 1 : 0;
+    const auto& framebuffer = GPU::g_regs.framebuffer_config[fb_id];
+
+    // Main LCD (0): 0x1ED02204, Sub LCD (1): 0x1ED02A04
+    u32 lcd_color_addr =
+        (fb_id == 0) ? LCD_REG_INDEX(color_fill_top) : LCD_REG_INDEX(color_fill_bottom);
+    lcd_color_addr = HW::VADDR_LCD + 4 * lcd_color_addr;
+    LCD::Regs::ColorFill color_fill = {0};
+    LCD::Read(color_fill.raw, lcd_color_addr);
+
+    if (color_fill.is_enabled) {
+        FillRect(rect, color_fill.color_r, color_fill.color_g, color_fill.color_b);
+        return;
+    }
+
+    bool right_eye = screen_id == 1;
+    if (framebuffer.address_right1 == 0 || framebuffer.address_right2 == 0)
+        right_eye = false;
+
+    const PAddr framebuffer_addr =
+        framebuffer.active_fb == 0
+            ? (!right_eye ? framebuffer.address_left1 : framebuffer.address_right1)
+            : (!right_eye ? framebuffer.address_left2 : framebuffer.address_right2);
+
+    const u32 fb_width = framebuffer.width;
+    const u32 fb_height = framebuffer.height;
+    const u32 stride = framebuffer.stride;
+    // Clip the rectangle to the frame, in case the layout doesn't fit in it
+    const u32 width =
+        std::min<u32>(rect.GetWidth(), frame_width - std::min<u32>(rect.left, frame_width));
+    const u32 height =
+        std::min<u32>(rect.GetHeight(), frame_height - std::min<u32>(rect.top, frame_height));
+    if (fb_width == 0 || fb_height == 0 || width == 0 || height == 0)
+        return;
+
+    Math::Vec4<u8> (*decode)(const u8*);
+    switch (framebuffer.color_format) {
+    case GPU::Regs::PixelFormat::RGBA8:
+        decode = Color::DecodeRGBA8;
+        break;
+    case GPU::Regs::PixelFormat::RGB8:
+        decode = Color::DecodeRGB8;
+        break;
+    case GPU::Regs::PixelFormat::RGB565:
+        decode = Color::DecodeRGB565;
+        break;
+    case GPU::Regs::PixelFormat::RGB5A1:
+        decode = Color::DecodeRGB5A1;
+        break;
+    case GPU::Regs::PixelFormat::RGBA4:
+        decode = Color::DecodeRGBA4;
+        break;
+    default:
+        LOG_ERROR(Render_Software, "Unknown framebuffer color format {:x}",
+                  static_cast<u32>(framebuffer.color_format.Value()));
+        return;
+    }
+    const u32 bpp = GPU::Regs::BytesPerPixel(framebuffer.color_format);
+
+    Memory::RasterizerFlushRegion(framebuffer_addr, stride * fb_height);
+    const u8* framebuffer_data = Memory::GetPhysicalPointer(framebuffer_addr);
+    if (framebuffer_data == nullptr) {
+        LOG_ERROR(Render_Software, "Framebuffer at invalid address 0x{:08X}", framebuffer_addr);
+        return;
+    }
+
+    // The framebuffers are stored rotated: each row in memory is a column of the screen, from left
+    // to right, and runs from the bottom of the screen to the top. Pixels are sampled with nearest
+    // neighbour filtering.
+    std::vector<const u8*> source_rows(width);
+    for (u32 x = 0; x < width; ++x) {
+        source_rows[x] = framebuffer_data + static_cast<size_t>(x * fb_height / width) * stride;
+    }
+    for (u32 y = 0; y < height; ++y) {
+        const u32 source_offset = (fb_width - 1 - y * fb_width / height) * bpp;
+        u8* pixel = &frame[(static_cast<size_t>(rect.top + y) * frame_width + rect.left) * 4];
+        for (u32 x = 0; x < width; ++x, pixel += 4) {
+            const Math::Vec4<u8> color = decode(source_rows[x] + source_offset);
+            pixel[0] = color.r();
+            pixel[1] = color.g();
+            pixel[2] = color.b();
+            pixel[3] = 0xFF;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "core/hw/gpu.h"
+#include "video_core/renderer_base.h"
+
+class EmuWindow;
+
+/**
+ * Renderer that composites the emulated screens in host memory instead of drawing them with
+ * OpenGL, so that emulation can run without a display or a GL driver. It always uses the software
+ * rasterizer. The composited frames are handed to the frontend through a callback.
+ */
+class RendererSoftware : public RendererBase {
+public:
+    /**
+     * Called with every composited frame, laid out according to the window's framebuffer layout.
+     * @param pixels Rows of RGBA8 pixels (one byte per component, red first) from top to bottom,
+     *               valid until the callback returns
+     * @param width Width of the frame in pixels
+     * @param height Height of the frame in pixels
+     */
+    using FrameCallback = std::function<void(const u8* pixels, u32 width, u32 height)>;
+
+    explicit RendererSoftware(EmuWindow& window);
+    ~RendererSoftware() override;
+
+    /// Swap buffers (render frame)
+    void SwapBuffers() override;
+
+    /// Initialize the renderer
+    Core::System::ResultStatus Init() override;
+
+    /// Sets the function receiving the composited frames. Frames are only composited while one is
+    /// set, so emulation without any output does not pay for it.
+    void SetFrameCallback(FrameCallback callback);
+
+protected:
+    bool SupportsOpenGLRasterizer() const override {
+        return false;
+    }
+
+private:
+    /// Clears the frame to the background color
+    void ClearFrame(u32 width, u32 height);
+
+    /**
+     * Draws an emulated framebuffer into a rectangle of the frame, rotating it to correct for the
+     * 3DS's LCD rotation.
+     * @param screen_id 0 for the top screen, 1 for its right eye image and 2 for the bottom screen
+     */
+    void DrawScreen(int screen_id, const MathUtil::Rectangle<unsigned>& rect);
+
+    /// Fills a rectangle of the frame with a solid color
+    void FillRect(const MathUtil::Rectangle<unsigned>& rect, u8 r, u8 g, u8 b);
+
+    FrameCallback frame_callback;
+
+    u32 frame_width = 0;
+    u32 frame_height = 0;
+    std::vector<u8> frame;
+};
@@ -121,6 +121,13 @@ void GSUnitState::ConfigOutput(const ShaderRegs& config) {
     emitter.output_mask = config.output_mask;
 }
 
+void ShaderEngine::RunMultiple(const ShaderSetup& setup, UnitState* states,
+                               unsigned num_states) const {
+    for (unsigned i = 0; i < num_states; ++i) {
+        Run(setup, states[i]);
+    }
+}
+
 #ifdef ARCHITECTURE_x86_64
 static std::unique_ptr<JitX64Engine> jit_engine;
 #endif // ARCHITECTURE_x86_64
@@ -204,6 +204,9 @@ struct ShaderSetup {
         unsigned int entry_point;
         /// Used by the JIT, points to a compiled shader object.
         const void* cached_shader = nullptr;
+        /// Used by the JIT, points to a compiled batch shader object, or nullptr if the program
+        /// can only be run one unit at a time.
+        const void* cached_batch_shader = nullptr;
     } engine_data;
 
     void MarkProgramCodeDirty() {
@@ -254,6 +257,17 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, UnitState& state) const = 0;
+
+    /**
+     * Runs the currently setup shader for several shader units, which engines may process
+     * together. The default implementation runs them one after another.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param states Shader unit states, must be setup with input data before each invocation.
+     * @param num_states Number of shader units in states.
+     */
+    virtual void RunMultiple(const ShaderSetup& setup, UnitState* states,
+                             unsigned num_states) const;
 };
 
 // TODO(yuriks): Remove and make it non-global state somewhere
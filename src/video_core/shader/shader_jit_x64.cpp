@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
 
 namespace Pica::Shader {
@@ -28,6 +30,15 @@ void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
         setup.engine_data.cached_shader = shader.get();
         cache.emplace_hint(iter, cache_key, std::move(shader));
     }
+
+    const auto batch_key = std::make_pair(cache_key, entry_point);
+    auto batch_iter = batch_cache.find(batch_key);
+    if (batch_iter == batch_cache.end()) {
+        auto batch_shader =
+            JitBatchShader::Compile(setup.program_code, setup.swizzle_data, entry_point);
+        batch_iter = batch_cache.emplace_hint(batch_iter, batch_key, std::move(batch_shader));
+    }
+    setup.engine_data.cached_batch_shader = batch_iter->second.get();
 }
 
 void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
@@ -37,4 +48,24 @@ void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
     shader->Run(setup, state, setup.engine_data.entry_point);
 }
 
+void JitX64Engine::RunMultiple(const ShaderSetup& setup, UnitState* states,
+                               unsigned num_states) const {
+    const JitBatchShader* batch_shader =
+        static_cast<const JitBatchShader*>(setup.engine_data.cached_batch_shader);
+    if (batch_shader == nullptr) {
+        ShaderEngine::RunMultiple(setup, states, num_states);
+        return;
+    }
+
+    for (unsigned i = 0; i < num_states; i += BATCH_SHADER_LANES) {
+        const unsigned num_lanes = std::min(num_states - i, BATCH_SHADER_LANES);
+        if (num_lanes == 1) {
+            // Transposing the registers isn't worth it for a single unit
+            Run(setup, states[i]);
+        } else {
+            batch_shader->Run(setup, states + i, num_lanes);
+        }
+    }
+}
+
 } // namespace Pica::Shader
@@ -4,14 +4,17 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include "common/common_types.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Shader {
 
 class JitShader;
+class JitBatchShader;
 
 class JitX64Engine final : public ShaderEngine {
 public:
@@ -20,9 +23,13 @@ public:
 
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
+    void RunMultiple(const ShaderSetup& setup, UnitState* states,
+                     unsigned num_states) const override;
 
 private:
     std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    /// Batch shaders are compiled per entry point, nullptr marks programs they can't run
+    std::map<std::pair<u64, unsigned>, std::unique_ptr<JitBatchShader>> batch_cache;
 };
 
 } // namespace Pica::Shader
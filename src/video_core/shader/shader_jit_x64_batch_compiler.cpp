@@ -0,0 +1,1387 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdint>
+#include <nihstro/shader_bytecode.h>
+#include <smmintrin.h>
+#include <xmmintrin.h>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/logging/log.h"
+#include "common/vector_math.h"
+#include "common/x64/cpu_detect.h"
+#include "common/x64/xbyak_abi.h"
+#include "common/x64/xbyak_util.h"
+#include "video_core/pica_types.h"
+#include "video_core/shader/shader.h"
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Label;
+using Xbyak::Reg32;
+using Xbyak::Reg64;
+using Xbyak::Xmm;
+
+namespace Pica::Shader {
+
+typedef void (JitBatchShader::*BatchJitFunction)(Instruction instr);
+
+const BatchJitFunction batch_instr_table[64] = {
+    &JitBatchShader::Compile_ADD,    // add
+    &JitBatchShader::Compile_DP3,    // dp3
+    &JitBatchShader::Compile_DP4,    // dp4
+    &JitBatchShader::Compile_DPH,    // dph
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_EX2,    // ex2
+    &JitBatchShader::Compile_LG2,    // lg2
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_MUL,    // mul
+    &JitBatchShader::Compile_SGE,    // sge
+    &JitBatchShader::Compile_SLT,    // slt
+    &JitBatchShader::Compile_FLR,    // flr
+    &JitBatchShader::Compile_MAX,    // max
+    &JitBatchShader::Compile_MIN,    // min
+    &JitBatchShader::Compile_RCP,    // rcp
+    &JitBatchShader::Compile_RSQ,    // rsq
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_MOVA,   // mova
+    &JitBatchShader::Compile_MOV,    // mov
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_DPH,    // dphi
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_SGE,    // sgei
+    &JitBatchShader::Compile_SLT,    // slti
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_NOP,    // nop
+    &JitBatchShader::Compile_END,    // end
+    &JitBatchShader::Compile_BREAKC, // breakc
+    &JitBatchShader::Compile_CALL,   // call
+    &JitBatchShader::Compile_CALLC,  // callc
+    &JitBatchShader::Compile_CALLU,  // callu
+    &JitBatchShader::Compile_IF,     // ifu
+    &JitBatchShader::Compile_IF,     // ifc
+    &JitBatchShader::Compile_LOOP,   // loop
+    nullptr,                         // emit, unsupported
+    nullptr,                         // sete, unsupported
+    nullptr,                         // jmpc, unsupported
+    nullptr,                         // jmpu, unsupported
+    &JitBatchShader::Compile_CMP,    // cmp
+    &JitBatchShader::Compile_CMP,    // cmp
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+};
+
+// The following is used to alias some commonly used registers. Generally, RAX-RDX and XMM0-XMM8
+// can be used as scratch registers within a compiler function. The other registers have designated
+// purposes, as documented below. Each SSE lane holds the value of one shader unit:
+
+/// Pointer to the uniform memory
+static const Reg64 UNIFORMS = r9;
+/// Loop counter register of the lanes running the current loop (Multiplied by 16)
+static const Reg32 LOOPCOUNT_REG = r12d;
+/// Current VS loop iteration number
+static const Reg32 LOOPCOUNT = esi;
+/// Number to increment LOOPCOUNT_REG by on each loop iteration (Multiplied by 16)
+static const Reg32 LOOPINC = edi;
+/// Pointer past the last execution mask saved in BatchUnitState::mask_stack
+static const Reg64 MASK_STACK = r13;
+/// Pointer to the BatchUnitState instance for the current batch
+static const Reg64 STATE = r15;
+/// SIMD scratch register
+static const Xmm SCRATCH = xmm0;
+/// Loaded with a component of the first source register, otherwise can be used as scratch
+static const Xmm SRC1 = xmm1;
+/// Loaded with a component of the second source register, otherwise can be used as scratch
+static const Xmm SRC2 = xmm2;
+/// Loaded with a component of the third source register, otherwise can be used as scratch
+static const Xmm SRC3 = xmm3;
+/// Additional scratch register
+static const Xmm SCRATCH2 = xmm4;
+/// Further scratch registers, used for transposing, by the subroutines and for component results
+static const Xmm TEMP0 = xmm5;
+static const Xmm TEMP1 = xmm6;
+static const Xmm TEMP2 = xmm7;
+static const Xmm TEMP3 = xmm8;
+/// Result of the previous CMP instruction for the X-component comparison, as a mask
+static const Xmm COND0 = xmm10;
+/// Result of the previous CMP instruction for the Y-component comparison, as a mask
+static const Xmm COND1 = xmm11;
+/// Mask of the lanes executing the current instruction
+static const Xmm EXEC = xmm12;
+/// Mask of the lanes that left the current loop with a BREAKC
+static const Xmm BROKEN = xmm13;
+/// Constant vector of [1.0f, 1.0f, 1.0f, 1.0f], used to efficiently set a vector to one
+static const Xmm ONE = xmm14;
+/// Constant vector of [-0.f, -0.f, -0.f, -0.f], used to efficiently negate a vector with XOR
+static const Xmm NEGBIT = xmm15;
+
+static bool IsMAD(Instruction instr) {
+    return instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+           instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI;
+}
+
+void JitBatchShader::AnalyzeBlock(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code,
+                                  ProgramInfo& info, unsigned begin, unsigned end,
+                                  ExecutionContext context) {
+    end = std::min(end, MAX_PROGRAM_CODE_LENGTH);
+
+    // The mask stack isn't checked at run time, so programs that could overflow it aren't batched
+    if (context.mask_depth > BatchUnitState::MASK_STACK_SIZE) {
+        info.supported = false;
+        return;
+    }
+
+    for (unsigned offset = begin; offset < end && info.supported;) {
+        info.reachable[offset] = true;
+        if (context.in_subroutine) {
+            info.in_subroutine[offset] = true;
+        }
+
+        const Instruction instr = {program_code[offset]};
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::END:
+            // Lanes can't stop while the others go on, so all of them have to reach the END
+            info.supported = !context.divergent;
+            return;
+
+        case OpCode::Id::JMPC:
+        case OpCode::Id::JMPU:
+        case OpCode::Id::EMIT:
+        case OpCode::Id::SETEMIT:
+            info.supported = false;
+            return;
+
+        case OpCode::Id::IFU:
+        case OpCode::Id::IFC: {
+            const unsigned dest = instr.flow_control.dest_offset;
+            const unsigned num_instructions = instr.flow_control.num_instructions;
+            if (dest <= offset) {
+                info.supported = false;
+                return;
+            }
+
+            ExecutionContext branch_context = context;
+            if (instr.opcode.Value() == OpCode::Id::IFC) {
+                branch_context.divergent = true;
+                branch_context.mask_depth += 2;
+            }
+            AnalyzeBlock(program_code, info, offset + 1, dest, branch_context);
+            AnalyzeBlock(program_code, info, dest, dest + num_instructions, branch_context);
+            offset = dest + num_instructions;
+            break;
+        }
+
+        case OpCode::Id::LOOP: {
+            const unsigned dest = instr.flow_control.dest_offset;
+            if (dest <= offset || context.in_loop) {
+                info.supported = false;
+                return;
+            }
+
+            ExecutionContext body_context = context;
+            body_context.divergent = true;
+            body_context.in_loop = true;
+            // Only loops with a BREAKC save a mask, but telling them apart isn't worth it here
+            body_context.mask_depth += 1;
+            AnalyzeBlock(program_code, info, offset + 1, dest + 1, body_context);
+            offset = dest + 1;
+            break;
+        }
+
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU: {
+            const unsigned dest = instr.flow_control.dest_offset;
+            const unsigned num_instructions = instr.flow_control.num_instructions;
+
+            ExecutionContext call_context = context;
+            call_context.in_subroutine = true;
+            if (instr.opcode.Value() == OpCode::Id::CALLC) {
+                call_context.divergent = true;
+                call_context.mask_depth += 1;
+            }
+
+            // A subroutine is walked again for every mask depth it is called at, which also stops
+            // recursive calls saving masks once they run out of mask stack
+            const u32 call = dest | (num_instructions << 12) | (call_context.divergent << 20) |
+                             (call_context.in_loop << 21) | (call_context.mask_depth << 22);
+            if (std::find(info.walked_calls.begin(), info.walked_calls.end(), call) ==
+                info.walked_calls.end()) {
+                info.walked_calls.push_back(call);
+                info.return_offsets.push_back(dest + num_instructions);
+                AnalyzeBlock(program_code, info, dest, dest + num_instructions, call_context);
+            }
+            ++offset;
+            break;
+        }
+
+        default:
+            AnalyzeRegisters(instr, info);
+            ++offset;
+            break;
+        }
+    }
+}
+
+void JitBatchShader::AnalyzeRegisters(Instruction instr, ProgramInfo& info) {
+    const OpCode opcode = instr.opcode.Value();
+    const bool is_inverted = (0 != (opcode.GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    std::array<SourceRegister, 3> srcs;
+    unsigned num_srcs;
+    unsigned offset_src;
+    unsigned address_register_index;
+    DestRegister dest;
+
+    switch (opcode.GetInfo().type) {
+    case OpCode::Type::Arithmetic:
+        srcs = {{instr.common.GetSrc1(is_inverted), instr.common.GetSrc2(is_inverted)}};
+        num_srcs = 2;
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+        dest = instr.common.dest.Value();
+        break;
+
+    case OpCode::Type::MultiplyAdd:
+        srcs = {{instr.mad.GetSrc1(is_inverted), instr.mad.GetSrc2(is_inverted),
+                 instr.mad.GetSrc3(is_inverted)}};
+        num_srcs = 3;
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+        dest = instr.mad.dest.Value();
+        break;
+
+    default:
+        return;
+    }
+
+    for (unsigned i = 0; i < num_srcs; ++i) {
+        const SourceRegister src = srcs[i];
+        if (src.GetRegisterType() == RegisterType::FloatUniform)
+            continue;
+
+        if (i + 1 == offset_src && address_register_index != 0) {
+            // The offset can move the source to any input, temporary or output register
+            info.input_registers = info.temporary_registers = info.output_registers = 0xFFFF;
+        } else if (src.GetRegisterType() == RegisterType::Input) {
+            info.input_registers |= 1 << src.GetIndex();
+        } else {
+            info.temporary_registers |= 1 << src.GetIndex();
+        }
+    }
+
+    if (opcode.EffectiveOpCode() == OpCode::Id::CMP || opcode.EffectiveOpCode() == OpCode::Id::MOVA)
+        return;
+
+    if (dest.GetRegisterType() == RegisterType::Output) {
+        info.output_registers |= 1 << dest.GetIndex();
+    } else {
+        info.temporary_registers |= 1 << dest.GetIndex();
+    }
+}
+
+SwizzlePattern JitBatchShader::GetSwizzlePattern(Instruction instr) const {
+    const unsigned operand_desc_id =
+        IsMAD(instr) ? instr.mad.operand_desc_id : instr.common.operand_desc_id;
+    return {(*swizzle_data)[operand_desc_id]};
+}
+
+JitBatchShader::Source JitBatchShader::Compile_PrepareSrc(Instruction instr, unsigned src_num,
+                                                          SourceRegister src_reg) {
+    Source src;
+    src.is_uniform = src_reg.GetRegisterType() == RegisterType::FloatUniform;
+
+    Reg64 src_ptr;
+    size_t src_offset;
+    if (src.is_uniform) {
+        src_ptr = UNIFORMS;
+        src_offset = Uniforms::GetFloatUniformOffset(src_reg.GetIndex());
+    } else {
+        src_ptr = STATE;
+        src_offset = BatchUnitState::InputOffset(src_reg);
+    }
+
+    int src_offset_disp = (int)src_offset;
+    ASSERT_MSG(src_offset == src_offset_disp, "Source register offset too large for int type");
+
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    unsigned address_register_index;
+    unsigned offset_src;
+
+    if (IsMAD(instr)) {
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+    }
+
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+
+    // The selector of the X component is in the highest bits
+    const u8 sel = swiz.GetRawSelector(src_num);
+    for (unsigned i = 0; i < 4; ++i) {
+        src.selectors[i] = (sel >> (6 - 2 * i)) & 3;
+    }
+
+    const bool negate[] = {swiz.negate_src1, swiz.negate_src2, swiz.negate_src3};
+    src.negate = negate[src_num - 1];
+
+    if (src_num != offset_src || address_register_index == 0) {
+        src.address = src_ptr + src_offset_disp;
+    } else if (address_register_index == 3 && looping) {
+        // All lanes running the loop share its loop counter
+        if (src.is_uniform) {
+            src.address = UNIFORMS + LOOPCOUNT_REG.cvt64() + src_offset_disp;
+        } else {
+            // Registers of all lanes are four times as large as the uniforms
+            mov(eax, LOOPCOUNT_REG);
+            shl(rax, 2);
+            src.address = STATE + rax + src_offset_disp;
+        }
+    } else {
+        Compile_GatherSrc(src_ptr, src_offset_disp, src.is_uniform, address_register_index);
+        src.address = STATE + offsetof(BatchUnitState, gathered_source);
+        src.is_uniform = false;
+    }
+
+    return src;
+}
+
+/**
+ * Gathers the relatively addressed source register of every lane into gathered_source.
+ * @param src_ptr Pointer to the register block, UNIFORMS or STATE
+ * @param src_offset_disp Offset of the source register without the address register
+ * @param is_uniform True if the source is a uniform, shared by all lanes
+ * @param address_register_index Index of the address register offsetting the source
+ */
+void JitBatchShader::Compile_GatherSrc(Reg64 src_ptr, int src_offset_disp, bool is_uniform,
+                                       unsigned address_register_index) {
+    const size_t gathered_offset = offsetof(BatchUnitState, gathered_source);
+    size_t index_offset = offsetof(BatchUnitState, address_registers) +
+                          (address_register_index - 1) * sizeof(s32) * BATCH_SHADER_LANES;
+
+    if (masked_writes) {
+        // The address registers of the lanes not being executed may hold anything, read their
+        // first register instead
+        movaps(SCRATCH, xword[STATE + index_offset]);
+        andps(SCRATCH, EXEC);
+        movaps(xword[STATE + offsetof(BatchUnitState, gather_indices)], SCRATCH);
+        index_offset = offsetof(BatchUnitState, gather_indices);
+    }
+
+    if (is_uniform) {
+        const Xmm lanes[] = {TEMP0, TEMP1, TEMP2, TEMP3};
+        for (unsigned lane = 0; lane < BATCH_SHADER_LANES; ++lane) {
+            movsxd(rax, dword[STATE + index_offset + lane * sizeof(s32)]);
+            shl(rax, 4);
+            movaps(lanes[lane], xword[src_ptr + rax + src_offset_disp]);
+        }
+
+        // Transpose the uniforms of the lanes into components
+        movaps(SCRATCH, TEMP0);
+        unpcklps(SCRATCH, TEMP1); // X0 X1 Y0 Y1
+        movaps(SCRATCH2, TEMP2);
+        unpcklps(SCRATCH2, TEMP3); // X2 X3 Y2 Y3
+        unpckhps(TEMP0, TEMP1);    // Z0 Z1 W0 W1
+        unpckhps(TEMP2, TEMP3);    // Z2 Z3 W2 W3
+        movaps(TEMP1, SCRATCH);
+        movlhps(TEMP1, SCRATCH2);   // X0 X1 X2 X3
+        movhlps(SCRATCH2, SCRATCH); // Y0 Y1 Y2 Y3
+        movaps(TEMP3, TEMP0);
+        movlhps(TEMP3, TEMP2); // Z0 Z1 Z2 Z3
+        movhlps(TEMP2, TEMP0); // W0 W1 W2 W3
+
+        movaps(xword[STATE + gathered_offset], TEMP1);
+        movaps(xword[STATE + gathered_offset + 16], SCRATCH2);
+        movaps(xword[STATE + gathered_offset + 32], TEMP3);
+        movaps(xword[STATE + gathered_offset + 48], TEMP2);
+    } else {
+        for (unsigned lane = 0; lane < BATCH_SHADER_LANES; ++lane) {
+            movsxd(rax, dword[STATE + index_offset + lane * sizeof(s32)]);
+            shl(rax, 6);
+            for (unsigned component = 0; component < 4; ++component) {
+                const int offset = component * sizeof(BatchUnitState::Lanes) + lane * sizeof(s32);
+                mov(edx, dword[src_ptr + rax + src_offset_disp + offset]);
+                mov(dword[STATE + gathered_offset + offset], edx);
+            }
+        }
+    }
+}
+
+void JitBatchShader::Compile_LoadSrc(const Source& src, unsigned component, Xmm dest) {
+    const unsigned selector = src.selectors[component];
+    if (src.is_uniform) {
+        // Broadcast the component to all lanes
+        pshufd(dest, xword[src.address], static_cast<u8>(selector * 0x55));
+    } else {
+        movaps(dest, xword[src.address + selector * sizeof(BatchUnitState::Lanes)]);
+    }
+
+    // If the source register should be negated, flip the negative bit using XOR
+    if (src.negate) {
+        xorps(dest, NEGBIT);
+    }
+}
+
+void JitBatchShader::Compile_MaskedStore(const Xbyak::Address& dest, Xmm src, bool masked) {
+    if (masked) {
+        // Keep the old value in the lanes that aren't being executed
+        movaps(SCRATCH2, EXEC);
+        andnps(SCRATCH2, dest);
+        andps(src, EXEC);
+        orps(src, SCRATCH2);
+    }
+    movaps(dest, src);
+}
+
+void JitBatchShader::Compile_StoreDest(Instruction instr, unsigned component, Xmm src) {
+    const DestRegister dest = IsMAD(instr) ? instr.mad.dest.Value() : instr.common.dest.Value();
+    const size_t dest_offset_disp =
+        BatchUnitState::OutputOffset(dest) + component * sizeof(BatchUnitState::Lanes);
+    Compile_MaskedStore(xword[STATE + dest_offset_disp], src, masked_writes);
+}
+
+void JitBatchShader::Compile_DestEnable(Instruction instr, Xmm src) {
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (unsigned i = 0; i < 4; ++i) {
+        // A masked store leaves the result in the executed lanes of src, so it can be reused
+        if (swiz.DestComponentEnabled(i)) {
+            Compile_StoreDest(instr, i, src);
+        }
+    }
+}
+
+template <typename F>
+void JitBatchShader::Compile_ComponentWise(Instruction instr, const Source* srcs,
+                                           unsigned num_srcs, F&& compute) {
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    const Xmm src_regs[] = {SRC1, SRC2, SRC3};
+    const Xmm results[] = {TEMP0, TEMP1, TEMP2, TEMP3};
+
+    // The destination may also be a source, as in `mov r0.xy, r0.yx`, so no component is stored
+    // before all of them have been computed
+    for (unsigned i = 0; i < 4; ++i) {
+        if (!swiz.DestComponentEnabled(i))
+            continue;
+
+        for (unsigned src = 0; src < num_srcs; ++src) {
+            Compile_LoadSrc(srcs[src], i, src_regs[src]);
+        }
+        movaps(results[i], compute());
+    }
+
+    for (unsigned i = 0; i < 4; ++i) {
+        if (swiz.DestComponentEnabled(i)) {
+            Compile_StoreDest(instr, i, results[i]);
+        }
+    }
+}
+
+void JitBatchShader::Compile_SanitizedMul(Xmm src1, Xmm src2, Xmm scratch) {
+    // 0 * inf and inf * 0 in the PICA should return 0 instead of NaN. This can be implemented by
+    // checking for NaNs before and after the multiplication.  If the multiplication result is NaN
+    // where neither source was, this NaN was generated by a 0 * inf multiplication, and so the
+    // result should be transformed to 0 to match PICA fp rules.
+
+    // Set scratch to mask of (src1 != NaN and src2 != NaN)
+    movaps(scratch, src1);
+    cmpordps(scratch, src2);
+
+    mulps(src1, src2);
+
+    // Set src2 to mask of (result == NaN)
+    movaps(src2, src1);
+    cmpunordps(src2, src2);
+
+    // Clear components where scratch != src2 (i.e. if result is NaN where neither source was NaN)
+    xorps(scratch, src2);
+    andps(src1, scratch);
+}
+
+void JitBatchShader::Compile_EvaluateCondition(Instruction instr) {
+    // Conditional codes are masks, so a lane matches a reference of false if its code is clear
+    const auto compare = [this](Xmm dest, Xmm cond, bool reference) {
+        if (reference) {
+            movaps(dest, cond);
+        } else {
+            pcmpeqd(dest, dest);
+            xorps(dest, cond);
+        }
+    };
+    const bool refx = instr.flow_control.refx.Value() != 0;
+    const bool refy = instr.flow_control.refy.Value() != 0;
+
+    switch (instr.flow_control.op) {
+    case Instruction::FlowControlType::Or:
+        compare(SCRATCH, COND0, refx);
+        compare(SCRATCH2, COND1, refy);
+        orps(SCRATCH, SCRATCH2);
+        break;
+
+    case Instruction::FlowControlType::And:
+        compare(SCRATCH, COND0, refx);
+        compare(SCRATCH2, COND1, refy);
+        andps(SCRATCH, SCRATCH2);
+        break;
+
+    case Instruction::FlowControlType::JustX:
+        compare(SCRATCH, COND0, refx);
+        break;
+
+    case Instruction::FlowControlType::JustY:
+        compare(SCRATCH, COND1, refy);
+        break;
+    }
+}
+
+void JitBatchShader::Compile_UniformCondition(Instruction instr) {
+    size_t offset = Uniforms::GetBoolUniformOffset(instr.flow_control.bool_uniform_id);
+    cmp(byte[UNIFORMS + offset], 0);
+}
+
+void JitBatchShader::Compile_PushMask(Xmm mask) {
+    movaps(xword[MASK_STACK], mask);
+    add(MASK_STACK, static_cast<u32>(sizeof(BatchUnitState::LaneMask)));
+}
+
+void JitBatchShader::Compile_RestoreMask(unsigned depth) {
+    const int offset = -static_cast<int>(depth * sizeof(BatchUnitState::LaneMask));
+    if (loop_has_break) {
+        // Lanes that left the loop stay masked out until its end
+        movaps(EXEC, BROKEN);
+        andnps(EXEC, xword[MASK_STACK + offset]);
+    } else {
+        movaps(EXEC, xword[MASK_STACK + offset]);
+    }
+}
+
+void JitBatchShader::Compile_JumpIfNoLanes(Xmm mask, Label& label) {
+    movmskps(eax, mask);
+    test(eax, eax);
+    jz(label, T_NEAR);
+}
+
+void JitBatchShader::Compile_StoreLoopCounter() {
+    mov(eax, LOOPCOUNT_REG);
+    sar(eax, 4);
+    movd(SCRATCH, eax);
+    pshufd(SCRATCH, SCRATCH, 0);
+    Compile_MaskedStore(xword[STATE + offsetof(BatchUnitState, address_registers[2])], SCRATCH,
+                        true);
+}
+
+void JitBatchShader::Compile_ADD(Instruction instr) {
+    const Source srcs[] = {Compile_PrepareSrc(instr, 1, instr.common.src1),
+                           Compile_PrepareSrc(instr, 2, instr.common.src2)};
+    Compile_ComponentWise(instr, srcs, 2, [this] {
+        addps(SRC1, SRC2);
+        return SRC1;
+    });
+}
+
+void JitBatchShader::Compile_DotProduct(Instruction instr, unsigned num_components,
+                                        bool homogeneous) {
+    Source src1, src2;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::DPHI) {
+        src1 = Compile_PrepareSrc(instr, 1, instr.common.src1i);
+        src2 = Compile_PrepareSrc(instr, 2, instr.common.src2i);
+    } else {
+        src1 = Compile_PrepareSrc(instr, 1, instr.common.src1);
+        src2 = Compile_PrepareSrc(instr, 2, instr.common.src2);
+    }
+
+    // JitShader sums the products as (x + y) + z and (x + y) + (z + w)
+    Compile_LoadSrc(src1, 0, SRC1);
+    Compile_LoadSrc(src2, 0, SRC2);
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+
+    Compile_LoadSrc(src1, 1, SRC3);
+    Compile_LoadSrc(src2, 1, SRC2);
+    Compile_SanitizedMul(SRC3, SRC2, SCRATCH);
+    addps(SRC1, SRC3);
+
+    Compile_LoadSrc(src1, 2, SRC3);
+    Compile_LoadSrc(src2, 2, SRC2);
+    Compile_SanitizedMul(SRC3, SRC2, SCRATCH);
+
+    if (num_components == 4) {
+        if (homogeneous) {
+            // The 4th component of the first source is 1.0, even if it was negated
+            movaps(TEMP0, ONE);
+        } else {
+            Compile_LoadSrc(src1, 3, TEMP0);
+        }
+        Compile_LoadSrc(src2, 3, SRC2);
+        Compile_SanitizedMul(TEMP0, SRC2, SCRATCH);
+        addps(SRC3, TEMP0);
+    }
+    addps(SRC1, SRC3);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_DP3(Instruction instr) {
+    Compile_DotProduct(instr, 3, false);
+}
+
+void JitBatchShader::Compile_DP4(Instruction instr) {
+    Compile_DotProduct(instr, 4, false);
+}
+
+void JitBatchShader::Compile_DPH(Instruction instr) {
+    Compile_DotProduct(instr, 4, true);
+}
+
+void JitBatchShader::Compile_EX2(Instruction instr) {
+    const Source src1 = Compile_PrepareSrc(instr, 1, instr.common.src1);
+    Compile_LoadSrc(src1, 0, SRC1);
+    call(exp2_subroutine);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_LG2(Instruction instr) {
+    const Source src1 = Compile_PrepareSrc(instr, 1, instr.common.src1);
+    Compile_LoadSrc(src1, 0, SRC1);
+    call(log2_subroutine);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_MUL(Instruction instr) {
+    const Source srcs[] = {Compile_PrepareSrc(instr, 1, instr.common.src1),
+                           Compile_PrepareSrc(instr, 2, instr.common.src2)};
+    Compile_ComponentWise(instr, srcs, 2, [this] {
+        Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+        return SRC1;
+    });
+}
+
+void JitBatchShader::Compile_SGE(Instruction instr) {
+    const bool is_inverted = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SGEI;
+    const Source srcs[] = {
+        Compile_PrepareSrc(instr, 1, is_inverted ? instr.common.src1i : instr.common.src1),
+        Compile_PrepareSrc(instr, 2, is_inverted ? instr.common.src2i : instr.common.src2)};
+    Compile_ComponentWise(instr, srcs, 2, [this] {
+        cmpleps(SRC2, SRC1);
+        andps(SRC2, ONE);
+        return SRC2;
+    });
+}
+
+void JitBatchShader::Compile_SLT(Instruction instr) {
+    const bool is_inverted = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SLTI;
+    const Source srcs[] = {
+        Compile_PrepareSrc(instr, 1, is_inverted ? instr.common.src1i : instr.common.src1),
+        Compile_PrepareSrc(instr, 2, is_inverted ? instr.common.src2i : instr.common.src2)};
+    Compile_ComponentWise(instr, srcs, 2, [this] {
+        cmpltps(SRC1, SRC2);
+        andps(SRC1, ONE);
+        return SRC1;
+    });
+}
+
+void JitBatchShader::Compile_FLR(Instruction instr) {
+    const Source srcs[] = {Compile_PrepareSrc(instr, 1, instr.common.src1)};
+    Compile_ComponentWise(instr, srcs, 1, [this] {
+        if (Common::GetCPUCaps().sse4_1) {
+            roundps(SRC1, SRC1, _MM_FROUND_FLOOR);
+        } else {
+            cvttps2dq(SRC1, SRC1);
+            cvtdq2ps(SRC1, SRC1);
+        }
+        return SRC1;
+    });
+}
+
+void JitBatchShader::Compile_MAX(Instruction instr) {
+    const Source srcs[] = {Compile_PrepareSrc(instr, 1, instr.common.src1),
+                           Compile_PrepareSrc(instr, 2, instr.common.src2)};
+    Compile_ComponentWise(instr, srcs, 2, [this] {
+        // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+        maxps(SRC1, SRC2);
+        return SRC1;
+    });
+}
+
+void JitBatchShader::Compile_MIN(Instruction instr) {
+    const Source srcs[] = {Compile_PrepareSrc(instr, 1, instr.common.src1),
+                           Compile_PrepareSrc(instr, 2, instr.common.src2)};
+    Compile_ComponentWise(instr, srcs, 2, [this] {
+        // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+        minps(SRC1, SRC2);
+        return SRC1;
+    });
+}
+
+void JitBatchShader::Compile_MOVA(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+
+    if (!swiz.DestComponentEnabled(0) && !swiz.DestComponentEnabled(1)) {
+        return; // NoOp
+    }
+
+    const Source src1 = Compile_PrepareSrc(instr, 1, instr.common.src1);
+    for (unsigned i = 0; i < 2; ++i) {
+        if (!swiz.DestComponentEnabled(i))
+            continue;
+
+        // Convert floats to integers using truncation
+        Compile_LoadSrc(src1, i, SRC1);
+        cvttps2dq(SRC1, SRC1);
+        Compile_MaskedStore(xword[STATE + offsetof(BatchUnitState, address_registers) +
+                                  i * sizeof(s32) * BATCH_SHADER_LANES],
+                            SRC1, masked_writes);
+    }
+}
+
+void JitBatchShader::Compile_MOV(Instruction instr) {
+    const Source srcs[] = {Compile_PrepareSrc(instr, 1, instr.common.src1)};
+    Compile_ComponentWise(instr, srcs, 1, [] { return SRC1; });
+}
+
+void JitBatchShader::Compile_RCP(Instruction instr) {
+    const Source src1 = Compile_PrepareSrc(instr, 1, instr.common.src1);
+    Compile_LoadSrc(src1, 0, SRC1);
+    // Gives the same approximation as the RCPSS used by JitShader
+    rcpps(SRC1, SRC1);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_RSQ(Instruction instr) {
+    const Source src1 = Compile_PrepareSrc(instr, 1, instr.common.src1);
+    Compile_LoadSrc(src1, 0, SRC1);
+    // Gives the same approximation as the RSQRTSS used by JitShader
+    rsqrtps(SRC1, SRC1);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitBatchShader::Compile_NOP(Instruction instr) {}
+
+void JitBatchShader::Compile_END(Instruction instr) {
+    // Save conditional codes, the address registers are kept in the state
+    movaps(xword[STATE + offsetof(BatchUnitState, conditional_code[0])], COND0);
+    movaps(xword[STATE + offsetof(BatchUnitState, conditional_code[1])], COND1);
+
+    // END may be reached inside of a subroutine, so drop its stack frames
+    mov(rsp, qword[STATE + offsetof(BatchUnitState, entry_stack_pointer)]);
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    ret();
+}
+
+void JitBatchShader::Compile_BREAKC(Instruction instr) {
+    if (!looping) {
+        info.supported = false;
+        return;
+    }
+
+    Compile_EvaluateCondition(instr);
+    andps(SCRATCH, EXEC);
+    orps(BROKEN, SCRATCH);
+    andnps(SCRATCH, EXEC);
+    movaps(EXEC, SCRATCH);
+
+    // Unless inside of a divergent IF, nothing is left to do in the loop once all lanes left it
+    if (divergence_depth == loop_divergence_depth) {
+        Compile_JumpIfNoLanes(EXEC, *loop_break_label);
+    }
+}
+
+void JitBatchShader::Compile_CALL(Instruction instr) {
+    // Push offset of the return
+    push(qword, (instr.flow_control.dest_offset + instr.flow_control.num_instructions));
+
+    // Call the subroutine
+    call(instruction_labels[instr.flow_control.dest_offset]);
+
+    // Skip over the return offset that's on the stack
+    add(rsp, 8);
+}
+
+void JitBatchShader::Compile_CALLC(Instruction instr) {
+    // The subroutine is run for the lanes for which the condition holds, if there are any
+    Label b;
+    Compile_EvaluateCondition(instr);
+    andps(SCRATCH, EXEC);
+    Compile_JumpIfNoLanes(SCRATCH, b);
+    Compile_PushMask(EXEC);
+    movaps(EXEC, SCRATCH);
+    Compile_CALL(instr);
+    Compile_RestoreMask(1);
+    sub(MASK_STACK, static_cast<u32>(sizeof(BatchUnitState::LaneMask)));
+    L(b);
+}
+
+void JitBatchShader::Compile_CALLU(Instruction instr) {
+    Compile_UniformCondition(instr);
+    Label b;
+    jz(b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitBatchShader::Compile_CMP(Instruction instr) {
+    using Op = Instruction::Common::CompareOpType::Op;
+    const Op ops[] = {instr.common.compare_op.x, instr.common.compare_op.y};
+    if (ops[0] > Op::GreaterEqual || ops[1] > Op::GreaterEqual) {
+        info.supported = false;
+        return;
+    }
+
+    const Source src1 = Compile_PrepareSrc(instr, 1, instr.common.src1);
+    const Source src2 = Compile_PrepareSrc(instr, 2, instr.common.src2);
+
+    // SSE doesn't have greater-than (GT) or greater-equal (GE) comparison operators. You need to
+    // emulate them by swapping the lhs and rhs and using LT and LE. NLT and NLE can't be used here
+    // because they don't match when used with NaNs.
+    static const u8 cmp[] = {CMP_EQ, CMP_NEQ, CMP_LT, CMP_LE, CMP_LT, CMP_LE};
+
+    const Xmm conds[] = {COND0, COND1};
+    for (unsigned i = 0; i < 2; ++i) {
+        Compile_LoadSrc(src1, i, SRC1);
+        Compile_LoadSrc(src2, i, SRC2);
+
+        const bool invert_op = (ops[i] == Op::GreaterThan || ops[i] == Op::GreaterEqual);
+        const Xmm lhs = invert_op ? SRC2 : SRC1;
+        const Xmm rhs = invert_op ? SRC1 : SRC2;
+        cmpps(lhs, rhs, cmp[ops[i]]);
+
+        if (masked_writes) {
+            movaps(SCRATCH, EXEC);
+            andnps(SCRATCH, conds[i]);
+            andps(lhs, EXEC);
+            orps(lhs, SCRATCH);
+        }
+        movaps(conds[i], lhs);
+    }
+}
+
+void JitBatchShader::Compile_MAD(Instruction instr) {
+    Source srcs[3];
+    srcs[0] = Compile_PrepareSrc(instr, 1, instr.mad.src1);
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        srcs[1] = Compile_PrepareSrc(instr, 2, instr.mad.src2i);
+        srcs[2] = Compile_PrepareSrc(instr, 3, instr.mad.src3i);
+    } else {
+        srcs[1] = Compile_PrepareSrc(instr, 2, instr.mad.src2);
+        srcs[2] = Compile_PrepareSrc(instr, 3, instr.mad.src3);
+    }
+
+    Compile_ComponentWise(instr, srcs, 3, [this] {
+        Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+        addps(SRC1, SRC3);
+        return SRC1;
+    });
+}
+
+void JitBatchShader::Compile_IF(Instruction instr) {
+    const unsigned dest = instr.flow_control.dest_offset;
+    const unsigned num_instructions = instr.flow_control.num_instructions;
+    Label l_else, l_endif;
+
+    if (instr.opcode.Value() == OpCode::Id::IFU) {
+        // All lanes agree on uniform conditions, so these are compiled like in JitShader
+        Compile_UniformCondition(instr);
+        jz(l_else, T_NEAR);
+        Compile_Block(dest);
+        if (num_instructions == 0) {
+            L(l_else);
+            return;
+        }
+        jmp(l_endif, T_NEAR);
+        L(l_else);
+        Compile_Block(dest + num_instructions);
+        L(l_endif);
+        return;
+    }
+
+    // Each branch is run with the lanes that take it, and skipped if there are none. The mask of
+    // the lanes before the IF and the mask of the lanes taking the "ELSE" branch are saved.
+    Compile_EvaluateCondition(instr);
+    andps(SCRATCH, EXEC);
+    movaps(SCRATCH2, SCRATCH);
+    andnps(SCRATCH2, EXEC);
+    Compile_PushMask(EXEC);
+    Compile_PushMask(SCRATCH2);
+    movaps(EXEC, SCRATCH);
+    ++divergence_depth;
+
+    Compile_JumpIfNoLanes(EXEC, l_else);
+    Compile_Block(dest);
+    L(l_else);
+
+    if (num_instructions != 0) {
+        Compile_RestoreMask(1);
+        Compile_JumpIfNoLanes(EXEC, l_endif);
+        Compile_Block(dest + num_instructions);
+        L(l_endif);
+    }
+
+    --divergence_depth;
+    Compile_RestoreMask(2);
+    sub(MASK_STACK, static_cast<u32>(2 * sizeof(BatchUnitState::LaneMask)));
+}
+
+void JitBatchShader::Compile_LOOP(Instruction instr) {
+    const unsigned dest = instr.flow_control.dest_offset;
+
+    looping = true;
+    loop_divergence_depth = divergence_depth;
+
+    // Lanes can only leave the loop early if there is a BREAKC in its body
+    loop_has_break = false;
+    for (unsigned offset = program_counter; offset <= dest; ++offset) {
+        const Instruction body_instr = {(*program_code)[offset]};
+        if (info.reachable[offset] && body_instr.opcode.Value() == OpCode::Id::BREAKC) {
+            loop_has_break = true;
+        }
+    }
+
+    // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id.
+    // The Y (LOOPCOUNT_REG) and Z (LOOPINC) component are kept multiplied by 16 (Left shifted by
+    // 4 bits) to be used as an offset into the 16-byte vector registers later
+    size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+    mov(LOOPCOUNT, dword[UNIFORMS + offset]);
+    mov(LOOPCOUNT_REG, LOOPCOUNT);
+    shr(LOOPCOUNT_REG, 4);
+    and_(LOOPCOUNT_REG, 0xFF0); // Y-component is the start
+    mov(LOOPINC, LOOPCOUNT);
+    shr(LOOPINC, 12);
+    and_(LOOPINC, 0xFF0);               // Z-component is the incrementer
+    movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
+    add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+
+    // The lanes leaving with a BREAKC are collected in BROKEN, and all lanes that entered the loop
+    // are restored at its end
+    if (loop_has_break) {
+        Compile_PushMask(EXEC);
+    }
+    Compile_StoreLoopCounter();
+
+    Label l_loop_start;
+    L(l_loop_start);
+
+    loop_break_label = Xbyak::Label();
+    Compile_Block(dest + 1);
+
+    add(LOOPCOUNT_REG, LOOPINC); // Increment LOOPCOUNT_REG by Z-component
+    Compile_StoreLoopCounter();
+    if (loop_has_break) {
+        Compile_JumpIfNoLanes(EXEC, *loop_break_label);
+    }
+    sub(LOOPCOUNT, 1);         // Increment loop count by 1
+    jnz(l_loop_start, T_NEAR); // Loop if not equal
+    L(*loop_break_label);
+    loop_break_label = boost::none;
+
+    if (loop_has_break) {
+        movaps(EXEC, xword[MASK_STACK - static_cast<int>(sizeof(BatchUnitState::LaneMask))]);
+        sub(MASK_STACK, static_cast<u32>(sizeof(BatchUnitState::LaneMask)));
+        xorps(BROKEN, BROKEN);
+    }
+
+    looping = false;
+    loop_has_break = false;
+}
+
+void JitBatchShader::Compile_Block(unsigned end) {
+    while (program_counter < end) {
+        Compile_NextInstr();
+    }
+}
+
+void JitBatchShader::Compile_Return() {
+    // Peek return offset on the stack and check if we're at that offset
+    mov(rax, qword[rsp + 8]);
+    cmp(eax, (program_counter));
+
+    // If so, jump back to before CALL
+    Label b;
+    jnz(b);
+    ret();
+    L(b);
+}
+
+void JitBatchShader::Compile_NextInstr() {
+    if (std::binary_search(info.return_offsets.begin(), info.return_offsets.end(),
+                           program_counter)) {
+        Compile_Return();
+    }
+
+    L(instruction_labels[program_counter]);
+
+    const unsigned offset = program_counter;
+    Instruction instr = {(*program_code)[program_counter++]};
+
+    // Code that can't be reached may contain anything, it isn't compiled
+    if (!info.reachable[offset])
+        return;
+
+    masked_writes = divergence_depth != 0 || loop_has_break || info.in_subroutine[offset];
+
+    OpCode::Id opcode = instr.opcode.Value();
+    auto instr_func = batch_instr_table[static_cast<unsigned>(opcode)];
+
+    // Unhandled instructions are reported by JitShader, which compiles the same program
+    if (instr_func) {
+        // JIT the instruction!
+        ((*this).*instr_func)(instr);
+    }
+}
+
+void JitBatchShader::CompileProgram(unsigned entry_point) {
+    program = (CompiledShader*)getCurr();
+
+    // The stack pointer is 8 modulo 16 at the entry of a procedure
+    // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
+    // return checks (see Compile_Return) that happen in shader main routine.
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
+
+    mov(UNIFORMS, ABI_PARAM1);
+    mov(STATE, ABI_PARAM2);
+    mov(qword[STATE + offsetof(BatchUnitState, entry_stack_pointer)], rsp);
+    lea(MASK_STACK, ptr[STATE + offsetof(BatchUnitState, mask_stack)]);
+
+    // Load conditional codes and the lanes to run
+    movaps(COND0, xword[STATE + offsetof(BatchUnitState, conditional_code[0])]);
+    movaps(COND1, xword[STATE + offsetof(BatchUnitState, conditional_code[1])]);
+    movaps(EXEC, xword[STATE + offsetof(BatchUnitState, active_lanes)]);
+    xorps(BROKEN, BROKEN);
+
+    // Used to set a register to one
+    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
+    mov(rax, reinterpret_cast<size_t>(&one));
+    movaps(ONE, xword[rax]);
+
+    // Used to negate registers
+    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
+    mov(rax, reinterpret_cast<size_t>(&neg));
+    movaps(NEGBIT, xword[rax]);
+
+    // Jump to start of the shader program
+    jmp(instruction_labels[entry_point], T_NEAR);
+
+    // Compile entire program
+    Compile_Block(MAX_PROGRAM_CODE_LENGTH);
+
+    // Free memory that's no longer needed
+    program_code = nullptr;
+    swizzle_data = nullptr;
+    info.return_offsets.clear();
+    info.return_offsets.shrink_to_fit();
+    info.walked_calls.clear();
+    info.walked_calls.shrink_to_fit();
+
+    ready();
+
+    ASSERT_MSG(getSize() <= code_size, "Compiled a shader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled batch shader size={}", getSize());
+}
+
+std::unique_ptr<JitBatchShader> JitBatchShader::Compile(
+    const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code,
+    const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>& swizzle_data, unsigned entry_point) {
+    ProgramInfo info;
+    AnalyzeBlock(program_code, info, entry_point, MAX_PROGRAM_CODE_LENGTH,
+                 {false, false, false, 0});
+    if (!info.supported)
+        return nullptr;
+
+    // Sort for efficient binary search later
+    std::sort(info.return_offsets.begin(), info.return_offsets.end());
+
+    const size_t code_size =
+        BATCH_SHADER_PRELUDE_SIZE + info.reachable.count() * MAX_BATCH_INSTRUCTION_SIZE;
+    std::unique_ptr<JitBatchShader> shader(
+        new JitBatchShader(program_code, swizzle_data, std::move(info), code_size));
+    shader->CompileProgram(entry_point);
+    if (!shader->info.supported)
+        return nullptr;
+
+    return shader;
+}
+
+JitBatchShader::JitBatchShader(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code,
+                               const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>& swizzle_data,
+                               ProgramInfo&& info, size_t code_size)
+    : Xbyak::CodeGenerator(code_size), program_code(&program_code), swizzle_data(&swizzle_data),
+      info(std::move(info)), code_size(code_size) {
+    CompilePrelude();
+}
+
+void JitBatchShader::CompilePrelude() {
+    log2_subroutine = CompilePrelude_Log2();
+    exp2_subroutine = CompilePrelude_Exp2();
+}
+
+Xbyak::Label JitBatchShader::CompilePrelude_Log2() {
+    Xbyak::Label subroutine;
+
+    // This is the approximation of JitShader::CompilePrelude_Log2 evaluated for all lanes at once,
+    // with the same operations in the same order. Lanes whose input is out of its range are fixed
+    // up at the end instead of branching.
+
+    // Coefficients for the minimax polynomial.
+    // f(x) computes approximately log2(x) / (x - 1).
+    // f(x) = c4 + x * (c3 + x * (c2 + x * (c1 + x * c0)).
+    const auto vector = [this](u32 value) {
+        const void* address = getCurr();
+        for (unsigned lane = 0; lane < BATCH_SHADER_LANES; ++lane) {
+            dd(value);
+        }
+        return address;
+    };
+    align(64);
+    const void* c0 = vector(0x3d74552f);
+    const void* c1 = vector(0xbeee7397);
+    const void* c2 = vector(0x3fbd96dd);
+    const void* c3 = vector(0xc02153f6);
+    const void* c4 = vector(0x4038d96c);
+    const void* exponent_mask = vector(0x7f800000);
+    const void* mantissa_mask = vector(0x007fffff);
+    const void* exponent_bias = vector(0x7f);
+    const void* negative_infinity_vector = vector(0xff800000);
+    const void* default_qnan_vector = vector(0x7fc00000);
+
+    align(16);
+    L(subroutine);
+
+    // Keep the input for the edge cases
+    movaps(TEMP0, SRC1);
+
+    // Split input
+    movaps(SCRATCH2, SRC1);
+    andps(SCRATCH2, xword[rip + exponent_mask]);
+    andps(SRC1, xword[rip + mantissa_mask]);
+    movaps(SCRATCH, xword[rip + c0]); // Preload c0.
+    orps(SRC1, ONE);
+    // SRC1 now contains the mantissa of the input.
+    mulps(SCRATCH, SRC1);
+    psrld(SCRATCH2, 23);
+    psubd(SCRATCH2, xword[rip + exponent_bias]);
+    cvtdq2ps(SCRATCH2, SCRATCH2);
+    // SCRATCH2 now contains the exponent of the input.
+
+    // Complete computation of polynomial
+    addps(SCRATCH, xword[rip + c1]);
+    mulps(SCRATCH, SRC1);
+    addps(SCRATCH, xword[rip + c2]);
+    mulps(SCRATCH, SRC1);
+    addps(SCRATCH, xword[rip + c3]);
+    mulps(SCRATCH, SRC1);
+    subps(SRC1, ONE);
+    addps(SCRATCH, xword[rip + c4]);
+    mulps(SCRATCH, SRC1);
+    addps(SCRATCH2, SCRATCH);
+
+    // Here we handle edge cases: log2(0) = -Inf, log2(-Inf or negative) = NaN, and NaN inputs are
+    // returned as they are.
+    xorps(SCRATCH, SCRATCH);
+    movaps(TEMP1, TEMP0);
+    cmpleps(TEMP1, SCRATCH); // Input out of range
+    movaps(TEMP2, TEMP0);
+    cmpeqps(TEMP2, SCRATCH); // Input is zero
+    movaps(SRC1, TEMP2);
+    andps(SRC1, xword[rip + negative_infinity_vector]);
+    andnps(TEMP2, xword[rip + default_qnan_vector]);
+    orps(SRC1, TEMP2);
+    andps(SRC1, TEMP1);
+    andnps(TEMP1, SCRATCH2);
+    orps(SRC1, TEMP1);
+
+    movaps(SCRATCH, TEMP0);
+    cmpunordps(SCRATCH, SCRATCH); // Input is NaN
+    andps(TEMP0, SCRATCH);
+    andnps(SCRATCH, SRC1);
+    orps(SCRATCH, TEMP0);
+    movaps(SRC1, SCRATCH);
+
+    ret();
+
+    return subroutine;
+}
+
+Xbyak::Label JitBatchShader::CompilePrelude_Exp2() {
+    Xbyak::Label subroutine;
+
+    // This is the approximation of JitShader::CompilePrelude_Exp2 evaluated for all lanes at once,
+    // with the same operations in the same order.
+    const auto vector = [this](u32 value) {
+        const void* address = getCurr();
+        for (unsigned lane = 0; lane < BATCH_SHADER_LANES; ++lane) {
+            dd(value);
+        }
+        return address;
+    };
+    align(64);
+    const void* input_max = vector(0x43010000);
+    const void* input_min = vector(0xc2fdffff);
+    const void* c0 = vector(0x3c5dbe69);
+    const void* half = vector(0x3f000000);
+    const void* c1 = vector(0x3d5509f9);
+    const void* c2 = vector(0x3e773cc5);
+    const void* c3 = vector(0x3f3168b3);
+    const void* c4 = vector(0x3f800016);
+    const void* exponent_bias = vector(0x7f);
+
+    align(16);
+    L(subroutine);
+
+    // Keep the input for the edge cases
+    movaps(TEMP0, SRC1);
+
+    // Clamp to maximum range since we shift the value directly into the exponent.
+    minps(SRC1, xword[rip + input_max]);
+    maxps(SRC1, xword[rip + input_min]);
+
+    // Decompose input
+    movaps(SCRATCH, SRC1);
+    movaps(SCRATCH2, xword[rip + c0]); // Preload c0.
+    subps(SCRATCH, xword[rip + half]);
+    cvtps2dq(TEMP1, SCRATCH);
+    cvtdq2ps(SCRATCH, TEMP1);
+    // SCRATCH now contains input rounded to the nearest integer.
+    paddd(TEMP1, xword[rip + exponent_bias]);
+    subps(SRC1, SCRATCH);
+    // SRC1 contains input - round(input), which is in [-0.5, 0.5).
+    mulps(SCRATCH2, SRC1);
+    pslld(TEMP1, 23);
+    // TEMP1 contains 2^(round(input)).
+
+    // Complete computation of polynomial.
+    addps(SCRATCH2, xword[rip + c1]);
+    mulps(SCRATCH2, SRC1);
+    addps(SCRATCH2, xword[rip + c2]);
+    mulps(SCRATCH2, SRC1);
+    addps(SCRATCH2, xword[rip + c3]);
+    mulps(SRC1, SCRATCH2);
+    addps(SRC1, xword[rip + c4]);
+    mulps(SRC1, TEMP1);
+
+    // Handle edge cases: NaN inputs are returned as they are
+    movaps(SCRATCH, TEMP0);
+    cmpunordps(SCRATCH, SCRATCH);
+    andps(TEMP0, SCRATCH);
+    andnps(SCRATCH, SRC1);
+    orps(SCRATCH, TEMP0);
+    movaps(SRC1, SCRATCH);
+
+    ret();
+
+    return subroutine;
+}
+
+using LaneStates = std::array<UnitState*, BATCH_SHADER_LANES>;
+using RegisterBlock = Math::Vec4<float24> (UnitState::Registers::*)[16];
+
+/// Transposes registers of all lanes into the structure-of-arrays form
+static void LoadRegisters(const LaneStates& lanes, RegisterBlock block,
+                          BatchUnitState::Register* dest, u32 mask) {
+    for (int reg : Common::BitSet<u32>(mask)) {
+        __m128 x = _mm_load_ps(reinterpret_cast<const float*>(&(lanes[0]->registers.*block)[reg]));
+        __m128 y = _mm_load_ps(reinterpret_cast<const float*>(&(lanes[1]->registers.*block)[reg]));
+        __m128 z = _mm_load_ps(reinterpret_cast<const float*>(&(lanes[2]->registers.*block)[reg]));
+        __m128 w = _mm_load_ps(reinterpret_cast<const float*>(&(lanes[3]->registers.*block)[reg]));
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        float* components = reinterpret_cast<float*>(dest[reg].components);
+        _mm_store_ps(components, x);
+        _mm_store_ps(components + 4, y);
+        _mm_store_ps(components + 8, z);
+        _mm_store_ps(components + 12, w);
+    }
+}
+
+/// Transposes registers in the structure-of-arrays form back into the first num_lanes lanes
+static void StoreRegisters(const LaneStates& lanes, unsigned num_lanes, RegisterBlock block,
+                           const BatchUnitState::Register* src, u32 mask) {
+    for (int reg : Common::BitSet<u32>(mask)) {
+        const float* components = reinterpret_cast<const float*>(src[reg].components);
+        __m128 values[BATCH_SHADER_LANES] = {
+            _mm_load_ps(components),
+            _mm_load_ps(components + 4),
+            _mm_load_ps(components + 8),
+            _mm_load_ps(components + 12),
+        };
+        _MM_TRANSPOSE4_PS(values[0], values[1], values[2], values[3]);
+
+        for (unsigned lane = 0; lane < num_lanes; ++lane) {
+            _mm_store_ps(reinterpret_cast<float*>(&(lanes[lane]->registers.*block)[reg]),
+                         values[lane]);
+        }
+    }
+}
+
+void JitBatchShader::Run(const ShaderSetup& setup, UnitState* states, unsigned num_states) const {
+    ASSERT(num_states != 0 && num_states <= BATCH_SHADER_LANES);
+
+    // Lanes without a unit of their own run a copy of the first one, so all lanes run with
+    // sensible values
+    LaneStates lanes;
+    for (unsigned lane = 0; lane < BATCH_SHADER_LANES; ++lane) {
+        lanes[lane] = &states[lane < num_states ? lane : 0];
+    }
+
+    BatchUnitState batch;
+    LoadRegisters(lanes, &UnitState::Registers::input, batch.registers.input,
+                  info.input_registers);
+    LoadRegisters(lanes, &UnitState::Registers::temporary, batch.registers.temporary,
+                  info.temporary_registers);
+    LoadRegisters(lanes, &UnitState::Registers::output, batch.registers.output,
+                  info.output_registers);
+
+    for (unsigned lane = 0; lane < BATCH_SHADER_LANES; ++lane) {
+        for (unsigned i = 0; i < 2; ++i) {
+            batch.conditional_code[i][lane] = lanes[lane]->conditional_code[i] ? 0xFFFFFFFF : 0;
+        }
+        for (unsigned i = 0; i < 3; ++i) {
+            batch.address_registers[i][lane] = lanes[lane]->address_registers[i];
+        }
+        batch.active_lanes[lane] = lane < num_states ? 0xFFFFFFFF : 0;
+    }
+
+    program(&setup.uniforms, &batch);
+
+    StoreRegisters(lanes, num_states, &UnitState::Registers::temporary, batch.registers.temporary,
+                   info.temporary_registers);
+    StoreRegisters(lanes, num_states, &UnitState::Registers::output, batch.registers.output,
+                   info.output_registers);
+
+    for (unsigned lane = 0; lane < num_states; ++lane) {
+        for (unsigned i = 0; i < 2; ++i) {
+            states[lane].conditional_code[i] = batch.conditional_code[i][lane] != 0;
+        }
+        for (unsigned i = 0; i < 3; ++i) {
+            states[lane].address_registers[i] = batch.address_registers[i][lane];
+        }
+    }
+}
+
+} // namespace Pica::Shader
@@ -0,0 +1,305 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <boost/optional.hpp>
+#include <nihstro/shader_bytecode.h>
+#include <xbyak.h>
+#include "common/common_types.h"
+#include "video_core/pica_types.h"
+#include "video_core/shader/shader.h"
+
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::SwizzlePattern;
+
+namespace Pica::Shader {
+
+/// Number of shader units run together by a batch shader, one per SSE lane
+constexpr unsigned BATCH_SHADER_LANES = 4;
+
+/// Memory allocated for the constants, subroutines and entry code of each compiled batch shader
+constexpr size_t BATCH_SHADER_PRELUDE_SIZE = 4096;
+/// Memory allocated for each reachable instruction of a compiled batch shader
+constexpr size_t MAX_BATCH_INSTRUCTION_SIZE = 1024;
+
+/**
+ * The state of BATCH_SHADER_LANES shader units in structure-of-arrays form: each component of a
+ * register holds that component for all of the units, so one SSE instruction works on all of them.
+ */
+struct BatchUnitState {
+    /// Maximum number of execution masks saved by nested divergent IFs, CALLCs and LOOPs
+    static constexpr size_t MASK_STACK_SIZE = 64;
+
+    using Lanes = std::array<float24, BATCH_SHADER_LANES>;
+    using LaneMask = std::array<u32, BATCH_SHADER_LANES>;
+
+    struct Register {
+        alignas(16) Lanes components[4];
+    };
+
+    struct Registers {
+        Register input[16];
+        Register temporary[16];
+        Register output[16];
+    } registers;
+    static_assert(std::is_pod<Registers>::value, "Structure is not POD");
+
+    /// Conditional codes of every lane, as all-ones or all-zeros masks
+    alignas(16) LaneMask conditional_code[2];
+
+    /// Two address registers and the loop counter of every lane
+    alignas(16) std::array<s32, BATCH_SHADER_LANES> address_registers[3];
+
+    /// Lanes holding a shader unit, as all-ones or all-zeros masks
+    alignas(16) LaneMask active_lanes;
+
+    /// Address register of every lane, cleared in the lanes not being executed, used for gathering
+    alignas(16) std::array<s32, BATCH_SHADER_LANES> gather_indices;
+
+    /// Relatively addressed source register, gathered lane by lane
+    Register gathered_source;
+
+    /// Execution masks saved by divergent control flow
+    alignas(16) LaneMask mask_stack[MASK_STACK_SIZE];
+
+    /// Stack pointer of the main routine, used to leave the shader from inside of subroutines
+    u64 entry_stack_pointer;
+
+    static size_t InputOffset(const SourceRegister& reg) {
+        switch (reg.GetRegisterType()) {
+        case RegisterType::Input:
+            return offsetof(BatchUnitState, registers.input) + reg.GetIndex() * sizeof(Register);
+
+        case RegisterType::Temporary:
+            return offsetof(BatchUnitState, registers.temporary) +
+                   reg.GetIndex() * sizeof(Register);
+
+        default:
+            UNREACHABLE();
+            return 0;
+        }
+    }
+
+    static size_t OutputOffset(const DestRegister& reg) {
+        switch (reg.GetRegisterType()) {
+        case RegisterType::Output:
+            return offsetof(BatchUnitState, registers.output) + reg.GetIndex() * sizeof(Register);
+
+        case RegisterType::Temporary:
+            return offsetof(BatchUnitState, registers.temporary) +
+                   reg.GetIndex() * sizeof(Register);
+
+        default:
+            UNREACHABLE();
+            return 0;
+        }
+    }
+};
+
+/**
+ * This class implements the batch shader JIT compiler. Like JitShader it recompiles a Pica shader
+ * program into x86_64 code, but the code runs BATCH_SHADER_LANES shader units at once, each in its
+ * own SSE lane. Lanes that disagree on a condition are handled with execution masks: both sides of
+ * a divergent branch are run, and only the lanes that took a side keep its results.
+ */
+class JitBatchShader : public Xbyak::CodeGenerator {
+public:
+    /**
+     * Compiles the part of a program that can be reached from an entry point.
+     * @returns The compiled shader, or nullptr if the program uses features the batch compiler
+     *          doesn't handle (geometry shader instructions, jumps, nested loops, or ENDs reached
+     *          by only some of the lanes). Such programs have to be run one unit at a time.
+     */
+    static std::unique_ptr<JitBatchShader> Compile(
+        const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code,
+        const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>& swizzle_data, unsigned entry_point);
+
+    /**
+     * Runs the shader for up to BATCH_SHADER_LANES shader units.
+     * @param setup Shader engine state the shader was compiled from
+     * @param states Shader unit states, loaded with input data
+     * @param num_states Number of shader units in states
+     */
+    void Run(const ShaderSetup& setup, UnitState* states, unsigned num_states) const;
+
+    void Compile_ADD(Instruction instr);
+    void Compile_DP3(Instruction instr);
+    void Compile_DP4(Instruction instr);
+    void Compile_DPH(Instruction instr);
+    void Compile_EX2(Instruction instr);
+    void Compile_LG2(Instruction instr);
+    void Compile_MUL(Instruction instr);
+    void Compile_SGE(Instruction instr);
+    void Compile_SLT(Instruction instr);
+    void Compile_FLR(Instruction instr);
+    void Compile_MAX(Instruction instr);
+    void Compile_MIN(Instruction instr);
+    void Compile_RCP(Instruction instr);
+    void Compile_RSQ(Instruction instr);
+    void Compile_MOVA(Instruction instr);
+    void Compile_MOV(Instruction instr);
+    void Compile_NOP(Instruction instr);
+    void Compile_END(Instruction instr);
+    void Compile_BREAKC(Instruction instr);
+    void Compile_CALL(Instruction instr);
+    void Compile_CALLC(Instruction instr);
+    void Compile_CALLU(Instruction instr);
+    void Compile_IF(Instruction instr);
+    void Compile_LOOP(Instruction instr);
+    void Compile_CMP(Instruction instr);
+    void Compile_MAD(Instruction instr);
+
+private:
+    /// How the instructions of a block are reached, as far as the compiled code is concerned
+    struct ExecutionContext {
+        bool in_subroutine;  ///< Called by a CALL instruction
+        bool divergent;      ///< Possibly run by only some of the lanes
+        bool in_loop;        ///< Run by a LOOP
+        unsigned mask_depth; ///< Most execution masks that can be on the mask stack
+    };
+
+    /// What is known about a program before emitting any code, found by walking it from the entry
+    /// point the way it is compiled
+    struct ProgramInfo {
+        /// Instructions that can be executed
+        std::bitset<MAX_PROGRAM_CODE_LENGTH> reachable;
+        /// Instructions that can be executed by a subroutine, which some lanes may not have entered
+        std::bitset<MAX_PROGRAM_CODE_LENGTH> in_subroutine;
+        /// Offsets in code where a return needs to be inserted
+        std::vector<unsigned> return_offsets;
+        /// Subroutines already walked, with the context they were called in
+        std::vector<u32> walked_calls;
+        /// Registers that have to be transposed into and out of the structure-of-arrays form
+        u32 input_registers = 0;
+        u32 temporary_registers = 0;
+        u32 output_registers = 0;
+        /// False if the program can't be compiled for batches
+        bool supported = true;
+    };
+
+    /// Location of a source register in the generated code, and how it is swizzled
+    struct Source {
+        Xbyak::RegExp address;
+        bool is_uniform; ///< Shared by all lanes, so a component has to be broadcast
+        bool negate;
+        std::array<u8, 4> selectors;
+    };
+
+    JitBatchShader(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code,
+                   const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>& swizzle_data,
+                   ProgramInfo&& info, size_t code_size);
+
+    /// Walks the instructions in [begin, end) the way they are compiled, recording what can be
+    /// reached and which registers are used
+    static void AnalyzeBlock(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code,
+                             ProgramInfo& info, unsigned begin, unsigned end,
+                             ExecutionContext context);
+    static void AnalyzeRegisters(Instruction instr, ProgramInfo& info);
+
+    void CompileProgram(unsigned entry_point);
+    void Compile_Block(unsigned end);
+    void Compile_NextInstr();
+
+    SwizzlePattern GetSwizzlePattern(Instruction instr) const;
+
+    /**
+     * Emits the code locating a source register. A relatively addressed source which may differ
+     * between the lanes is gathered into BatchUnitState::gathered_source.
+     * @param instr VS instruction, used for determining how to load the source register
+     * @param src_num Number indicating which source register to load (1 = src1, 2 = src2, 3 = src3)
+     * @param src_reg SourceRegister object corresponding to the source register to load
+     */
+    Source Compile_PrepareSrc(Instruction instr, unsigned src_num, SourceRegister src_reg);
+    void Compile_GatherSrc(Xbyak::Reg64 src_ptr, int src_offset_disp, bool is_uniform,
+                           unsigned address_register_index);
+
+    /// Loads a swizzled component of a source register for all lanes into dest
+    void Compile_LoadSrc(const Source& src, unsigned component, Xbyak::Xmm dest);
+
+    /// Stores src to the enabled components of the destination register. Clobbers src.
+    void Compile_DestEnable(Instruction instr, Xbyak::Xmm src);
+    /// Stores src to a component of the destination register. Clobbers src.
+    void Compile_StoreDest(Instruction instr, unsigned component, Xbyak::Xmm src);
+    /// Stores src to dest, only in the lanes being executed if masked is set. Clobbers src.
+    void Compile_MaskedStore(const Xbyak::Address& dest, Xbyak::Xmm src, bool masked);
+
+    /**
+     * Compiles an instruction one destination component at a time. For each enabled component
+     * the sources are loaded into SRC1, SRC2 and SRC3, and `compute` emits the code computing the
+     * result and returns the register holding it. The results are kept in TEMP0-TEMP3 until all
+     * of them are computed, so `compute` must not clobber these.
+     */
+    template <typename F>
+    void Compile_ComponentWise(Instruction instr, const Source* srcs, unsigned num_srcs,
+                               F&& compute);
+
+    /// Compiles the dot product instructions, adding the products in the order JitShader does
+    void Compile_DotProduct(Instruction instr, unsigned num_components, bool homogeneous);
+
+    /**
+     * Compiles a `MUL src1, src2` operation, properly handling the PICA semantics when multiplying
+     * zero by inf. Clobbers `src2` and `scratch`.
+     */
+    void Compile_SanitizedMul(Xbyak::Xmm src1, Xbyak::Xmm src2, Xbyak::Xmm scratch);
+
+    /// Computes the mask of the lanes for which the condition of instr holds into SCRATCH
+    void Compile_EvaluateCondition(Instruction instr);
+    void Compile_UniformCondition(Instruction instr);
+
+    /// Saves an execution mask. AnalyzeBlock makes sure the mask stack can't overflow.
+    void Compile_PushMask(Xbyak::Xmm mask);
+    /// Restores the execution mask saved `depth` entries below the top of the mask stack
+    void Compile_RestoreMask(unsigned depth);
+    /// Jumps to label if no lane is set in mask
+    void Compile_JumpIfNoLanes(Xbyak::Xmm mask, Xbyak::Label& label);
+
+    /// Copies the loop counter to the address registers of the lanes being executed
+    void Compile_StoreLoopCounter();
+
+    /**
+     * Emits the code to conditionally return from a subroutine envoked by the `CALL` instruction.
+     */
+    void Compile_Return();
+
+    /**
+     * Emits data and code for utility functions.
+     */
+    void CompilePrelude();
+    Xbyak::Label CompilePrelude_Log2();
+    Xbyak::Label CompilePrelude_Exp2();
+
+    const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code = nullptr;
+    const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data = nullptr;
+    ProgramInfo info;
+    size_t code_size;
+
+    /// Mapping of Pica VS instructions to pointers in the emitted code
+    std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
+
+    /// Label pointing to the end of the current LOOP block. Used by the BREAKC instruction to break
+    /// out of the loop.
+    boost::optional<Xbyak::Label> loop_break_label;
+
+    unsigned program_counter = 0;       ///< Offset of the next instruction to decode
+    bool looping = false;               ///< True if compiling a loop
+    bool loop_has_break = false;        ///< True if lanes may leave the current loop with BREAKC
+    unsigned divergence_depth = 0;      ///< Number of divergent IFs around the current instruction
+    unsigned loop_divergence_depth = 0; ///< Number of divergent IFs around the current loop
+    bool masked_writes = false;         ///< True if the current instruction may skip some lanes
+
+    using CompiledShader = void(const void* uniforms, void* state);
+    CompiledShader* program = nullptr;
+
+    Xbyak::Label log2_subroutine;
+    Xbyak::Label exp2_subroutine;
+};
+
+} // namespace Pica::Shader
@@ -5,7 +5,10 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <memory>
+#include <thread>
 #include <tuple>
+#include <vector>
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/color.h"
@@ -13,6 +16,7 @@
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/quaternion.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 #include "core/hw/gpu.h"
 #include "core/memory.h"
@@ -115,6 +119,76 @@ static std::tuple<float24, float24, float24, PAddr> ConvertCubeCoord(float24 u,
     return std::make_tuple(x / z * half + half, y / z * half + half, z_abs, addr);
 }
 
+/// Per-triangle values computed once during setup and shared by every tile the triangle covers
+struct TriangleSetup {
+    TriangleSetup(const Vertex& v0, const Vertex& v1, const Vertex& v2) : v0(v0), v1(v1), v2(v2) {}
+
+    Vertex v0;
+    Vertex v1;
+    Vertex v2;
+
+    // vertex positions in rasterizer coordinates
+    std::array<Math::Vec3<Fix12P4>, 3> vtxpos;
+
+    // Bounding box in 12.4 fixed point, aligned to whole pixels
+    u16 min_x;
+    u16 min_y;
+    u16 max_x;
+    u16 max_y;
+
+    // Scissor box in 12.4 fixed point
+    u16 scissor_x1;
+    u16 scissor_y1;
+    u16 scissor_x2;
+    u16 scissor_y2;
+
+    // Fill rule biases added to the barycentric coordinates
+    int bias0;
+    int bias1;
+    int bias2;
+};
+
+// Width and height of a binning tile in pixels. Tiles are a multiple of the 8x8 Morton blocks used
+// by the framebuffer, so tiles never share any color or depth buffer bytes.
+constexpr u16 TILE_SIZE = 32;
+// Rasterizer coordinates are 12.4 fixed point values, hence at most 4096 pixels on each axis
+constexpr u32 TILES_PER_ROW = 4096 / TILE_SIZE;
+constexpr u32 NUM_TILES = TILES_PER_ROW * TILES_PER_ROW;
+
+/// Workers used to shade tiles in parallel, or nullptr if triangles are rasterized immediately
+static std::unique_ptr<Common::ThreadPool> thread_pool;
+/// Triangles queued since the last flush, in submission order
+static std::vector<TriangleSetup> binned_triangles;
+/// For each tile, the indices into binned_triangles of the triangles overlapping it
+static std::vector<std::vector<u32>> tile_bins;
+/// Indices of the tiles with a non-empty bin
+static std::vector<u32> active_tiles;
+
+static void RasterizeTriangleRegion(const TriangleSetup& setup, u16 begin_x, u16 begin_y,
+                                    u16 end_x, u16 end_y);
+
+static void BinTriangle(TriangleSetup&& setup) {
+    const u32 index = static_cast<u32>(binned_triangles.size());
+
+    const u32 tile_x_begin = (setup.min_x >> 4) / TILE_SIZE;
+    const u32 tile_y_begin = (setup.min_y >> 4) / TILE_SIZE;
+    const u32 tile_x_end = ((setup.max_x >> 4) + TILE_SIZE - 1) / TILE_SIZE;
+    const u32 tile_y_end = ((setup.max_y >> 4) + TILE_SIZE - 1) / TILE_SIZE;
+
+    for (u32 tile_y = tile_y_begin; tile_y < tile_y_end; ++tile_y) {
+        for (u32 tile_x = tile_x_begin; tile_x < tile_x_end; ++tile_x) {
+            const u32 tile = tile_y * TILES_PER_ROW + tile_x;
+            auto& bin = tile_bins[tile];
+            if (bin.empty()) {
+                active_tiles.push_back(tile);
+            }
+            bin.push_back(index);
+        }
+    }
+
+    binned_triangles.emplace_back(std::move(setup));
+}
+
 /**
  * Helper function for ProcessTriangle with the "reversed" flag to allow for implementing
  * culling via recursion.
@@ -205,10 +279,60 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     int bias2 =
         IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? -1 : 0;
 
+    if (min_x >= max_x || min_y >= max_y)
+        return;
+
+    TriangleSetup setup{v0, v1, v2};
+    setup.vtxpos = {vtxpos[0], vtxpos[1], vtxpos[2]};
+    setup.min_x = min_x;
+    setup.min_y = min_y;
+    setup.max_x = max_x;
+    setup.max_y = max_y;
+    setup.scissor_x1 = scissor_x1;
+    setup.scissor_y1 = scissor_y1;
+    setup.scissor_x2 = scissor_x2;
+    setup.scissor_y2 = scissor_y2;
+    setup.bias0 = bias0;
+    setup.bias1 = bias1;
+    setup.bias2 = bias2;
+
+    if (thread_pool) {
+        BinTriangle(std::move(setup));
+    } else {
+        RasterizeTriangleRegion(setup, min_x, min_y, max_x, max_y);
+    }
+}
+
+/**
+ * Rasterizes the part of a set up triangle that lies within the given region. All coordinates are
+ * 12.4 fixed point values aligned to whole pixels.
+ */
+static void RasterizeTriangleRegion(const TriangleSetup& setup, u16 begin_x, u16 begin_y,
+                                    u16 end_x, u16 end_y) {
+    const auto& regs = g_state.regs;
+
+    const Vertex& v0 = setup.v0;
+    const Vertex& v1 = setup.v1;
+    const Vertex& v2 = setup.v2;
+    const auto& vtxpos = setup.vtxpos;
+    const int bias0 = setup.bias0;
+    const int bias1 = setup.bias1;
+    const int bias2 = setup.bias2;
+    const u16 scissor_x1 = setup.scissor_x1;
+    const u16 scissor_y1 = setup.scissor_y1;
+    const u16 scissor_x2 = setup.scissor_x2;
+    const u16 scissor_y2 = setup.scissor_y2;
+
+    const u16 min_x = std::max(setup.min_x, begin_x);
+    const u16 min_y = std::max(setup.min_y, begin_y);
+    const u16 max_x = std::min(setup.max_x, end_x);
+    const u16 max_y = std::min(setup.max_y, end_y);
+
     auto w_inverse = Math::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
 
     auto textures = regs.texturing.GetTextures();
     auto tev_stages = regs.texturing.GetTevStages();
+    std::array<Texture::TileCache, 3> texture_caches;
 
     bool stencil_action_enable =
         g_state.regs.framebuffer.output_merger.stencil_test.enable &&
@@ -402,7 +526,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                         Texture::TextureInfo::FromPicaRegister(texture.config, texture.format);
 
                     // TODO: Apply the min and mag filters to the texture
-                    texture_color[i] = Texture::LookupTexture(texture_data, s, t, info);
+                    texture_color[i] = texture_caches[i].LookupTexture(texture_data, s, t, info);
                 }
 
                 if (i == 0 && (texture.config.type == TexturingRegs::TextureConfig::Shadow2D ||
@@ -886,4 +1010,52 @@ void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
     ProcessTriangleInternal(v0, v1, v2);
 }
 
+void FlushTriangles() {
+    if (binned_triangles.empty())
+        return;
+
+    // Each tile is shaded by a single thread which walks its bin in submission order, so blending
+    // and depth testing observe the same per-pixel primitive order as immediate rasterization.
+    thread_pool->ParallelFor(active_tiles.size(), [](size_t i) {
+        const u32 tile = active_tiles[i];
+        const u16 tile_x = static_cast<u16>((tile % TILES_PER_ROW) * TILE_SIZE);
+        const u16 tile_y = static_cast<u16>((tile / TILES_PER_ROW) * TILE_SIZE);
+
+        // Tiles on the last row/column end exactly at the 12.4 coordinate limit, which does not
+        // fit into a u16. Bounding boxes never reach past 0xFFF0 though.
+        const u16 begin_x = static_cast<u16>(tile_x << 4);
+        const u16 begin_y = static_cast<u16>(tile_y << 4);
+        const u16 end_x = static_cast<u16>(std::min((tile_x + TILE_SIZE) << 4, 0xFFFF));
+        const u16 end_y = static_cast<u16>(std::min((tile_y + TILE_SIZE) << 4, 0xFFFF));
+
+        for (u32 index : tile_bins[tile]) {
+            RasterizeTriangleRegion(binned_triangles[index], begin_x, begin_y, end_x, end_y);
+        }
+    });
+
+    for (u32 tile : active_tiles) {
+        tile_bins[tile].clear();
+    }
+    active_tiles.clear();
+    binned_triangles.clear();
+}
+
+void Init(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    if (num_threads > 1) {
+        thread_pool = std::make_unique<Common::ThreadPool>(num_threads, "SWRasterizer");
+        tile_bins.resize(NUM_TILES);
+    }
+}
+
+void Shutdown() {
+    thread_pool.reset();
+    binned_triangles.clear();
+    tile_bins.clear();
+    active_tiles.clear();
+}
+
 } // namespace Pica::Rasterizer
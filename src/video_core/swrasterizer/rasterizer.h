@@ -39,6 +39,23 @@ struct Vertex : Shader::OutputVertex {
     }
 };
 
+/**
+ * Rasterizes the given triangle. When multithreaded rasterization is enabled, the triangle is only
+ * binned into screen tiles and is drawn by the next call to FlushTriangles.
+ */
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
 
+/// Draws all binned triangles, shading screen tiles in parallel
+void FlushTriangles();
+
+/**
+ * Sets up the rasterizer.
+ * @param num_threads Number of threads used to shade tiles. 1 rasterizes every triangle
+ *                    immediately on the calling thread, 0 uses one thread per host core.
+ */
+void Init(size_t num_threads);
+
+/// Releases the tile workers and any pending triangles
+void Shutdown();
+
 } // namespace Pica::Rasterizer
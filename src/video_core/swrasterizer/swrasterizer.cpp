@@ -2,15 +2,35 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "core/settings.h"
 #include "video_core/swrasterizer/clipper.h"
+#include "video_core/swrasterizer/rasterizer.h"
 #include "video_core/swrasterizer/swrasterizer.h"
 
 namespace VideoCore {
 
+SWRasterizer::SWRasterizer() {
+    Pica::Rasterizer::Init(Settings::values.swrasterizer_num_threads);
+}
+
+SWRasterizer::~SWRasterizer() {
+    Pica::Rasterizer::Shutdown();
+}
+
 void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                const Pica::Shader::OutputVertex& v1,
                                const Pica::Shader::OutputVertex& v2) {
     Pica::Clipper::ProcessTriangle(v0, v1, v2);
 }
 
+void SWRasterizer::DrawTriangles() {
+    Pica::Rasterizer::FlushTriangles();
+}
+
+void SWRasterizer::NotifyPicaRegisterChanged(u32 id) {
+    // Binned triangles are shaded using the current register state, so they have to be drawn
+    // before anything changes
+    Pica::Rasterizer::FlushTriangles();
+}
+
 } // namespace VideoCore
@@ -115,6 +115,50 @@ union ETC1Tile {
 
         return ret.Cast<u8>();
     }
+
+    void Decode(std::array<Math::Vec3<u8>, 16>& dest) const {
+        // Base color and modifier table of both halves of the subtile, computed only once
+        std::array<Math::Vec3<int>, 2> base;
+        if (differential_mode) {
+            const Math::Vec3<int> base1{static_cast<int>(differential.r),
+                                        static_cast<int>(differential.g),
+                                        static_cast<int>(differential.b)};
+            const Math::Vec3<int> base2 =
+                base1 + Math::Vec3<int>{static_cast<int>(differential.dr),
+                                        static_cast<int>(differential.dg),
+                                        static_cast<int>(differential.db)};
+            for (int half = 0; half < 2; ++half) {
+                const auto& value = half == 0 ? base1 : base2;
+                base[half] = {Color::Convert5To8(static_cast<u8>(value.r())),
+                              Color::Convert5To8(static_cast<u8>(value.g())),
+                              Color::Convert5To8(static_cast<u8>(value.b()))};
+            }
+        } else {
+            base[0] = {Color::Convert4To8(static_cast<u8>(separate.r1)),
+                       Color::Convert4To8(static_cast<u8>(separate.g1)),
+                       Color::Convert4To8(static_cast<u8>(separate.b1))};
+            base[1] = {Color::Convert4To8(static_cast<u8>(separate.r2)),
+                       Color::Convert4To8(static_cast<u8>(separate.g2)),
+                       Color::Convert4To8(static_cast<u8>(separate.b2))};
+        }
+        const std::array<unsigned, 2> table_index{static_cast<unsigned>(table_index_1),
+                                                  static_cast<unsigned>(table_index_2)};
+
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < 4; ++x) {
+                const unsigned texel = 4 * x + y;
+                const int half = (flip ? y : x) < 2 ? 0 : 1;
+
+                int modifier = etc1_modifier_table[table_index[half]][GetTableSubIndex(texel)];
+                if (GetNegationFlag(texel))
+                    modifier *= -1;
+
+                dest[y * 4 + x] = {static_cast<u8>(std::clamp(base[half].r() + modifier, 0, 255)),
+                                   static_cast<u8>(std::clamp(base[half].g() + modifier, 0, 255)),
+                                   static_cast<u8>(std::clamp(base[half].b() + modifier, 0, 255))};
+            }
+        }
+    }
 };
 
 } // anonymous namespace
@@ -124,4 +168,9 @@ Math::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Subtile(u64 value, std::array<Math::Vec3<u8>, 16>& dest) {
+    ETC1Tile tile{value};
+    tile.Decode(dest);
+}
+
 } // namespace Pica::Texture
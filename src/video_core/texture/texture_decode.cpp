@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/logging/log.h"
@@ -13,6 +15,10 @@
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 using TextureFormat = Pica::TexturingRegs::TextureFormat;
 
 namespace Pica::Texture {
@@ -192,6 +198,250 @@ Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int
     }
 }
 
+/// For each texel of a tile in Morton order, its index in a DecodedTile
+static constexpr std::array<u8, TILE_SIZE> morton_to_linear = [] {
+    std::array<u8, TILE_SIZE> table{};
+    for (u32 y = 0; y < 8; ++y) {
+        for (u32 x = 0; x < 8; ++x) {
+            table[VideoCore::MortonInterleave(x, y)] = static_cast<u8>(y * 8 + x);
+        }
+    }
+    return table;
+}();
+
+#ifdef ARCHITECTURE_x86_64
+
+/**
+ * Stores 8 texels given as one 16 bit lane per texel and component, with each lane holding an
+ * 8 bit value.
+ */
+static void StoreRGBA(u8* dest, __m128i r, __m128i g, __m128i b, __m128i a) {
+    const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+    _mm_store_si128(reinterpret_cast<__m128i*>(dest), _mm_unpacklo_epi16(rg, ba));
+    _mm_store_si128(reinterpret_cast<__m128i*>(dest + 16), _mm_unpackhi_epi16(rg, ba));
+}
+
+static __m128i Expand4To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 4), value);
+}
+
+static __m128i Expand5To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2));
+}
+
+static __m128i Expand6To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 2), _mm_srli_epi16(value, 4));
+}
+
+/**
+ * Converts all texels of a tile to RGBA8, keeping them in Morton order.
+ * @returns false if the format has no SSE2 implementation
+ */
+static bool DecodeMortonTexelsSSE2(const u8* source, TextureFormat format, u8* dest) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi16(0xFF);
+    const __m128i mask4 = _mm_set1_epi16(0xF);
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+
+    switch (format) {
+    case TextureFormat::RGBA8:
+        for (size_t i = 0; i < TILE_SIZE; i += 4) {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+            // Reverse the byte order of each texel: swap the bytes of each word, then the words
+            value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+            value = _mm_shufflelo_epi16(value, 0xB1);
+            value = _mm_shufflehi_epi16(value, 0xB1);
+            _mm_store_si128(reinterpret_cast<__m128i*>(dest + i * 4), value);
+        }
+        return true;
+
+    case TextureFormat::RGB5A1:
+    case TextureFormat::RGB565:
+    case TextureFormat::RGBA4:
+    case TextureFormat::IA8:
+    case TextureFormat::RG8:
+        for (size_t i = 0; i < TILE_SIZE; i += 8) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2));
+            u8* out = dest + i * 4;
+            switch (format) {
+            case TextureFormat::RGB5A1: {
+                const __m128i a = _mm_and_si128(
+                    _mm_sub_epi16(zero, _mm_and_si128(value, _mm_set1_epi16(1))), max);
+                StoreRGBA(out, Expand5To8(_mm_srli_epi16(value, 11)),
+                          Expand5To8(_mm_and_si128(_mm_srli_epi16(value, 6), mask5)),
+                          Expand5To8(_mm_and_si128(_mm_srli_epi16(value, 1), mask5)), a);
+                break;
+            }
+            case TextureFormat::RGB565:
+                StoreRGBA(out, Expand5To8(_mm_srli_epi16(value, 11)),
+                          Expand6To8(_mm_and_si128(_mm_srli_epi16(value, 5), _mm_set1_epi16(0x3F))),
+                          Expand5To8(_mm_and_si128(value, mask5)), max);
+                break;
+            case TextureFormat::RGBA4:
+                StoreRGBA(out, Expand4To8(_mm_srli_epi16(value, 12)),
+                          Expand4To8(_mm_and_si128(_mm_srli_epi16(value, 8), mask4)),
+                          Expand4To8(_mm_and_si128(_mm_srli_epi16(value, 4), mask4)),
+                          Expand4To8(_mm_and_si128(value, mask4)));
+                break;
+            case TextureFormat::IA8: {
+                const __m128i i = _mm_srli_epi16(value, 8);
+                StoreRGBA(out, i, i, i, _mm_and_si128(value, max));
+                break;
+            }
+            default: // RG8
+                StoreRGBA(out, _mm_srli_epi16(value, 8), _mm_and_si128(value, max), zero, max);
+                break;
+            }
+        }
+        return true;
+
+    case TextureFormat::I8:
+    case TextureFormat::A8:
+    case TextureFormat::IA4:
+        for (size_t i = 0; i < TILE_SIZE; i += 16) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            const __m128i halves[] = {_mm_unpacklo_epi8(value, zero),
+                                      _mm_unpackhi_epi8(value, zero)};
+            for (size_t half = 0; half < 2; ++half) {
+                const __m128i texels = halves[half];
+                u8* out = dest + (i + half * 8) * 4;
+                if (format == TextureFormat::I8) {
+                    StoreRGBA(out, texels, texels, texels, max);
+                } else if (format == TextureFormat::A8) {
+                    StoreRGBA(out, zero, zero, zero, texels);
+                } else {
+                    const __m128i intensity = Expand4To8(_mm_srli_epi16(texels, 4));
+                    StoreRGBA(out, intensity, intensity, intensity,
+                              Expand4To8(_mm_and_si128(texels, mask4)));
+                }
+            }
+        }
+        return true;
+
+    case TextureFormat::I4:
+    case TextureFormat::A4:
+        for (size_t i = 0; i < TILE_SIZE; i += 16) {
+            const __m128i value = _mm_unpacklo_epi8(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i / 2)), zero);
+            // Texels with an even Morton index are stored in the low nibble
+            const __m128i low = Expand4To8(_mm_and_si128(value, mask4));
+            const __m128i high = Expand4To8(_mm_srli_epi16(value, 4));
+            const __m128i halves[] = {_mm_unpacklo_epi16(low, high),
+                                      _mm_unpackhi_epi16(low, high)};
+            for (size_t half = 0; half < 2; ++half) {
+                const __m128i texels = halves[half];
+                u8* out = dest + (i + half * 8) * 4;
+                if (format == TextureFormat::I4) {
+                    StoreRGBA(out, texels, texels, texels, max);
+                } else {
+                    StoreRGBA(out, zero, zero, zero, texels);
+                }
+            }
+        }
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+#endif // ARCHITECTURE_x86_64
+
+static void DecodeETC1Tile(const u8* source, bool has_alpha, DecodedTile& dest) {
+    const size_t subtile_size = has_alpha ? 16 : 8;
+    std::array<Math::Vec3<u8>, 16> subtile_texels;
+
+    for (unsigned int subtile_index = 0; subtile_index < ETC1_SUBTILES; ++subtile_index) {
+        const u8* subtile_ptr = source + subtile_index * subtile_size;
+        const unsigned int subtile_x = (subtile_index % 2) * 4;
+        const unsigned int subtile_y = (subtile_index / 2) * 4;
+
+        u64_le packed_alpha = 0;
+        if (has_alpha) {
+            memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
+
+        u64_le subtile_data;
+        memcpy(&subtile_data, subtile_ptr, sizeof(u64));
+        DecodeETC1Subtile(subtile_data, subtile_texels);
+
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < 4; ++x) {
+                const u8 alpha =
+                    has_alpha ? Color::Convert4To8((packed_alpha >> (4 * (x * 4 + y))) & 0xF)
+                              : 255;
+                dest[(subtile_y + y) * 8 + subtile_x + x] =
+                    Math::MakeVec(subtile_texels[y * 4 + x], alpha);
+            }
+        }
+    }
+}
+
+void DecodeTile8x8(const u8* source, TextureFormat format, DecodedTile& dest) {
+    if (format == TextureFormat::ETC1 || format == TextureFormat::ETC1A4) {
+        DecodeETC1Tile(source, format == TextureFormat::ETC1A4, dest);
+        return;
+    }
+
+#ifdef ARCHITECTURE_x86_64
+    alignas(16) std::array<u8, TILE_SIZE * 4> morton_texels;
+    if (DecodeMortonTexelsSSE2(source, format, morton_texels.data())) {
+        // Texels 2n and 2n + 1 in Morton order are horizontal neighbours
+        for (size_t i = 0; i < TILE_SIZE; i += 2) {
+            std::memcpy(&dest[morton_to_linear[i]], &morton_texels[i * 4], 2 * 4);
+        }
+        return;
+    }
+#endif
+
+    TextureInfo info{};
+    info.format = format;
+    for (unsigned int y = 0; y < 8; ++y) {
+        for (unsigned int x = 0; x < 8; ++x) {
+            dest[y * 8 + x] = LookupTexelInTile(source, x, y, info);
+        }
+    }
+}
+
+void DecodeTexture(const u8* source, const TextureInfo& info, unsigned int x, unsigned int y,
+                   unsigned int width, unsigned int height, u8* dest, ptrdiff_t dest_stride) {
+    const size_t tile_size = CalculateTileSize(info.format);
+    DecodedTile tile;
+
+    for (unsigned int tile_y = y & ~7u; tile_y < y + height; tile_y += 8) {
+        const unsigned int row_begin = std::max(tile_y, y);
+        const unsigned int row_end = std::min(tile_y + 8, y + height);
+        const u8* tile_row = source + (tile_y / 8) * info.stride;
+
+        for (unsigned int tile_x = x & ~7u; tile_x < x + width; tile_x += 8) {
+            const unsigned int column_begin = std::max(tile_x, x);
+            const unsigned int column_end = std::min(tile_x + 8, x + width);
+
+            DecodeTile8x8(tile_row + (tile_x / 8) * tile_size, info.format, tile);
+            for (unsigned int row = row_begin; row < row_end; ++row) {
+                u8* dest_row = dest + static_cast<ptrdiff_t>(row - y) * dest_stride;
+                std::memcpy(dest_row + (column_begin - x) * 4,
+                            &tile[(row - tile_y) * 8 + column_begin - tile_x],
+                            (column_end - column_begin) * 4);
+            }
+        }
+    }
+}
+
+Math::Vec4<u8> TileCache::LookupTexture(const u8* source, unsigned int x, unsigned int y,
+                                        const TextureInfo& info) {
+    const u8* tile =
+        source + (y / 8) * info.stride + (x / 8) * CalculateTileSize(info.format);
+    if (tile != cached_tile || info.format != cached_format) {
+        DecodeTile8x8(tile, info.format, texels);
+        cached_tile = tile;
+        cached_format = info.format;
+    }
+    return texels[(y % 8) * 8 + x % 8];
+}
+
 TextureInfo TextureInfo::FromPicaRegister(const TexturingRegs::TextureConfig& config,
                                           const TexturingRegs::TextureFormat& format) {
     TextureInfo info;
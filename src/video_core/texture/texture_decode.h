@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_texturing.h"
@@ -52,4 +54,45 @@ Math::Vec4<u8> LookupTexture(const u8* source, unsigned int x, unsigned int y,
 Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int y,
                                  const TextureInfo& info);
 
+/// RGBA texels of a decoded 8x8 tile, indexed by y * 8 + x
+using DecodedTile = std::array<Math::Vec4<u8>, 8 * 8>;
+
+/**
+ * Decodes all texels of a single 8x8 texture tile at once. This is considerably faster than
+ * looking up each texel on its own.
+ *
+ * @param source Pointer to the beginning of the tile.
+ * @param format Format of the tile.
+ * @param dest Receives the texels, using the same in-tile coordinates as LookupTexelInTile.
+ */
+void DecodeTile8x8(const u8* source, TexturingRegs::TextureFormat format, DecodedTile& dest);
+
+/**
+ * Decodes a rectangle of texels of a texture to RGBA8.
+ *
+ * @param source Source pointer to read data from
+ * @param info TextureInfo object describing the texture setup
+ * @param x, y, width, height Rectangle to decode, using the same coordinates as LookupTexture.
+ * @param dest Pointer receiving texel (x, y). Texels of a row are stored contiguously.
+ * @param dest_stride Offset in bytes between two rows in dest. May be negative.
+ */
+void DecodeTexture(const u8* source, const TextureInfo& info, unsigned int x, unsigned int y,
+                   unsigned int width, unsigned int height, u8* dest, ptrdiff_t dest_stride);
+
+/**
+ * Keeps the most recently decoded tile of a texture, so that looking up neighbouring texels only
+ * decodes their tile once.
+ */
+class TileCache {
+public:
+    /// Same as Pica::Texture::LookupTexture, decoding the tile of the texel if it isn't cached
+    Math::Vec4<u8> LookupTexture(const u8* source, unsigned int x, unsigned int y,
+                                 const TextureInfo& info);
+
+private:
+    const u8* cached_tile = nullptr;
+    TexturingRegs::TextureFormat cached_format{};
+    DecodedTile texels;
+};
+
 } // namespace Pica::Texture
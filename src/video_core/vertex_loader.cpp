@@ -1,9 +1,11 @@
 #include <memory>
+#include <unordered_map>
 #include <boost/range/algorithm/fill.hpp>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/vector_math.h"
 #include "core/memory.h"
@@ -12,19 +14,28 @@
 #include "video_core/regs_pipeline.h"
 #include "video_core/shader/shader.h"
 #include "video_core/vertex_loader.h"
+#include "video_core/video_core.h"
+#ifdef ARCHITECTURE_x86_64
+#include "video_core/vertex_loader_jit_x64.h"
+#endif // ARCHITECTURE_x86_64
 
 namespace Pica {
 
+#ifdef ARCHITECTURE_x86_64
+/// Compiled vertex loaders, keyed by the hash of the attribute layout they were compiled for
+static std::unordered_map<u64, std::unique_ptr<JitVertexLoader>> jit_loader_cache;
+#endif // ARCHITECTURE_x86_64
+
 void VertexLoader::Setup(const PipelineRegs& regs) {
     ASSERT_MSG(!is_setup, "VertexLoader is not intended to be setup more than once.");
 
     const auto& attribute_config = regs.vertex_attributes;
-    num_total_attributes = attribute_config.GetNumTotalAttributes();
+    layout.num_total_attributes = attribute_config.GetNumTotalAttributes();
 
-    boost::fill(vertex_attribute_sources, 0xdeadbeef);
+    boost::fill(layout.vertex_attribute_sources, 0xdeadbeef);
 
     for (int i = 0; i < 16; i++) {
-        vertex_attribute_is_default[i] = attribute_config.IsDefaultAttribute(i);
+        layout.vertex_attribute_is_default[i] = attribute_config.IsDefaultAttribute(i);
     }
 
     // Setup attribute data from loaders
@@ -46,12 +57,13 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
             if (attribute_index < 12) {
                 offset = Common::AlignUp(offset,
                                          attribute_config.GetElementSizeInBytes(attribute_index));
-                vertex_attribute_sources[attribute_index] = loader_config.data_offset + offset;
-                vertex_attribute_strides[attribute_index] =
+                layout.vertex_attribute_sources[attribute_index] =
+                    loader_config.data_offset + offset;
+                layout.vertex_attribute_strides[attribute_index] =
                     static_cast<u32>(loader_config.byte_count);
-                vertex_attribute_formats[attribute_index] =
+                layout.vertex_attribute_formats[attribute_index] =
                     attribute_config.GetFormat(attribute_index);
-                vertex_attribute_elements[attribute_index] =
+                layout.vertex_attribute_elements[attribute_index] =
                     attribute_config.GetNumElements(attribute_index);
                 offset += attribute_config.GetStride(attribute_index);
             } else if (attribute_index < 16) {
@@ -67,23 +79,63 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
     }
 
     is_setup = true;
+
+    SetupJit(regs);
+}
+
+void VertexLoader::SetupJit(const PipelineRegs& regs) {
+#ifdef ARCHITECTURE_x86_64
+    if (!VideoCore::g_shader_jit_enabled) {
+        return;
+    }
+
+    // The attribute arrays are resolved to host pointers once per draw. Should any of them not be
+    // backed by host memory, the interpreter is used so it can report the bad access per vertex.
+    jit_base_address = regs.vertex_attributes.GetPhysicalBaseAddress();
+    for (int i = 0; i < layout.num_total_attributes; ++i) {
+        if (layout.vertex_attribute_elements[i] == 0) {
+            continue;
+        }
+        jit_attribute_pointers[i] =
+            Memory::GetPhysicalPointer(jit_base_address + layout.vertex_attribute_sources[i]);
+        if (jit_attribute_pointers[i] == nullptr) {
+            return;
+        }
+    }
+
+    const u64 layout_hash = Common::ComputeStructHash64(layout);
+    auto iter = jit_loader_cache.find(layout_hash);
+    if (iter == jit_loader_cache.end()) {
+        iter = jit_loader_cache.emplace_hint(iter, layout_hash,
+                                             std::make_unique<JitVertexLoader>(layout));
+    }
+    jit_loader = iter->second.get();
+#endif // ARCHITECTURE_x86_64
 }
 
 void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
-                              Shader::AttributeBuffer& input) {
+                              Shader::AttributeBuffer& input) const {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
-    for (int i = 0; i < num_total_attributes; ++i) {
-        if (vertex_attribute_elements[i] != 0) {
+#ifdef ARCHITECTURE_x86_64
+    if (jit_loader != nullptr && base_address == jit_base_address) {
+        jit_loader->Run(jit_attribute_pointers.data(), vertex, input);
+        return;
+    }
+#endif // ARCHITECTURE_x86_64
+
+    for (int i = 0; i < layout.num_total_attributes; ++i) {
+        if (layout.vertex_attribute_elements[i] != 0) {
             // Load per-vertex data from the loader arrays
             u32 source_addr =
-                base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
+                base_address + layout.vertex_attribute_sources[i] +
+                layout.vertex_attribute_strides[i] * vertex;
 
-            switch (vertex_attribute_formats[i]) {
+            switch (layout.vertex_attribute_formats[i]) {
             case PipelineRegs::VertexAttributeFormat::BYTE: {
                 const s8* srcdata =
                     reinterpret_cast<const s8*>(Memory::GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < layout.vertex_attribute_elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -91,7 +143,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             case PipelineRegs::VertexAttributeFormat::UBYTE: {
                 const u8* srcdata =
                     reinterpret_cast<const u8*>(Memory::GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < layout.vertex_attribute_elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -99,7 +151,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             case PipelineRegs::VertexAttributeFormat::SHORT: {
                 const s16* srcdata =
                     reinterpret_cast<const s16*>(Memory::GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < layout.vertex_attribute_elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -107,7 +159,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             case PipelineRegs::VertexAttributeFormat::FLOAT: {
                 const float* srcdata =
                     reinterpret_cast<const float*>(Memory::GetPhysicalPointer(source_addr));
-                for (unsigned int comp = 0; comp < vertex_attribute_elements[i]; ++comp) {
+                for (unsigned int comp = 0; comp < layout.vertex_attribute_elements[i]; ++comp) {
                     input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
                 }
                 break;
@@ -117,7 +169,7 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             // Default attribute values set if array elements have < 4 components. This
             // is *not* carried over from the default attribute settings even if they're
             // enabled for this attribute.
-            for (unsigned int comp = vertex_attribute_elements[i]; comp < 4; ++comp) {
+            for (unsigned int comp = layout.vertex_attribute_elements[i]; comp < 4; ++comp) {
                 input.attr[i][comp] =
                     comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
             }
@@ -125,11 +177,12 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
             LOG_TRACE(HW_GPU,
                       "Loaded {} components of attribute {:x} for vertex {:x} (index {:x}) from "
                       "0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
-                      vertex_attribute_elements[i], i, vertex, index, base_address,
-                      vertex_attribute_sources[i], vertex_attribute_strides[i] * vertex,
+                      layout.vertex_attribute_elements[i], i, vertex, index, base_address,
+                      layout.vertex_attribute_sources[i],
+                      layout.vertex_attribute_strides[i] * vertex,
                       input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
                       input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
-        } else if (vertex_attribute_is_default[i]) {
+        } else if (layout.vertex_attribute_is_default[i]) {
             // Load the default attribute if we're configured to do so
             input.attr[i] = g_state.input_default_attributes.attr[i];
             LOG_TRACE(
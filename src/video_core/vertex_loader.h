@@ -10,28 +10,44 @@ namespace Shader {
 struct AttributeBuffer;
 }
 
+class JitVertexLoader;
+
 class VertexLoader {
 public:
+    /// Attribute layout decoded from the attribute loader registers, used as the JIT cache key
+    struct Layout {
+        std::array<u32, 16> vertex_attribute_sources{};
+        std::array<u32, 16> vertex_attribute_strides{};
+        std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats{};
+        std::array<u32, 16> vertex_attribute_elements{};
+        std::array<bool, 16> vertex_attribute_is_default{};
+        int num_total_attributes = 0;
+    };
+
     VertexLoader() = default;
     explicit VertexLoader(const PipelineRegs& regs) {
         Setup(regs);
     }
 
     void Setup(const PipelineRegs& regs);
-    void LoadVertex(u32 base_address, int index, int vertex, Shader::AttributeBuffer& input);
+    void LoadVertex(u32 base_address, int index, int vertex, Shader::AttributeBuffer& input) const;
 
     int GetNumTotalAttributes() const {
-        return num_total_attributes;
+        return layout.num_total_attributes;
     }
 
 private:
-    std::array<u32, 16> vertex_attribute_sources;
-    std::array<u32, 16> vertex_attribute_strides{};
-    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
-    std::array<u32, 16> vertex_attribute_elements{};
-    std::array<bool, 16> vertex_attribute_is_default;
-    int num_total_attributes = 0;
+    void SetupJit(const PipelineRegs& regs);
+
+    Layout layout;
     bool is_setup = false;
+
+    /// Compiled loader for this layout, or nullptr if vertices are loaded by the interpreter
+    const JitVertexLoader* jit_loader = nullptr;
+    /// Base address the attribute pointers below were resolved against
+    PAddr jit_base_address = 0;
+    /// Host pointers to the data of vertex 0 for each loaded attribute
+    std::array<const u8*, 16> jit_attribute_pointers{};
 };
 
 } // namespace Pica
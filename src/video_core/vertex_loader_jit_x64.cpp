@@ -0,0 +1,171 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/vector_math.h"
+#include "common/x64/xbyak_abi.h"
+#include "video_core/pica_state.h"
+#include "video_core/pica_types.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader_jit_x64.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Reg64;
+
+namespace Pica {
+
+using VertexAttributeFormat = PipelineRegs::VertexAttributeFormat;
+
+static_assert(sizeof(Math::Vec4<float24>) == 4 * sizeof(float),
+              "The loader stores attributes as four packed single-precision floats");
+
+// All registers used are caller-saved in both the Windows and System V ABIs, so the generated
+// code does not need a stack frame.
+
+/// Pointer to the array of per-attribute source pointers
+static const Reg64 POINTERS = r9;
+/// Index of the vertex being loaded, zero-extended to 64 bits
+static const Reg64 VERTEX = r11;
+/// Pointer to the Shader::AttributeBuffer being written
+static const Reg64 OUTPUT = r8;
+/// Scratch registers
+static const Reg64 SRC = rax;
+static const Reg64 SCRATCH = r10;
+
+JitVertexLoader::JitVertexLoader(const VertexLoader::Layout& layout)
+    : Xbyak::CodeGenerator(MAX_VERTEX_LOADER_SIZE) {
+    Compile(layout);
+}
+
+void JitVertexLoader::Compile_LoadAttribute(VertexAttributeFormat format, u32 elements) {
+    // Every load reads exactly the bytes of the attribute and leaves the remaining lanes of XMM0
+    // zeroed, which are then the expected defaults for y and z.
+    switch (format) {
+    case VertexAttributeFormat::FLOAT:
+        switch (elements) {
+        case 1:
+            movss(xmm0, dword[SRC]);
+            break;
+        case 2:
+            movsd(xmm0, qword[SRC]);
+            break;
+        case 3:
+            movsd(xmm0, qword[SRC]);
+            movss(xmm1, dword[SRC + 8]);
+            movlhps(xmm0, xmm1);
+            break;
+        case 4:
+            movups(xmm0, xword[SRC]);
+            break;
+        }
+        break;
+
+    case VertexAttributeFormat::BYTE:
+    case VertexAttributeFormat::UBYTE:
+        switch (elements) {
+        case 1:
+            movzx(SCRATCH.cvt32(), byte[SRC]);
+            movd(xmm0, SCRATCH.cvt32());
+            break;
+        case 2:
+            movzx(SCRATCH.cvt32(), word[SRC]);
+            movd(xmm0, SCRATCH.cvt32());
+            break;
+        case 3:
+            movzx(SCRATCH.cvt32(), byte[SRC + 2]);
+            shl(SCRATCH.cvt32(), 16);
+            mov(SCRATCH.cvt16(), word[SRC]);
+            movd(xmm0, SCRATCH.cvt32());
+            break;
+        case 4:
+            movd(xmm0, dword[SRC]);
+            break;
+        }
+        // Replicate each byte into the top of its own dword, then shift it back down to extend
+        punpcklbw(xmm0, xmm0);
+        punpcklwd(xmm0, xmm0);
+        if (format == VertexAttributeFormat::BYTE) {
+            psrad(xmm0, 24);
+        } else {
+            psrld(xmm0, 24);
+        }
+        cvtdq2ps(xmm0, xmm0);
+        break;
+
+    case VertexAttributeFormat::SHORT:
+        switch (elements) {
+        case 1:
+            movzx(SCRATCH.cvt32(), word[SRC]);
+            movd(xmm0, SCRATCH.cvt32());
+            break;
+        case 2:
+            movd(xmm0, dword[SRC]);
+            break;
+        case 3:
+            movd(xmm0, dword[SRC]);
+            pinsrw(xmm0, word[SRC + 4], 2);
+            break;
+        case 4:
+            movq(xmm0, qword[SRC]);
+            break;
+        }
+        punpcklwd(xmm0, xmm0);
+        psrad(xmm0, 16);
+        cvtdq2ps(xmm0, xmm0);
+        break;
+    }
+
+    // The w lane is +0.0 at this point, so or-ing in the bits of 1.0 yields exactly 1.0
+    if (elements < 4) {
+        orps(xmm0, xword[rip + w_one_vector]);
+    }
+}
+
+void JitVertexLoader::Compile(const VertexLoader::Layout& layout) {
+    align(16);
+    w_one_vector = getCurr();
+    dd(0x00000000);
+    dd(0x00000000);
+    dd(0x00000000);
+    dd(0x3f800000);
+
+    align(16);
+    program = (CompiledLoader*)getCurr();
+
+    mov(POINTERS, ABI_PARAM1);
+    mov(VERTEX.cvt32(), ABI_PARAM2.cvt32());
+    mov(OUTPUT, ABI_PARAM3);
+
+    for (int i = 0; i < layout.num_total_attributes; ++i) {
+        const size_t output_offset =
+            offsetof(Shader::AttributeBuffer, attr) + i * sizeof(Math::Vec4<float24>);
+
+        if (layout.vertex_attribute_elements[i] != 0) {
+            mov(SRC, qword[POINTERS + i * sizeof(const u8*)]);
+            if (layout.vertex_attribute_strides[i] != 0) {
+                imul(SCRATCH, VERTEX, layout.vertex_attribute_strides[i]);
+                add(SRC, SCRATCH);
+            }
+            Compile_LoadAttribute(layout.vertex_attribute_formats[i],
+                                  layout.vertex_attribute_elements[i]);
+            movaps(xword[OUTPUT + output_offset], xmm0);
+        } else if (layout.vertex_attribute_is_default[i]) {
+            mov(SRC, reinterpret_cast<size_t>(&g_state.input_default_attributes.attr[i]));
+            movaps(xmm0, xword[SRC]);
+            movaps(xword[OUTPUT + output_offset], xmm0);
+        }
+    }
+
+    ret();
+
+    ready();
+
+    ASSERT_MSG(getSize() <= MAX_VERTEX_LOADER_SIZE,
+               "Compiled a vertex loader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled vertex loader size={}", getSize());
+}
+
+} // namespace Pica
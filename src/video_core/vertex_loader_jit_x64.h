@@ -0,0 +1,52 @@
+// Copyright 2018 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <xbyak.h>
+#include "common/common_types.h"
+#include "video_core/vertex_loader.h"
+
+namespace Pica {
+
+namespace Shader {
+struct AttributeBuffer;
+}
+
+/// Memory allocated for each compiled vertex loader
+constexpr size_t MAX_VERTEX_LOADER_SIZE = 4096;
+
+/**
+ * x86_64 vertex loader specialized for a single attribute layout. All format and element count
+ * decisions are made at compile time, leaving only the loads, the SSE conversion to float24 and
+ * the stores in the generated code.
+ */
+class JitVertexLoader : public Xbyak::CodeGenerator {
+public:
+    explicit JitVertexLoader(const VertexLoader::Layout& layout);
+
+    /**
+     * Loads all attributes of a vertex.
+     * @param attribute_pointers Host pointers to the data of vertex 0 for each loaded attribute
+     * @param vertex Index of the vertex in the attribute arrays
+     * @param input Attribute buffer to write the converted attributes to
+     */
+    void Run(const u8* const* attribute_pointers, u32 vertex,
+             Shader::AttributeBuffer& input) const {
+        program(attribute_pointers, vertex, &input);
+    }
+
+private:
+    void Compile(const VertexLoader::Layout& layout);
+    void Compile_LoadAttribute(PipelineRegs::VertexAttributeFormat format, u32 elements);
+
+    /// Constant vector (0, 0, 0, 1) used to default the w component of attributes
+    const void* w_one_vector = nullptr;
+
+    using CompiledLoader = void(const u8* const* attribute_pointers, u32 vertex, void* input);
+    CompiledLoader* program = nullptr;
+};
+
+} // namespace Pica
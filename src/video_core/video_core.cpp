@@ -4,9 +4,11 @@
 
 #include <memory>
 #include "common/logging/log.h"
+#include "core/settings.h"
 #include "video_core/pica.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
+#include "video_core/renderer_software/renderer_software.h"
 #include "video_core/video_core.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -26,7 +28,14 @@ std::atomic<bool> g_hw_shader_accurate_mul;
 Core::System::ResultStatus Init(EmuWindow& emu_window) {
     Pica::Init();
 
-    g_renderer = std::make_unique<RendererOpenGL>(emu_window);
+    switch (Settings::values.renderer_backend) {
+    case Settings::RendererBackend::OpenGL:
+        g_renderer = std::make_unique<RendererOpenGL>(emu_window);
+        break;
+    case Settings::RendererBackend::Software:
+        g_renderer = std::make_unique<RendererSoftware>(emu_window);
+        break;
+    }
     Core::System::ResultStatus result = g_renderer->Init();
 
     if (result != Core::System::ResultStatus::Success) {